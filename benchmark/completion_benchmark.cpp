@@ -0,0 +1,83 @@
+#include "pch.hpp"
+
+// JSH
+#include "completion.hpp"
+#include "environment.hpp"
+#include "posix_wrappers.hpp"
+#include "reactor.hpp"
+
+/**
+ * completion_benchmark: fills a directory with executables, puts it on PATH, and times building the trie and completing commands from it
+ *
+ * usage: completion_benchmark path/to/scratch/directory [executables]
+ */
+auto main(int argc, char** argv) noexcept -> int {
+    static constexpr std::size_t DEFAULT_EXECUTABLES = 20000;
+    static constexpr std::size_t RUNS = 1000;
+    static constexpr std::size_t PREFIX_GROUPS = 26;
+    static constexpr double PERCENTILE_90 = 0.9;
+    static constexpr double PERCENTILE_99 = 0.99;
+
+    std::vector<std::string> const args(argv, argv + argc); // NOLINT argv is argc long
+    if (args.size() < 2) {
+        jsh::cerr_logger.log(jsh::LOG_LEVEL::ERROR, "usage: completion_benchmark path/to/scratch/directory [executables]");
+        return EXIT_FAILURE;
+    }
+
+    std::size_t executables = DEFAULT_EXECUTABLES;
+    if (args.size() > 2) {
+        auto [ptr, err] = std::from_chars(args[2].data(), args[2].data() + args[2].size(), executables);
+        if (err != std::errc{} || ptr != args[2].data() + args[2].size() || executables == 0) {
+            jsh::cerr_logger.log(jsh::LOG_LEVEL::ERROR, "invalid number of executables ", args[2]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // the names are spread over a few first letters like the commands in a real toolchain
+    std::filesystem::path const dir = args[1];
+    std::error_code err;
+    std::filesystem::create_directories(dir, err);
+    for (std::size_t i = 0; i < executables; ++i) {
+        std::string const name = std::string(1, static_cast<char>('a' + i % PREFIX_GROUPS)) + "tool" + std::to_string(i);
+        std::optional<jsh::file_descriptor_wrapper> const file = jsh::syscall_wrapper::open_wrapper((dir / name).string(), O_WRONLY | O_CREAT | O_CLOEXEC, S_IRWXU);
+        if (!file.has_value()) {
+            return EXIT_FAILURE;
+        }
+    }
+    jsh::environment::set_var("PATH", dir.c_str());
+
+    std::optional<jsh::reactor> events = jsh::reactor::create();
+    if (!events.has_value()) {
+        return EXIT_FAILURE;
+    }
+
+    // the build the shell spreads over its idle time, timed in one go
+    std::chrono::steady_clock::time_point const build_start = std::chrono::steady_clock::now();
+    jsh::completion::watch(&events.value());
+    jsh::completion::finish();
+    std::chrono::steady_clock::time_point const build_end = std::chrono::steady_clock::now();
+
+    // one tab press each, from a single letter matching many commands down to a whole name
+    std::vector<std::string> const prefixes{"", "a", "btool", "ctool1", "dtool3", "etool42"};
+    std::vector<std::chrono::nanoseconds> samples;
+    samples.reserve(RUNS);
+    std::size_t matched = 0;
+    for (std::size_t run = 0; run < RUNS; ++run) {
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        matched += jsh::completion::complete(prefixes[run % prefixes.size()]).total;
+        samples.push_back(std::chrono::steady_clock::now() - start);
+    }
+    jsh::completion::watch(nullptr);
+    std::filesystem::remove_all(dir, err);
+
+    std::ranges::sort(samples);
+    auto const micros = [](std::chrono::nanoseconds duration) { return std::chrono::duration<double, std::micro>(duration).count(); };
+    auto const percentile = [&](double fraction) { return micros(samples[static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1))]); };
+    std::chrono::nanoseconds const total = std::accumulate(std::begin(samples), std::end(samples), std::chrono::nanoseconds{0});
+
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "building the trie of ", executables, " executables took ", micros(build_end - build_start), " usec\n");
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "completing a command over ", RUNS, " runs, ", matched / RUNS, " matches on average (usec)\n");
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "min\tmedian\tp90\tp99\tmean\n");
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, micros(samples.front()), '\t', percentile(0.5), '\t', percentile(PERCENTILE_90), '\t', percentile(PERCENTILE_99), '\t', micros(total) / static_cast<double>(samples.size()), '\n'); // NOLINT the median is the 0.5 percentile
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#include "pch.hpp"
+
+// JSH
+#include "job.hpp"
+#include "metachar_scan.hpp"
+#include "parsing.hpp"
+
+/**
+ * parse_benchmark: times substituting and parsing a generated command line with a long argument list using each scanning kernel
+ *
+ * usage: parse_benchmark [bytes]
+ */
+auto main(int argc, char** argv) noexcept -> int {
+    static constexpr std::size_t DEFAULT_BYTES = 512 * 1024;
+    static constexpr std::size_t RUNS = 50;
+    static constexpr std::size_t QUOTE_EVERY = 64;
+
+    std::vector<std::string> const args(argv, argv + argc); // NOLINT argv is argc long
+    std::size_t bytes = DEFAULT_BYTES;
+    if (args.size() > 1) {
+        auto [ptr, err] = std::from_chars(args[1].data(), args[1].data() + args[1].size(), bytes);
+        if (err != std::errc{} || ptr != args[1].data() + args[1].size() || bytes == 0) {
+            jsh::cerr_logger.log(jsh::LOG_LEVEL::ERROR, "invalid number of bytes ", args[1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // the argument list a build tool generates, with a quoted argument now and then
+    std::string line = "printf %s";
+    for (std::size_t i = 0; line.size() < bytes; ++i) {
+        line += i % QUOTE_EVERY == 0 ? " 'build/obj dir/" + std::to_string(i) + ".o'" : " build/obj/module_" + std::to_string(i) + ".o";
+    }
+    line += " | wc -c";
+
+    auto const micros = [](std::chrono::nanoseconds duration) { return std::chrono::duration<double, std::micro>(duration).count(); };
+
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "substituting and parsing a ", line.size(), " byte command line over ", RUNS, " runs (usec)\n");
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "kernel\tmin\tmedian\tMB/s\n");
+    for (std::size_t kernel = 0; kernel < static_cast<std::size_t>(jsh::metachar_scan::KERNEL::COUNT); ++kernel) {
+        if (!jsh::metachar_scan::set_kernel(static_cast<jsh::metachar_scan::KERNEL>(kernel))) {
+            continue;
+        }
+
+        std::vector<std::chrono::nanoseconds> samples;
+        samples.reserve(RUNS);
+        std::size_t tokens = 0;
+        for (std::size_t run = 0; run < RUNS; ++run) {
+            std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+            std::unique_ptr<jsh::job_data> const job = jsh::job::parse_job(jsh::parsing::variable_substitution(line));
+            samples.push_back(std::chrono::steady_clock::now() - start);
+            tokens += job->tokens.tokens.size();
+        }
+        if (tokens == 0) {
+            return EXIT_FAILURE;
+        }
+
+        std::ranges::sort(samples);
+        double const median = micros(samples[samples.size() / 2]);
+        jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, jsh::metachar_scan::KERNEL_STR[kernel], '\t', micros(samples.front()), '\t', median, '\t', static_cast<double>(line.size()) / median, '\n'); // NOLINT kernel is less than COUNT
+    }
+    return EXIT_SUCCESS;
+}
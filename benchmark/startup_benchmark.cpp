@@ -0,0 +1,70 @@
+#include "pch.hpp"
+
+// JSH
+#include "posix_wrappers.hpp"
+#include "process.hpp"
+
+/**
+ * startup_benchmark: times `jsh -c command` end to end, from spawning jsh until it has been reaped
+ *
+ * usage: startup_benchmark path/to/jsh [runs] [command]
+ */
+auto main(int argc, char** argv) noexcept -> int {
+    static constexpr std::size_t DEFAULT_RUNS = 1000;
+    static constexpr std::size_t WARMUP_RUNS = 10;
+    static constexpr double PERCENTILE_90 = 0.9;
+    static constexpr double PERCENTILE_99 = 0.99;
+
+    std::vector<std::string> const args(argv, argv + argc); // NOLINT argv is argc long
+    if (args.size() < 2) {
+        jsh::cerr_logger.log(jsh::LOG_LEVEL::ERROR, "usage: startup_benchmark path/to/jsh [runs] [command]");
+        return EXIT_FAILURE;
+    }
+
+    std::size_t runs = DEFAULT_RUNS;
+    if (args.size() > 2) {
+        auto [ptr, err] = std::from_chars(args[2].data(), args[2].data() + args[2].size(), runs);
+        if (err != std::errc{} || ptr != args[2].data() + args[2].size() || runs == 0) {
+            jsh::cerr_logger.log(jsh::LOG_LEVEL::ERROR, "invalid number of runs ", args[2]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // the arguments of jsh, null terminated for posix_spawn
+    std::string jsh_path = args[1];
+    std::string flag = "-c";
+    std::string command = args.size() > 3 ? args[3] : "true";
+    std::vector<char*> jsh_args{jsh_path.data(), flag.data(), command.data(), nullptr};
+
+    // the first few runs only warm up the page cache
+    std::vector<std::chrono::nanoseconds> samples;
+    samples.reserve(runs);
+    for (std::size_t run = 0; run < runs + WARMUP_RUNS; ++run) {
+        std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+        std::optional<pid_t> const pid = jsh::syscall_wrapper::spawn_wrapper(jsh_path, jsh_args, environ, std::nullopt, std::nullopt, std::nullopt, 0, false);
+        if (!pid.has_value()) {
+            return EXIT_FAILURE;
+        }
+
+        std::optional<int> const wait_status = jsh::process::wait_process(pid.value());
+        std::chrono::steady_clock::time_point const end = std::chrono::steady_clock::now();
+        if (!wait_status.has_value() || !WIFEXITED(wait_status.value()) || WEXITSTATUS(wait_status.value()) != EXIT_SUCCESS) {
+            jsh::cerr_logger.log(jsh::LOG_LEVEL::ERROR, "jsh -c ", command, " did not exit successfully");
+            return EXIT_FAILURE;
+        }
+
+        if (run >= WARMUP_RUNS) {
+            samples.push_back(end - start);
+        }
+    }
+
+    std::ranges::sort(samples);
+    auto const micros = [](std::chrono::nanoseconds duration) { return std::chrono::duration<double, std::micro>(duration).count(); };
+    auto const percentile = [&](double fraction) { return micros(samples[static_cast<std::size_t>(fraction * static_cast<double>(samples.size() - 1))]); };
+    std::chrono::nanoseconds const total = std::accumulate(std::begin(samples), std::end(samples), std::chrono::nanoseconds{0});
+
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "jsh -c ", command, " over ", runs, " runs (usec)\n");
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "min\tmedian\tp90\tp99\tmean\n");
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, micros(samples.front()), '\t', percentile(0.5), '\t', percentile(PERCENTILE_90), '\t', percentile(PERCENTILE_99), '\t', micros(total) / static_cast<double>(samples.size()), '\n'); // NOLINT the median is the 0.5 percentile
+    return EXIT_SUCCESS;
+}
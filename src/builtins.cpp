@@ -0,0 +1,268 @@
+#include "builtins.hpp"
+
+// JSH
+#include "parallel.hpp"
+
+namespace jsh {
+std::unordered_map<std::string, builtin_function> builtins::registry{
+    {"echo", &builtins::echo},
+    {"true", &builtins::true_builtin},
+    {"false", &builtins::false_builtin},
+    {"pwd", &builtins::pwd},
+    {"cd", &builtins::cd},
+    {"printf", &builtins::printf},
+    {"pipestat", &builtins::pipestat},
+    {"cgstat", &builtins::cgstat},
+    {"parallel", &builtins::parallel_builtin},
+    {"history", &builtins::history_builtin},
+};
+
+auto builtins::echo(std::vector<std::string> const& args) -> int {
+    assert(!args.empty());
+
+    // -n is only recognized as the first argument
+    bool const newline = args.size() < 2 || args[1] != NO_NEWLINE_FLAG;
+
+    // join the arguments with spaces
+    std::size_t const first = newline ? 1 : 2;
+    std::string out;
+    for (std::size_t i = first; i < args.size(); ++i) {
+        if (i != first) {
+            out += ' ';
+        }
+        out += args[i];
+    }
+    if (newline) {
+        out += '\n';
+    }
+
+    cout_logger.log(LOG_LEVEL::SILENT, out);
+    return EXIT_SUCCESS;
+}
+
+auto builtins::true_builtin([[maybe_unused]] std::vector<std::string> const& args) -> int {
+    return EXIT_SUCCESS;
+}
+
+auto builtins::false_builtin([[maybe_unused]] std::vector<std::string> const& args) -> int {
+    return EXIT_FAILURE;
+}
+
+auto builtins::pwd([[maybe_unused]] std::vector<std::string> const& args) -> int {
+    std::optional<std::string> const cwd = syscall_wrapper::getcwd_wrapper();
+
+    // error handle
+    if (!cwd.has_value()) {
+        return EXIT_FAILURE;
+    }
+
+    cout_logger.log(LOG_LEVEL::SILENT, cwd.value(), '\n');
+    return EXIT_SUCCESS;
+}
+
+auto builtins::cd(std::vector<std::string> const& args) -> int {
+    assert(!args.empty());
+
+    // find where to go, home by default or the previous directory for -
+    bool const previous = args.size() > 1 && args[1] == PREVIOUS_DIRECTORY;
+    std::string const target = args.size() < 2 ? environment::get_var(HOME_VAR) : (previous ? environment::get_var(OLDPWD_VAR) : args[1]);
+    if (target.empty()) {
+        cout_logger.log(LOG_LEVEL::ERROR, "cd: no directory to change to");
+        return EXIT_FAILURE;
+    }
+
+    // remember where we came from so cd - can go back
+    std::optional<std::string> const old_cwd = syscall_wrapper::getcwd_wrapper();
+    if (!syscall_wrapper::chdir_wrapper(target)) {
+        return EXIT_FAILURE;
+    }
+
+    // keep PWD and OLDPWD up to date for children and for cd -
+    if (old_cwd.has_value()) {
+        environment::set_var(OLDPWD_VAR, old_cwd.value().c_str());
+    }
+    if (std::optional<std::string> const cwd = syscall_wrapper::getcwd_wrapper(); cwd.has_value()) {
+        environment::set_var(PWD_VAR, cwd.value().c_str());
+
+        // cd - reports where it went
+        if (previous) {
+            cout_logger.log(LOG_LEVEL::SILENT, cwd.value(), '\n');
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+auto builtins::pipestat([[maybe_unused]] std::vector<std::string> const& args) -> int {
+    pipe_capacity::print();
+    return EXIT_SUCCESS;
+}
+
+auto builtins::cgstat([[maybe_unused]] std::vector<std::string> const& args) -> int {
+    if (!job_cgroup::last().has_value()) {
+        cout_logger.log(LOG_LEVEL::ERROR, "cgstat: no job has run in a cgroup, set ", job_cgroup::CGROUP_ROOT_VAR);
+        return EXIT_FAILURE;
+    }
+
+    job_cgroup::print();
+    return EXIT_SUCCESS;
+}
+
+auto builtins::parallel_builtin(std::vector<std::string> const& args) -> int {
+    std::optional<parallel_options> const options = parallel::parse_args(args);
+    if (!options.has_value()) {
+        cout_logger.log(LOG_LEVEL::ERROR, "parallel: usage: parallel [-j N] [-k] [command template]");
+        return EXIT_FAILURE;
+    }
+
+    // every line becomes one command, all of them are known before any of them run so they can be split between the workers
+    std::vector<std::string> commands;
+    for (std::string const& line : parallel::read_lines(syscall_wrapper::stdin_file_descriptor)) {
+        commands.push_back(parallel::expand(options->command_template, line));
+    }
+
+    return parallel::run(commands, options->jobs, options->keep_order) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+auto builtins::history_builtin(std::vector<std::string> const& args) -> int {
+    assert(!args.empty());
+
+    if (!history::is_open()) {
+        cout_logger.log(LOG_LEVEL::ERROR, "history: no history file is open");
+        return EXIT_FAILURE;
+    }
+
+    std::size_t count = history::size_limit();
+    if (args.size() > 1) {
+        std::string const& arg = args[1];
+        auto [ptr, err] = std::from_chars(arg.data(), arg.data() + arg.size(), count);
+        if (err != std::errc{} || ptr != arg.data() + arg.size()) {
+            cout_logger.log(LOG_LEVEL::ERROR, "history: usage: history [N]");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // every entry is printed in one go
+    std::string out;
+    for (history_entry const& entry : history::recent(count)) {
+        std::array<char, HISTORY_TIME_SIZE> started{};
+        std::tm local{};
+        auto const timestamp = static_cast<std::time_t>(entry.timestamp);
+        if (localtime_r(&timestamp, &local) == nullptr || std::strftime(started.data(), started.size(), HISTORY_TIME_FORMAT, &local) == 0) {
+            started[0] = '\0';
+        }
+
+        out += started.data();
+        out += "  ";
+        out += std::to_string(entry.duration_ms);
+        out += "ms  ";
+        out += std::to_string(entry.status);
+        out += "  ";
+        out += entry.command;
+        out += '\n';
+    }
+
+    cout_logger.log(LOG_LEVEL::SILENT, out);
+    return EXIT_SUCCESS;
+}
+
+void builtins::unescape(char chr, std::string& out) {
+    switch (chr) {
+    case 'n': {
+        out += '\n';
+        break;
+    }
+    case 't': {
+        out += '\t';
+        break;
+    }
+    case 'r': {
+        out += '\r';
+        break;
+    }
+    case ESCAPE: {
+        out += ESCAPE;
+        break;
+    }
+    default: {
+        // unknown escapes are printed as is
+        out += ESCAPE;
+        out += chr;
+        break;
+    }
+    }
+}
+
+auto builtins::printf(std::vector<std::string> const& args) -> int {
+    if (args.size() < 2) {
+        cout_logger.log(LOG_LEVEL::ERROR, "printf: missing format");
+        return EXIT_FAILURE;
+    }
+
+    std::string_view const format = args[1];
+    std::size_t next_arg = 2;
+    int status = EXIT_SUCCESS;
+    std::string out;
+
+    // the format is reused for as long as it keeps consuming arguments
+    while (true) {
+        std::size_t const first_arg = next_arg;
+        for (std::size_t i = 0; i < format.size(); ++i) {
+            char const chr = format[i];
+
+            // a trailing backslash or percent is printed as is
+            if ((chr != ESCAPE && chr != CONVERSION) || i + 1 == format.size()) {
+                out += chr;
+                continue;
+            }
+
+            char const spec = format[++i];
+            if (chr == ESCAPE) {
+                unescape(spec, out);
+            } else if (spec == CONVERSION) {
+                out += CONVERSION;
+            } else if (spec == 's') {
+                if (next_arg < args.size()) {
+                    out += args[next_arg++];
+                }
+            } else if (spec == 'd') {
+                // missing arguments are treated as zero
+                long long val = 0;
+                if (next_arg < args.size()) {
+                    std::string const& arg = args[next_arg++];
+                    auto [ptr, err] = std::from_chars(arg.data(), arg.data() + arg.size(), val);
+                    if (err != std::errc{} || ptr != arg.data() + arg.size()) {
+                        cout_logger.log(LOG_LEVEL::ERROR, "printf: invalid number ", arg);
+                        status = EXIT_FAILURE;
+                    }
+                }
+                out += std::to_string(val);
+            } else { // unknown conversions are printed as is
+                out += CONVERSION;
+                out += spec;
+            }
+        }
+
+        if (next_arg >= args.size() || next_arg == first_arg) {
+            break;
+        }
+    }
+
+    cout_logger.log(LOG_LEVEL::SILENT, out);
+    return status;
+}
+
+auto builtins::find(std::string const& name) -> std::optional<builtin_function> {
+    auto const itr = registry.find(name);
+    if (itr == std::end(registry)) [[likely]] {
+        return std::nullopt;
+    }
+
+    return std::make_optional<builtin_function>(itr->second);
+}
+
+void builtins::add(std::string const& name, builtin_function function) {
+    assert(function != nullptr);
+    registry.insert_or_assign(name, function);
+}
+} // namespace jsh
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "cgroup.hpp"
+#include "environment.hpp"
+#include "history.hpp"
+#include "macros.hpp"
+#include "pipe_capacity.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * builtin_function: a command which runs inside of the shell, it is handed every argument (including its own name) and returns its exit status
+ */
+using builtin_function = auto (*)(std::vector<std::string> const& args) -> int;
+
+/**
+ * builtins: registry of the simple commands the shell runs itself instead of forking and exec'ing a binary
+ *
+ * NOTES: builtins write to the shell's standard streams, which are redirected around them the same way they are for export and hash
+ */
+class builtins {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* HOME_VAR = "HOME";
+    static constexpr char const* PWD_VAR = "PWD";
+    static constexpr char const* OLDPWD_VAR = "OLDPWD";
+    static constexpr std::string_view PREVIOUS_DIRECTORY = "-";
+    static constexpr std::string_view NO_NEWLINE_FLAG = "-n";
+    static constexpr char ESCAPE = '\\';
+    static constexpr char CONVERSION = '%';
+    static constexpr char const* HISTORY_TIME_FORMAT = "%Y-%m-%d %H:%M:%S";
+    static constexpr std::size_t HISTORY_TIME_SIZE = 32;
+
+    /**
+     * registry: maps the name of each builtin to the function which runs it
+     */
+    static std::unordered_map<std::string, builtin_function> registry;
+
+    /**
+     * echo: prints its arguments separated by spaces, -n leaves off the trailing newline
+     */
+    [[nodiscard]] static auto echo(std::vector<std::string> const& args) -> int;
+
+    /**
+     * true_builtin: does nothing successfully
+     */
+    [[nodiscard]] static auto true_builtin(std::vector<std::string> const& args) -> int;
+
+    /**
+     * false_builtin: does nothing unsuccessfully
+     */
+    [[nodiscard]] static auto false_builtin(std::vector<std::string> const& args) -> int;
+
+    /**
+     * pwd: prints the current working directory
+     */
+    [[nodiscard]] static auto pwd(std::vector<std::string> const& args) -> int;
+
+    /**
+     * cd: changes the shell's working directory, to $HOME without an argument or to $OLDPWD for -
+     */
+    [[nodiscard]] static auto cd(std::vector<std::string> const& args) -> int;
+
+    /**
+     * printf: prints its arguments according to a format supporting %s, %d, %%, and backslash escapes, the format is reused until every argument is consumed
+     */
+    [[nodiscard]] static auto printf(std::vector<std::string> const& args) -> int;
+
+    /**
+     * pipestat: prints the capacity and fill statistics of each pipe in the most recent pipeline
+     */
+    [[nodiscard]] static auto pipestat(std::vector<std::string> const& args) -> int;
+
+    /**
+     * cgstat: prints the CPU time, peak memory, and IO of the most recent job which ran in a cgroup
+     */
+    [[nodiscard]] static auto cgstat(std::vector<std::string> const& args) -> int;
+
+    /**
+     * parallel_builtin: runs the command template once for every line of standard in (or every line as a command without one), -j N at a time, -k prints the output in input order
+     */
+    [[nodiscard]] static auto parallel_builtin(std::vector<std::string> const& args) -> int;
+
+    /**
+     * history_builtin: prints the last N commands run at the prompt of any session (every command kept without N) with when they started, how long they ran, and their exit status
+     */
+    [[nodiscard]] static auto history_builtin(std::vector<std::string> const& args) -> int;
+
+    /**
+     * unescape: appends the character a backslash escape stands for
+     */
+    static void unescape(char chr, std::string& out);
+
+  public:
+    /**
+     * find: returns the builtin registered under name, or std::nullopt if the command is not a builtin
+     */
+    [[nodiscard]] static auto find(std::string const& name) -> std::optional<builtin_function>;
+
+    /**
+     * add: registers a builtin, replacing any builtin already registered under name
+     */
+    static void add(std::string const& name, builtin_function function);
+};
+} // namespace jsh
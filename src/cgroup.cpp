@@ -0,0 +1,236 @@
+#include "cgroup.hpp"
+
+namespace jsh {
+std::size_t job_cgroup::next_leaf = 0;
+bool job_cgroup::controllers_enabled = false;
+std::optional<cgroup_usage> job_cgroup::last_usage = std::nullopt;
+
+job_cgroup::job_cgroup(std::string path, file_descriptor_wrapper procs) : path{std::move(path)}, procs{std::move(procs)} {}
+
+job_cgroup::~job_cgroup() {
+    // close cgroup.procs before removing the directory it lives in
+    procs = std::nullopt;
+    std::ignore = syscall_wrapper::rmdir_wrapper(path);
+}
+
+auto job_cgroup::enabled() -> bool {
+    return *environment::get_var(CGROUP_ROOT_VAR) != '\0';
+}
+
+auto job_cgroup::create(cgroup_limits const& limits) -> std::shared_ptr<job_cgroup> {
+    std::string const root = environment::get_var(CGROUP_ROOT_VAR);
+    if (root.empty()) {
+        if (limits.memory_max.has_value() || limits.cpu_max.has_value()) {
+            cout_logger.log(LOG_LEVEL::WARN, "Ignoring cgroup limits since ", CGROUP_ROOT_VAR, " is not set");
+        }
+        return nullptr;
+    }
+
+    // the controllers must be enabled on the parent before its leaves get the files to account and limit with, only the ones the parent has can be requested
+    if (!controllers_enabled) {
+        controllers_enabled = true;
+        std::string const available = syscall_wrapper::read_file_wrapper(root + CONTROLLERS_FILE).value_or("");
+        std::optional<file_descriptor_wrapper> const subtree_control = syscall_wrapper::open_wrapper(root + SUBTREE_CONTROL_FILE, O_WRONLY | O_CLOEXEC, 0);
+        for (std::string_view const controller : CONTROLLERS) {
+            if (subtree_control.has_value() && available.find(controller.substr(1)) != std::string::npos) {
+                std::ignore = syscall_wrapper::write_wrapper(subtree_control.value(), controller.data(), controller.size());
+            }
+        }
+    }
+
+    // every job gets a leaf named after the shell and a counter, so several shells can share one delegated directory
+    std::optional<pid_t> const shell_pid = syscall_wrapper::getpid_wrapper();
+    assert(shell_pid.has_value()); // getpid never fails
+    std::string path = root + LEAF_PREFIX + std::to_string(shell_pid.value()) + '-' + std::to_string(next_leaf++);
+    if (!syscall_wrapper::mkdir_wrapper(path, LEAF_MODE)) {
+        return nullptr;
+    }
+
+    std::optional<file_descriptor_wrapper> procs = syscall_wrapper::open_wrapper(path + PROCS_FILE, O_WRONLY | O_CLOEXEC, 0);
+    if (!procs.has_value()) {
+        std::ignore = syscall_wrapper::rmdir_wrapper(path);
+        return nullptr;
+    }
+
+    std::shared_ptr<job_cgroup> group(new job_cgroup(std::move(path), std::move(procs.value())));
+
+    // a limit which can not be applied is reported, the job still runs without it
+    if (limits.memory_max.has_value()) {
+        std::ignore = group->write_attribute(MEMORY_MAX_FILE, limits.memory_max.value());
+    }
+    if (limits.cpu_max.has_value()) {
+        std::ignore = group->write_attribute(CPU_MAX_FILE, limits.cpu_max.value());
+    }
+
+    return group;
+}
+
+auto job_cgroup::write_attribute(char const* file, std::string_view value) const -> bool {
+    std::optional<file_descriptor_wrapper> const fides = syscall_wrapper::open_wrapper(path + file, O_WRONLY | O_CLOEXEC, 0);
+    if (!fides.has_value()) {
+        return false;
+    }
+    return syscall_wrapper::write_wrapper(fides.value(), value.data(), value.size()).has_value();
+}
+
+auto job_cgroup::parse_memory_max(std::string_view value) -> std::optional<std::string> {
+    if (value == UNLIMITED_STR) {
+        return std::make_optional<std::string>(value);
+    }
+
+    // a byte count, optionally in KiB, MiB, or GiB
+    std::uint64_t size = 0;
+    auto [ptr, err] = std::from_chars(value.data(), value.data() + value.size(), size);
+    if (err != std::errc{} || size == 0) {
+        return std::nullopt;
+    }
+    std::string_view const suffix = value.substr(static_cast<std::size_t>(ptr - value.data()));
+    if (suffix.size() > 1 || (!suffix.empty() && std::string_view("KkMmGg").find(suffix.front()) == std::string_view::npos)) {
+        return std::nullopt;
+    }
+
+    // the kernel understands the same suffixes
+    return std::make_optional<std::string>(value);
+}
+
+auto job_cgroup::parse_cpu_max(std::string_view value) -> std::optional<std::string> {
+    if (value == UNLIMITED_STR) {
+        return std::make_optional<std::string>(value);
+    }
+
+    // the quota and the period are both in microseconds
+    std::uint64_t quota = 0;
+    std::uint64_t period = DEFAULT_CPU_PERIOD;
+    auto [ptr, err] = std::from_chars(value.data(), value.data() + value.size(), quota);
+    if (err != std::errc{} || quota == 0) {
+        return std::nullopt;
+    }
+    if (ptr != value.data() + value.size()) {
+        if (*ptr != '/') {
+            return std::nullopt;
+        }
+        auto [period_ptr, period_err] = std::from_chars(ptr + 1, value.data() + value.size(), period);
+        if (period_err != std::errc{} || period_ptr != value.data() + value.size() || period == 0) {
+            return std::nullopt;
+        }
+    }
+
+    return std::make_optional<std::string>(std::to_string(quota) + ' ' + std::to_string(period));
+}
+
+auto job_cgroup::join() const -> bool {
+    // writing 0 moves the writer itself
+    static constexpr std::string_view SELF = "0";
+    assert(procs.has_value());
+    return syscall_wrapper::write_wrapper(procs.value(), SELF.data(), SELF.size()).has_value();
+}
+
+auto job_cgroup::add(pid_t pid) const -> bool {
+    std::string const pid_str = std::to_string(pid);
+    assert(procs.has_value());
+    return syscall_wrapper::write_wrapper(procs.value(), pid_str.data(), pid_str.size()).has_value();
+}
+
+auto job_cgroup::usage() const -> cgroup_usage {
+    cgroup_usage usage;
+
+    // cpu.stat has a "key value" pair on every line, io.stat has a device followed by key=value pairs on every line
+    auto for_each_pair = [](std::string_view contents, auto&& callback) {
+        while (!contents.empty()) {
+            std::size_t const line_end = std::min(contents.find('\n'), contents.size());
+            std::string_view line = contents.substr(0, line_end);
+            contents.remove_prefix(std::min(line_end + 1, contents.size()));
+
+            std::size_t const space = line.find(' ');
+            if (space == std::string_view::npos) {
+                continue;
+            }
+
+            std::string_view const first = line.substr(0, space);
+            line.remove_prefix(space + 1);
+            while (!line.empty()) {
+                std::size_t const token_end = std::min(line.find(' '), line.size());
+                std::string_view const token = line.substr(0, token_end);
+                line.remove_prefix(std::min(token_end + 1, line.size()));
+
+                // a bare value belongs to the key which starts the line
+                std::size_t const equals = token.find('=');
+                std::string_view const key = equals == std::string_view::npos ? first : token.substr(0, equals);
+                std::string_view const val_str = equals == std::string_view::npos ? token : token.substr(equals + 1);
+                std::uint64_t val = 0;
+                if (std::from_chars(val_str.data(), val_str.data() + val_str.size(), val).ec == std::errc{}) {
+                    callback(key, val);
+                }
+            }
+        }
+    };
+
+    // CPU time is always accounted in cgroup v2
+    if (std::optional<std::string> const cpu_stat = syscall_wrapper::read_file_wrapper(path + CPU_STAT_FILE); cpu_stat.has_value()) {
+        for_each_pair(cpu_stat.value(), [&](std::string_view key, std::uint64_t val) {
+            if (key == "usage_usec") {
+                usage.usage_usec = val;
+            } else if (key == "user_usec") {
+                usage.user_usec = val;
+            } else if (key == "system_usec") {
+                usage.system_usec = val;
+            }
+        });
+    }
+
+    // memory.peak only exists with the memory controller on a kernel newer than 5.19
+    if (std::optional<std::string> const peak = syscall_wrapper::read_file_wrapper(path + MEMORY_PEAK_FILE); peak.has_value()) {
+        std::uint64_t val = 0;
+        if (std::from_chars(peak.value().data(), peak.value().data() + peak.value().size(), val).ec == std::errc{}) {
+            usage.memory_peak = val;
+        }
+    }
+
+    // io.stat has one line per device, each with rbytes= and wbytes= among other counters
+    if (std::optional<std::string> const io_stat = syscall_wrapper::read_file_wrapper(path + IO_STAT_FILE); io_stat.has_value()) {
+        usage.io_read_bytes = 0;
+        usage.io_write_bytes = 0;
+        for_each_pair(io_stat.value(), [&](std::string_view key, std::uint64_t val) {
+            if (key == "rbytes") {
+                *usage.io_read_bytes += val;
+            } else if (key == "wbytes") {
+                *usage.io_write_bytes += val;
+            }
+        });
+    }
+
+    return usage;
+}
+
+void job_cgroup::record(cgroup_usage const& usage) {
+    last_usage = usage;
+}
+
+auto job_cgroup::last() -> std::optional<cgroup_usage> const& {
+    return last_usage;
+}
+
+void job_cgroup::print([[maybe_unused]] logger& log) {
+    if (!last_usage.has_value()) {
+        return;
+    }
+
+    // the optional counters are printed as - when their controller is not available
+    auto print_optional = [&](std::optional<std::uint64_t> const& val) {
+        if (val.has_value()) {
+            log.log(LOG_LEVEL::SILENT, val.value());
+        } else {
+            log.log(LOG_LEVEL::SILENT, '-');
+        }
+    };
+
+    log.log(LOG_LEVEL::SILENT, "usage_usec\tuser_usec\tsystem_usec\tmemory_peak\tio_read_bytes\tio_write_bytes\n");
+    log.log(LOG_LEVEL::SILENT, last_usage->usage_usec, '\t', last_usage->user_usec, '\t', last_usage->system_usec, '\t');
+    print_optional(last_usage->memory_peak);
+    log.log(LOG_LEVEL::SILENT, '\t');
+    print_optional(last_usage->io_read_bytes);
+    log.log(LOG_LEVEL::SILENT, '\t');
+    print_optional(last_usage->io_write_bytes);
+    log.log(LOG_LEVEL::SILENT, '\n');
+}
+} // namespace jsh
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "environment.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * structure describing the limits placed on a job's cgroup, in the format the kernel expects
+ *
+ * memory_max: the value written to memory.max (a memory_max=SIZE prefix)
+ *
+ * cpu_max: the value written to cpu.max (a cpu_max=QUOTA[/PERIOD] prefix)
+ */
+struct cgroup_limits {
+    std::optional<std::string> memory_max;
+    std::optional<std::string> cpu_max;
+};
+
+/**
+ * structure describing the resources a job used, every process the job started is counted including grandchildren
+ *
+ * usage_usec, user_usec, system_usec: the CPU time from cpu.stat
+ *
+ * memory_peak: the most memory the job used at once from memory.peak, std::nullopt without the memory controller
+ *
+ * io_read_bytes, io_write_bytes: the bytes the job moved through block devices from io.stat, std::nullopt without the io controller
+ */
+struct cgroup_usage {
+    std::uint64_t usage_usec = 0;
+    std::uint64_t user_usec = 0;
+    std::uint64_t system_usec = 0;
+    std::optional<std::uint64_t> memory_peak;
+    std::optional<std::uint64_t> io_read_bytes;
+    std::optional<std::uint64_t> io_write_bytes;
+};
+
+/**
+ * job_cgroup: a cgroup v2 leaf holding every process of one job, removed once the last reference to it goes away
+ *
+ * NOTES: leaves are created under the delegated directory named by JSH_CGROUP_ROOT, forked children move themselves in by writing 0 to cgroup.procs before they exec, spawned children are moved in by the shell right after posix_spawn returns
+ */
+class job_cgroup {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* PROCS_FILE = "/cgroup.procs";
+    static constexpr char const* CONTROLLERS_FILE = "/cgroup.controllers";
+    static constexpr char const* SUBTREE_CONTROL_FILE = "/cgroup.subtree_control";
+    static constexpr char const* CPU_STAT_FILE = "/cpu.stat";
+    static constexpr char const* MEMORY_PEAK_FILE = "/memory.peak";
+    static constexpr char const* IO_STAT_FILE = "/io.stat";
+    static constexpr char const* MEMORY_MAX_FILE = "/memory.max";
+    static constexpr char const* CPU_MAX_FILE = "/cpu.max";
+    static constexpr char const* LEAF_PREFIX = "/jsh-";
+    static constexpr char const* CONTROLLERS[] = {"+cpu", "+memory", "+io"}; // NOLINT
+    static constexpr std::string_view UNLIMITED_STR = "max";
+    static constexpr std::uint64_t DEFAULT_CPU_PERIOD = 100000;
+    static constexpr mode_t LEAF_MODE = 0755;
+
+    /**
+     * path: the directory of the leaf
+     */
+    std::string path;
+
+    /**
+     * procs: cgroup.procs of the leaf, kept open so children can join without resolving the path
+     */
+    std::optional<file_descriptor_wrapper> procs;
+
+    /**
+     * next_leaf: used to give every leaf created by this shell a unique name
+     */
+    static std::size_t next_leaf;
+
+    /**
+     * controllers_enabled: whether the controllers have been requested for the children of JSH_CGROUP_ROOT yet
+     */
+    static bool controllers_enabled;
+
+    /**
+     * last_usage: the usage of the most recently finished job which ran in a cgroup
+     */
+    static std::optional<cgroup_usage> last_usage;
+
+    /**
+     * constructor which takes ownership of an already created leaf
+     */
+    job_cgroup(std::string path, file_descriptor_wrapper procs);
+
+    /**
+     * write_attribute: writes value to one of the leaf's attribute files
+     */
+    [[nodiscard]] auto write_attribute(char const* file, std::string_view value) const -> bool;
+
+  public:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* CGROUP_ROOT_VAR = "JSH_CGROUP_ROOT";
+
+    /**
+     * delete other constructors
+     */
+    job_cgroup(job_cgroup const& other) = delete;
+    job_cgroup(job_cgroup&& other) = delete;
+    auto operator=(job_cgroup const& other) -> job_cgroup& = delete;
+    auto operator=(job_cgroup&& other) -> job_cgroup& = delete;
+
+    /**
+     * destructor which removes the leaf, a leaf which still holds processes is left behind
+     */
+    ~job_cgroup();
+
+    /**
+     * enabled: whether jobs should be placed in cgroups at all, which is the case once JSH_CGROUP_ROOT is set
+     */
+    [[nodiscard]] static auto enabled() -> bool;
+
+    /**
+     * create: creates a new leaf under JSH_CGROUP_ROOT and applies the limits to it
+     *
+     * returns nullptr if cgroups are not enabled or the leaf could not be created
+     */
+    [[nodiscard]] static auto create(cgroup_limits const& limits) -> std::shared_ptr<job_cgroup>;
+
+    /**
+     * parse_memory_max: parses max or a byte count with an optional K, M, or G suffix
+     *
+     * returns std::nullopt if the value is not understood
+     */
+    [[nodiscard]] static auto parse_memory_max(std::string_view value) -> std::optional<std::string>;
+
+    /**
+     * parse_cpu_max: parses max or a quota in microseconds with an optional /PERIOD, the period defaults to 100ms
+     *
+     * returns std::nullopt if the value is not understood
+     */
+    [[nodiscard]] static auto parse_cpu_max(std::string_view value) -> std::optional<std::string>;
+
+    /**
+     * join: moves the calling process into the leaf, used by forked children before they exec
+     */
+    [[nodiscard]] auto join() const -> bool;
+
+    /**
+     * add: moves another process into the leaf
+     */
+    [[nodiscard]] auto add(pid_t pid) const -> bool;
+
+    /**
+     * usage: reads the resources used by every process that has been in the leaf
+     */
+    [[nodiscard]] auto usage() const -> cgroup_usage;
+
+    /**
+     * record: remembers the usage of a finished job so it can be printed
+     */
+    static void record(cgroup_usage const& usage);
+
+    /**
+     * last: the usage of the most recently finished job which ran in a cgroup
+     */
+    [[nodiscard]] static auto last() -> std::optional<cgroup_usage> const&;
+
+    /**
+     * print: prints the usage of the most recently finished job which ran in a cgroup
+     */
+    static void print([[maybe_unused]] logger& log = cout_logger);
+};
+} // namespace jsh
@@ -0,0 +1,145 @@
+#include "command_hash.hpp"
+
+namespace jsh {
+std::unordered_map<std::string, std::optional<std::string>> command_hash::table{};
+std::optional<file_descriptor_wrapper> command_hash::inotify_fides = std::nullopt;
+bool command_hash::inotify_unavailable = false;
+
+void command_hash::watch_path() {
+    // the failure has already been logged, the table works without inotify
+    if (inotify_unavailable) {
+        return;
+    }
+
+    // closing the old instance drops all of its watches
+    inotify_fides = syscall_wrapper::inotify_init_wrapper(IN_NONBLOCK | IN_CLOEXEC);
+
+    // error handle, without inotify the table is only cleared by export and hash -r
+    if (!inotify_fides.has_value()) {
+        inotify_unavailable = true;
+        return;
+    }
+
+    // watch each of the directories on PATH
+    std::string_view const path = environment::get_var(PATH_VAR);
+    std::size_t begin = 0;
+    while (begin <= path.size()) {
+        std::size_t end = path.find(PATH_SEPARATOR, begin);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+
+        // an empty entry is the current directory
+        std::string dir{path.substr(begin, end - begin)};
+        if (dir.empty()) {
+            dir = ".";
+        }
+
+        // skip directories which do not exist
+        std::error_code err;
+        if (std::filesystem::is_directory(dir, err)) {
+            std::ignore = syscall_wrapper::inotify_add_watch_wrapper(inotify_fides.value(), dir, WATCH_MASK);
+        }
+
+        begin = end + 1;
+    }
+}
+
+void command_hash::check_events() {
+    // nothing to check without an inotify instance
+    if (!inotify_fides.has_value()) {
+        return;
+    }
+
+    // drain the events without blocking, the content does not matter since any change clears the whole table
+    alignas(inotify_event) std::array<char, EVENT_BUF_SIZE> buf; // NOLINT only ever read into
+    bool changed = false;
+    while (true) {
+        std::optional<ssize_t> const bytes = syscall_wrapper::read_nonblocking_wrapper(inotify_fides.value(), buf.data(), buf.size());
+        if (!bytes.has_value() || bytes.value() == 0) [[likely]] {
+            break;
+        }
+        changed = true;
+    }
+    if (!changed) [[likely]] {
+        return;
+    }
+
+    cout_logger.log(LOG_LEVEL::DEBUG, "PATH directory changed, clearing the command hash...");
+    table.clear();
+}
+
+auto command_hash::search_path(std::string const& name) -> std::optional<std::string> {
+    std::string_view const path = environment::get_var(PATH_VAR);
+
+    std::string candidate;
+    std::size_t begin = 0;
+    while (begin <= path.size()) {
+        std::size_t end = path.find(PATH_SEPARATOR, begin);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+
+        // an empty entry is the current directory
+        candidate.assign(path.substr(begin, end - begin));
+        if (candidate.empty()) {
+            candidate = ".";
+        }
+        candidate.append("/").append(name);
+
+        // the first executable regular file wins
+        if (syscall_wrapper::is_executable_wrapper(candidate)) {
+            return std::make_optional<std::string>(std::move(candidate));
+        }
+
+        begin = end + 1;
+    }
+
+    return std::nullopt;
+}
+
+auto command_hash::lookup(std::string const& name) -> std::optional<std::string> {
+    // paths are never searched for
+    if (name.find('/') != std::string::npos) {
+        return std::make_optional<std::string>(name);
+    }
+
+    // start watching PATH the first time a command is looked up
+    if (!inotify_fides.has_value() && !inotify_unavailable) [[unlikely]] {
+        watch_path();
+    }
+
+    // drop stale entries before using the table
+    check_events();
+
+    // check for a remembered hit or miss
+    if (auto itr = table.find(name); itr != std::end(table)) [[likely]] {
+        return itr->second;
+    }
+
+    // remember the result of the search either way
+    std::optional<std::string> found = search_path(name);
+    table.emplace(name, found);
+    return found;
+}
+
+void command_hash::clear() {
+    table.clear();
+}
+
+void command_hash::invalidate_path() {
+    table.clear();
+    watch_path();
+}
+
+auto command_hash::is_path_var(std::string const& var) -> bool {
+    return var == PATH_VAR;
+}
+
+void command_hash::print([[maybe_unused]] logger& log) {
+    // print each entry of the form name path
+    for (auto const& [name, path] : table) {
+        log.log(LOG_LEVEL::SILENT, name, '\t', path.has_value() ? path.value() : "(not found)", '\n');
+    }
+}
+} // namespace jsh
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "environment.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * command_hash: remembers where each command was found on PATH so exec does not have to search PATH every time
+ *
+ * NOTES: misses are cached as well, the table is cleared when PATH is exported or when inotify reports a change in one of the PATH directories
+ */
+class command_hash {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* PATH_VAR = "PATH";
+    static constexpr char PATH_SEPARATOR = ':';
+    static constexpr std::uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+    static constexpr std::size_t EVENT_BUF_SIZE = 4096;
+
+    /**
+     * table: maps a command name to its absolute path, or std::nullopt if the command is not on PATH
+     */
+    static std::unordered_map<std::string, std::optional<std::string>> table;
+
+    /**
+     * inotify_fides: inotify instance watching every directory on PATH
+     */
+    static std::optional<file_descriptor_wrapper> inotify_fides;
+
+    /**
+     * inotify_unavailable: inotify could not be started, so the table is only cleared by export and hash -r and watching is never tried again
+     */
+    static bool inotify_unavailable;
+
+    /**
+     * watch_path: starts watching every directory on the current PATH, unless inotify has already failed once
+     */
+    static void watch_path();
+
+    /**
+     * check_events: clears the table if any of the PATH directories have changed since the last check
+     */
+    static void check_events();
+
+    /**
+     * search_path: walks the PATH directories looking for an executable called name
+     */
+    [[nodiscard]] static auto search_path(std::string const& name) -> std::optional<std::string>;
+
+  public:
+    /**
+     * lookup: returns the path which should be handed to exec for the command name, or std::nullopt if it could not be found
+     *
+     * name: the name of the command, names containing a '/' are returned as is
+     */
+    [[nodiscard]] static auto lookup(std::string const& name) -> std::optional<std::string>;
+
+    /**
+     * clear: forgets every remembered command
+     */
+    static void clear();
+
+    /**
+     * invalidate_path: clears the table and moves the inotify watches to the directories on the new PATH
+     */
+    static void invalidate_path();
+
+    /**
+     * is_path_var: returns whether var is the name of the PATH variable
+     */
+    [[nodiscard]] static auto is_path_var(std::string const& var) -> bool;
+
+    /**
+     * print: prints every remembered command and where it was found
+     */
+    static void print([[maybe_unused]] logger& log = cout_logger);
+};
+} // namespace jsh
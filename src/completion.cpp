@@ -0,0 +1,418 @@
+#include "completion.hpp"
+
+namespace jsh {
+executable_trie completion::trie{};
+std::vector<completion::path_directory> completion::directories{};
+std::optional<file_descriptor_wrapper> completion::inotify_fides = std::nullopt;
+reactor* completion::events = nullptr;
+std::optional<std::uint64_t> completion::token = std::nullopt;
+
+auto executable_trie::child(std::uint32_t node, unsigned char chr) const -> std::optional<std::uint32_t> {
+    auto const& children = nodes[node].children;
+    auto const itr = std::ranges::lower_bound(children, chr, {}, &std::pair<unsigned char, std::uint32_t>::first);
+    if (itr == std::end(children) || itr->first != chr) {
+        return std::nullopt;
+    }
+    return std::make_optional<std::uint32_t>(itr->second);
+}
+
+void executable_trie::insert(std::string_view name) {
+    // walk down the trie, adding the nodes the name is missing
+    std::vector<std::uint32_t> path{0};
+    path.reserve(name.size() + 1);
+    for (char const chr : name) {
+        auto const key = static_cast<unsigned char>(chr);
+        std::optional<std::uint32_t> next = child(path.back(), key);
+        if (!next.has_value()) {
+            if (free_nodes.empty()) {
+                next = static_cast<std::uint32_t>(nodes.size());
+                nodes.emplace_back();
+            } else {
+                next = free_nodes.back();
+                free_nodes.pop_back();
+            }
+
+            auto& children = nodes[path.back()].children;
+            auto const itr = std::ranges::lower_bound(children, key, {}, &std::pair<unsigned char, std::uint32_t>::first);
+            children.emplace(itr, key, next.value());
+        }
+        path.push_back(next.value());
+    }
+
+    // only the first occurrence adds a name
+    if (nodes[path.back()].count++ == 0) {
+        for (std::uint32_t const node : path) {
+            ++nodes[node].below;
+        }
+    }
+}
+
+void executable_trie::erase(std::string_view name) {
+    std::vector<std::uint32_t> path{0};
+    path.reserve(name.size() + 1);
+    for (char const chr : name) {
+        std::optional<std::uint32_t> const next = child(path.back(), static_cast<unsigned char>(chr));
+        if (!next.has_value()) {
+            return;
+        }
+        path.push_back(next.value());
+    }
+
+    // the name stays as long as another occurrence of it is left
+    if (nodes[path.back()].count == 0 || --nodes[path.back()].count != 0) {
+        return;
+    }
+    for (std::uint32_t const node : path) {
+        --nodes[node].below;
+    }
+
+    // nodes no name goes through any more are unlinked from their parent and reused, the root always stays
+    for (std::size_t i = path.size() - 1; i > 0; --i) {
+        std::uint32_t const node = path[i];
+        if (nodes[node].below != 0) {
+            break;
+        }
+        nodes[node].children.clear();
+        free_nodes.push_back(node);
+
+        auto& siblings = nodes[path[i - 1]].children;
+        std::erase_if(siblings, [node](auto const& entry) { return entry.second == node; });
+    }
+}
+
+auto executable_trie::contains(std::string_view name) const -> bool {
+    std::uint32_t node = 0;
+    for (char const chr : name) {
+        std::optional<std::uint32_t> const next = child(node, static_cast<unsigned char>(chr));
+        if (!next.has_value()) {
+            return false;
+        }
+        node = next.value();
+    }
+    return nodes[node].count != 0;
+}
+
+auto executable_trie::size() const -> std::size_t {
+    return nodes.front().below;
+}
+
+void executable_trie::clear() {
+    nodes.assign(1, trie_node{});
+    free_nodes.clear();
+}
+
+void executable_trie::collect(std::uint32_t node, std::string& name, std::size_t limit, std::vector<std::string>& names) const {
+    if (names.size() >= limit) {
+        return;
+    }
+    if (nodes[node].count != 0) {
+        names.push_back(name);
+    }
+
+    // children are sorted, so the names come out in order
+    for (auto const& [chr, next] : nodes[node].children) {
+        if (names.size() >= limit) {
+            return;
+        }
+        name.push_back(static_cast<char>(chr));
+        collect(next, name, limit, names);
+        name.pop_back();
+    }
+}
+
+auto executable_trie::complete(std::string_view prefix, std::size_t limit) const -> trie_matches {
+    trie_matches matches;
+
+    std::uint32_t node = 0;
+    for (char const chr : prefix) {
+        std::optional<std::uint32_t> const next = child(node, static_cast<unsigned char>(chr));
+        if (!next.has_value()) {
+            return matches;
+        }
+        node = next.value();
+    }
+    matches.total = nodes[node].below;
+
+    // the matches share every character up to the first node which ends a name or branches
+    std::uint32_t shared = node;
+    while (nodes[shared].count == 0 && nodes[shared].children.size() == 1) {
+        matches.common.push_back(static_cast<char>(nodes[shared].children.front().first));
+        shared = nodes[shared].children.front().second;
+    }
+
+    std::string name(prefix);
+    collect(node, name, limit, matches.names);
+    return matches;
+}
+
+auto completion::is_executable(std::string const& dir, std::string const& name) -> bool {
+    return syscall_wrapper::is_executable_wrapper(dir + DIRECTORY_SEPARATOR + name);
+}
+
+void completion::refresh(path_directory& dir, std::string const& name, bool executable) {
+    bool const known = dir.names.contains(name);
+    if (executable && !known) {
+        trie.insert(name);
+        dir.names.insert(name);
+    } else if (!executable && known) {
+        trie.erase(name);
+        dir.names.erase(name);
+    }
+}
+
+void completion::forget(path_directory& dir) {
+    for (std::string const& name : dir.names) {
+        trie.erase(name);
+    }
+    dir.names.clear();
+    dir.scan.reset();
+}
+
+void completion::rescan(path_directory& dir) {
+    forget(dir);
+
+    // directories which do not exist are skipped
+    std::error_code err;
+    std::filesystem::directory_iterator scan(dir.path, err);
+    if (!err) {
+        dir.scan = std::move(scan);
+    }
+}
+
+void completion::watch(reactor* events) {
+    // stop keeping the trie, the inotify instance has to leave the reactor before it is closed
+    if (completion::events != nullptr && token.has_value() && inotify_fides.has_value()) {
+        completion::events->remove(inotify_fides.value(), token.value());
+    }
+    token.reset();
+    inotify_fides.reset();
+    directories.clear();
+    trie.clear();
+    completion::events = events;
+    if (events == nullptr) {
+        return;
+    }
+
+    // without inotify the trie is still built, it just is not updated when PATH changes on disk
+    inotify_fides = syscall_wrapper::inotify_init_wrapper(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fides.has_value()) {
+        token = events->add(inotify_fides.value(), &completion::read_events);
+    }
+
+    invalidate_path();
+}
+
+void completion::invalidate_path() {
+    // nothing to update when no trie is kept, such as in a script
+    if (events == nullptr) {
+        return;
+    }
+
+    // split PATH into its directories, each one only once
+    std::vector<std::string> paths;
+    std::string_view const path = environment::get_var(PATH_VAR);
+    std::size_t begin = 0;
+    while (begin <= path.size()) {
+        std::size_t end = path.find(PATH_SEPARATOR, begin);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+
+        // an empty entry is the current directory
+        std::string dir{path.substr(begin, end - begin)};
+        if (dir.empty()) {
+            dir = ".";
+        }
+        if (std::ranges::find(paths, dir) == std::end(paths)) {
+            paths.push_back(std::move(dir));
+        }
+
+        begin = end + 1;
+    }
+
+    // directories which stay on PATH keep what was read from them, the rest are forgotten
+    std::vector<path_directory> next;
+    next.reserve(paths.size());
+    for (std::string& dir : paths) {
+        auto const existing = std::ranges::find(directories, dir, &path_directory::path);
+        if (existing != std::end(directories)) {
+            next.push_back(std::move(*existing));
+            directories.erase(existing);
+            continue;
+        }
+
+        // the watch is added before the directory is read so nothing created in between is missed
+        path_directory added{.path = std::move(dir), .watch = std::nullopt, .names = {}, .scan = std::nullopt};
+        if (inotify_fides.has_value()) {
+            added.watch = syscall_wrapper::inotify_add_watch_wrapper(inotify_fides.value(), added.path, WATCH_MASK);
+        }
+        rescan(added);
+        next.push_back(std::move(added));
+    }
+    for (path_directory& dir : directories) {
+        forget(dir);
+        if (dir.watch.has_value() && inotify_fides.has_value()) {
+            std::ignore = syscall_wrapper::inotify_rm_watch_wrapper(inotify_fides.value(), dir.watch.value());
+        }
+    }
+    directories = std::move(next);
+}
+
+auto completion::building() -> bool {
+    return std::ranges::any_of(directories, [](path_directory const& dir) { return dir.scan.has_value(); });
+}
+
+void completion::build_step() {
+    std::size_t entries = 0;
+    for (path_directory& dir : directories) {
+        while (dir.scan.has_value() && entries < STEP_ENTRIES) {
+            std::filesystem::directory_iterator& scan = dir.scan.value();
+            if (scan == std::filesystem::directory_iterator{}) {
+                dir.scan.reset();
+                break;
+            }
+
+            // the type read along with the entry saves a stat for everything but symbolic links
+            std::error_code type_err;
+            bool const executable = scan->is_regular_file(type_err) && syscall_wrapper::is_executable_wrapper(scan->path().string(), true);
+            refresh(dir, scan->path().filename().string(), executable);
+            ++entries;
+
+            // a directory which can not be read any further keeps what was read from it
+            std::error_code err;
+            scan.increment(err);
+            if (err) {
+                dir.scan.reset();
+            }
+        }
+
+        if (entries >= STEP_ENTRIES) {
+            return;
+        }
+    }
+}
+
+void completion::finish() {
+    while (building()) {
+        build_step();
+    }
+}
+
+void completion::read_events() {
+    assert(inotify_fides.has_value());
+
+    // inotify events are aligned for the struct they start with
+    alignas(inotify_event) std::array<char, EVENT_BUF_SIZE> buf{};
+    std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(inotify_fides.value(), buf.data(), buf.size()); // NOLINT assert catches this
+    if (!num_read.has_value()) {
+        return;
+    }
+
+    std::size_t offset = 0;
+    while (offset + sizeof(inotify_event) <= static_cast<std::size_t>(num_read.value())) {
+        inotify_event const* event = reinterpret_cast<inotify_event const*>(buf.data() + offset); // NOLINT the kernel lays the events out in the buffer
+        offset += sizeof(inotify_event) + event->len;
+
+        // events were dropped, so nothing the trie holds can be trusted
+        if ((event->mask & IN_Q_OVERFLOW) != 0) {
+            std::ranges::for_each(directories, &completion::rescan);
+            continue;
+        }
+
+        auto const dir = std::ranges::find(directories, std::make_optional<int>(event->wd), &path_directory::watch);
+        if (dir == std::end(directories)) {
+            continue;
+        }
+
+        // the directory itself went away along with everything in it
+        if ((event->mask & GONE_MASK) != 0) {
+            forget(*dir);
+            dir->watch.reset();
+            continue;
+        }
+
+        // created, removed, renamed, or had its mode changed, either way it is checked again
+        if (event->len != 0) {
+            std::string const name(event->name); // NOLINT the name is null terminated
+            refresh(*dir, name, is_executable(dir->path, name));
+        }
+    }
+}
+
+auto completion::contains(std::string_view name) -> bool {
+    return trie.contains(name);
+}
+
+auto completion::complete_command(std::string_view word) -> completion_result {
+    // the trie has to hold all of PATH for the candidates to be right
+    finish();
+
+    trie_matches matches = trie.complete(word, MAX_CANDIDATES);
+    completion_result result{.suffix = std::move(matches.common), .candidates = std::move(matches.names), .total = matches.total};
+
+    // a single match is a finished word
+    if (result.total == 1) {
+        result.suffix += ' ';
+    }
+    return result;
+}
+
+auto completion::complete_file(std::string_view word) -> completion_result {
+    // the directory is everything up to the last slash, the rest is the start of the name
+    std::size_t const slash = word.rfind(DIRECTORY_SEPARATOR);
+    std::string const dir = slash == std::string_view::npos ? "." : (slash == 0 ? "/" : std::string(word.substr(0, slash)));
+    std::string_view const start = slash == std::string_view::npos ? word : word.substr(slash + 1);
+
+    // hidden files are only completed when asked for
+    std::vector<std::string> names;
+    std::error_code err;
+    for (std::filesystem::directory_iterator scan(dir, err); !err && scan != std::filesystem::directory_iterator{}; scan.increment(err)) {
+        std::string name = scan->path().filename().string();
+        if (!name.starts_with(start) || (name.front() == HIDDEN && !start.starts_with(HIDDEN))) {
+            continue;
+        }
+
+        // directories are completed with their slash so the next tab goes inside of them
+        std::error_code type_err;
+        if (scan->is_directory(type_err)) {
+            name += DIRECTORY_SEPARATOR;
+        }
+        names.push_back(std::move(name));
+    }
+
+    completion_result result{.suffix = {}, .candidates = {}, .total = names.size()};
+    if (names.empty()) {
+        return result;
+    }
+
+    // every match shares the characters after the start up to the first one where two of them differ
+    std::ranges::sort(names);
+    std::string_view const first = names.front();
+    std::string_view const last = names.back();
+    std::size_t const shared = static_cast<std::size_t>(std::ranges::mismatch(first, last).in1 - std::begin(first));
+    result.suffix = first.substr(start.size(), shared - start.size());
+
+    // a single file is a finished word, a single directory is not
+    if (names.size() == 1 && !first.ends_with(DIRECTORY_SEPARATOR)) {
+        result.suffix += ' ';
+    }
+
+    names.resize(std::min(names.size(), MAX_CANDIDATES));
+    result.candidates = std::move(names);
+    return result;
+}
+
+auto completion::complete(std::string_view line) -> completion_result {
+    // the word being completed starts after the last space
+    std::size_t const space = line.find_last_of(" \t");
+    std::string_view const word = space == std::string_view::npos ? line : line.substr(space + 1);
+    std::string_view before = space == std::string_view::npos ? std::string_view{} : line.substr(0, space);
+    while (!before.empty() && static_cast<bool>(std::isspace(static_cast<unsigned char>(before.back())))) {
+        before.remove_suffix(1);
+    }
+
+    // the first word of every command is a command unless it is a path
+    bool const command = (before.empty() || COMMAND_SEPARATORS.find(before.back()) != std::string_view::npos) && word.find(DIRECTORY_SEPARATOR) == std::string_view::npos;
+    return command ? complete_command(word) : complete_file(word);
+}
+} // namespace jsh
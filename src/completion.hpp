@@ -0,0 +1,258 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "environment.hpp"
+#include "line_editor.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+#include "reactor.hpp"
+
+namespace jsh {
+/**
+ * trie_matches: the names in a trie which start with a prefix
+ */
+struct trie_matches {
+    /**
+     * common: the characters after the prefix which every match shares
+     */
+    std::string common;
+
+    /**
+     * names: the first matches in sorted order
+     */
+    std::vector<std::string> names;
+
+    /**
+     * total: the number of matches, which may be more than were handed back
+     */
+    std::size_t total = 0;
+};
+
+/**
+ * executable_trie: a prefix tree of command names, so completing a prefix only touches the prefix and the matches handed back
+ *
+ * NOTES: nodes live in one vector and refer to each other by index, a name may be inserted once for every directory it is found in and is only gone once it has been erased as many times
+ */
+class executable_trie {
+  private:
+    /**
+     * trie_node: one character of one or more names
+     */
+    struct trie_node {
+        /**
+         * children: the next character of every name going through this node and the node it leads to, sorted by character
+         */
+        std::vector<std::pair<unsigned char, std::uint32_t>> children;
+
+        /**
+         * count: the number of times the name ending here was inserted and not erased
+         */
+        std::uint32_t count = 0;
+
+        /**
+         * below: the number of names ending here or further down
+         */
+        std::uint32_t below = 0;
+    };
+
+    /**
+     * nodes: every node, the root is the first
+     */
+    std::vector<trie_node> nodes = std::vector<trie_node>(1);
+
+    /**
+     * free_nodes: nodes which were pruned and can be reused
+     */
+    std::vector<std::uint32_t> free_nodes;
+
+    /**
+     * child: the node chr leads to from node
+     *
+     * returns std::nullopt if no name continues with chr
+     */
+    [[nodiscard]] auto child(std::uint32_t node, unsigned char chr) const -> std::optional<std::uint32_t>;
+
+    /**
+     * collect: appends the names ending at node or below it, in sorted order, until names holds limit of them
+     *
+     * name: the name node stands for, used as scratch space
+     */
+    void collect(std::uint32_t node, std::string& name, std::size_t limit, std::vector<std::string>& names) const;
+
+  public:
+    /**
+     * insert: adds one occurrence of name
+     */
+    void insert(std::string_view name);
+
+    /**
+     * erase: removes one occurrence of name, nodes no name goes through any more are pruned
+     */
+    void erase(std::string_view name);
+
+    /**
+     * contains: whether name has been inserted more times than erased
+     */
+    [[nodiscard]] auto contains(std::string_view name) const -> bool;
+
+    /**
+     * size: the number of distinct names
+     */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /**
+     * clear: removes every name
+     */
+    void clear();
+
+    /**
+     * complete: the names starting with prefix, at most limit of them are handed back
+     */
+    [[nodiscard]] auto complete(std::string_view prefix, std::size_t limit) const -> trie_matches;
+};
+
+/**
+ * completion: completes commands from the executables on PATH and every other word from the files in its directory
+ *
+ * NOTES: the executables are kept in a trie which is built a few directory entries at a time whenever the reactor has nothing else ready, inotify events and exporting PATH update it in place instead of rebuilding it
+ */
+class completion {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* PATH_VAR = "PATH";
+    static constexpr char PATH_SEPARATOR = ':';
+    static constexpr char DIRECTORY_SEPARATOR = '/';
+    static constexpr char HIDDEN = '.';
+    static constexpr std::string_view COMMAND_SEPARATORS = "|&;(";
+    static constexpr std::uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+    static constexpr std::uint32_t GONE_MASK = IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED;
+    static constexpr std::size_t EVENT_BUF_SIZE = 16UL * 1024UL;
+    static constexpr std::size_t STEP_ENTRIES = 256;
+    static constexpr std::size_t MAX_CANDIDATES = 100;
+
+    /**
+     * path_directory: one directory on PATH
+     */
+    struct path_directory {
+        /**
+         * path: where the directory is
+         */
+        std::string path;
+
+        /**
+         * watch: the inotify watch on the directory, std::nullopt if it is not watched
+         */
+        std::optional<int> watch = std::nullopt;
+
+        /**
+         * names: the executables which were found in the directory and are in the trie
+         */
+        std::unordered_set<std::string> names;
+
+        /**
+         * scan: how far the background build got through the directory, std::nullopt once it has been read
+         */
+        std::optional<std::filesystem::directory_iterator> scan = std::nullopt;
+    };
+
+    /**
+     * trie: every executable on PATH
+     */
+    static executable_trie trie;
+
+    /**
+     * directories: the directories on PATH, each one only once
+     */
+    static std::vector<path_directory> directories;
+
+    /**
+     * inotify_fides: inotify instance watching every directory on PATH
+     */
+    static std::optional<file_descriptor_wrapper> inotify_fides;
+
+    /**
+     * events: the reactor inotify events are read from, nullptr if the trie is not kept
+     */
+    static reactor* events;
+
+    /**
+     * token: the token of the inotify instance in events
+     */
+    static std::optional<std::uint64_t> token;
+
+    /**
+     * is_executable: whether name in dir is an executable regular file
+     */
+    [[nodiscard]] static auto is_executable(std::string const& dir, std::string const& name) -> bool;
+
+    /**
+     * refresh: puts name in or takes it out of the trie depending on whether it is an executable in dir
+     */
+    static void refresh(path_directory& dir, std::string const& name, bool executable);
+
+    /**
+     * forget: takes every executable found in dir out of the trie
+     */
+    static void forget(path_directory& dir);
+
+    /**
+     * rescan: forgets dir and reads it again in the background
+     */
+    static void rescan(path_directory& dir);
+
+    /**
+     * read_events: applies every change inotify reports to the trie
+     */
+    static void read_events();
+
+    /**
+     * complete_command: completes word from the executables on PATH
+     */
+    [[nodiscard]] static auto complete_command(std::string_view word) -> completion_result;
+
+    /**
+     * complete_file: completes word from the files in the directory it names
+     */
+    [[nodiscard]] static auto complete_file(std::string_view word) -> completion_result;
+
+  public:
+    /**
+     * watch: starts keeping the executables on PATH, building the trie while events is idle and updating it on inotify events read through events, nullptr stops keeping them
+     */
+    static void watch(reactor* events);
+
+    /**
+     * invalidate_path: moves the trie to the directories on the new PATH, directories which stay on PATH are not read again
+     */
+    static void invalidate_path();
+
+    /**
+     * building: whether part of PATH has not been read into the trie yet
+     */
+    [[nodiscard]] static auto building() -> bool;
+
+    /**
+     * build_step: reads the next few entries of PATH into the trie
+     */
+    static void build_step();
+
+    /**
+     * finish: reads the rest of PATH into the trie
+     */
+    static void finish();
+
+    /**
+     * contains: whether name is an executable on PATH as far as the trie knows
+     */
+    [[nodiscard]] static auto contains(std::string_view name) -> bool;
+
+    /**
+     * complete: completes the word at the end of line, a command when it is the first word of a command and a file otherwise
+     */
+    [[nodiscard]] static auto complete(std::string_view line) -> completion_result;
+};
+} // namespace jsh
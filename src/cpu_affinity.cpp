@@ -0,0 +1,197 @@
+#include "cpu_affinity.hpp"
+
+namespace jsh {
+std::optional<std::vector<std::vector<int>>> cpu_affinity::nodes = std::nullopt;
+
+auto cpu_affinity::cpus_of(cpu_set_t const& set) -> std::vector<int> {
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) { // NOLINT CPU_ISSET is a glibc macro
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+auto cpu_affinity::parse_cpu_list(std::string_view list) -> std::optional<cpu_set_t> {
+    cpu_set_t set;
+    CPU_ZERO(&set); // NOLINT CPU_ZERO is a glibc macro
+
+    // sysfs ends its lists with a newline
+    while (!list.empty() && static_cast<bool>(std::isspace(list.back()))) {
+        list.remove_suffix(1);
+    }
+
+    // every comma separated item is either one CPU or an inclusive range of them
+    bool any = false;
+    while (!list.empty()) {
+        std::size_t const item_end = std::min(list.find(LIST_SEPARATOR), list.size());
+        std::string_view const item = list.substr(0, item_end);
+        list.remove_prefix(std::min(item_end + 1, list.size()));
+
+        int first = 0;
+        auto [ptr, err] = std::from_chars(item.data(), item.data() + item.size(), first);
+        if (err != std::errc{}) {
+            return std::nullopt;
+        }
+        int last = first;
+        if (ptr != item.data() + item.size()) {
+            if (*ptr != RANGE_SEPARATOR) {
+                return std::nullopt;
+            }
+            auto [range_ptr, range_err] = std::from_chars(ptr + 1, item.data() + item.size(), last);
+            if (range_err != std::errc{} || range_ptr != item.data() + item.size()) {
+                return std::nullopt;
+            }
+        }
+
+        if (first < 0 || last < first || last >= CPU_SETSIZE) {
+            return std::nullopt;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            CPU_SET(cpu, &set); // NOLINT CPU_SET is a glibc macro
+        }
+        any = true;
+    }
+
+    // an empty set would keep the child from running anywhere
+    if (!any) {
+        return std::nullopt;
+    }
+    return std::make_optional<cpu_set_t>(set);
+}
+
+auto cpu_affinity::parse_policy(std::string_view value) -> std::optional<affinity_policy> {
+    if (value.empty() || value == NONE_STR) {
+        return std::make_optional<affinity_policy>();
+    }
+    if (value == AUTO_STR) {
+        return std::make_optional<affinity_policy>(affinity_policy{.mode = AFFINITY_MODE::AUTO, .stage_sets = {}});
+    }
+
+    // one CPU list per stage, separated by colons
+    affinity_policy policy{.mode = AFFINITY_MODE::FIXED, .stage_sets = {}};
+    while (true) {
+        std::size_t const list_end = std::min(value.find(STAGE_SEPARATOR), value.size());
+        std::optional<cpu_set_t> const set = parse_cpu_list(value.substr(0, list_end));
+        if (!set.has_value()) {
+            return std::nullopt;
+        }
+        policy.stage_sets.push_back(set.value());
+
+        if (list_end == value.size()) {
+            break;
+        }
+        value.remove_prefix(list_end + 1);
+    }
+
+    return std::make_optional<affinity_policy>(std::move(policy));
+}
+
+auto cpu_affinity::policy() -> affinity_policy {
+    std::string_view const value = environment::get_var(AFFINITY_VAR);
+    std::optional<affinity_policy> parsed = parse_policy(value);
+    if (!parsed.has_value()) {
+        cout_logger.log(LOG_LEVEL::WARN, "Ignoring invalid ", AFFINITY_VAR, ": ", value);
+        return affinity_policy{};
+    }
+    return std::move(parsed.value());
+}
+
+auto cpu_affinity::topology() -> std::vector<std::vector<int>> const& {
+    if (nodes.has_value()) [[likely]] {
+        return nodes.value();
+    }
+    nodes.emplace();
+
+    // every nodeN directory lists the CPUs local to that node
+    std::error_code err;
+    for (auto const& entry : std::filesystem::directory_iterator(NODE_DIRECTORY, err)) {
+        std::string const name = entry.path().filename().string();
+        if (!name.starts_with(NODE_PREFIX) || name.size() == NODE_PREFIX.size() || !std::all_of(std::begin(name) + NODE_PREFIX.size(), std::end(name), [](char chr) { return static_cast<bool>(std::isdigit(chr)); })) {
+            continue;
+        }
+
+        std::optional<std::string> const list = syscall_wrapper::read_file_wrapper(entry.path() / NODE_CPUS_FILE);
+        std::optional<cpu_set_t> const set = list.has_value() ? parse_cpu_list(list.value()) : std::nullopt;
+        if (set.has_value()) {
+            nodes->push_back(cpus_of(set.value()));
+        }
+    }
+
+    // a kernel without NUMA support has a single node made of every online CPU
+    if (nodes->empty()) {
+        std::optional<std::string> const list = syscall_wrapper::read_file_wrapper(ONLINE_CPUS_FILE);
+        std::optional<cpu_set_t> const set = list.has_value() ? parse_cpu_list(list.value()) : std::nullopt;
+        if (set.has_value()) {
+            nodes->push_back(cpus_of(set.value()));
+        }
+    }
+
+    // order every node by core, the lowest sibling of each CPU identifies its core so hyperthreads end up next to each other
+    for (std::vector<int>& cpus : nodes.value()) {
+        std::vector<std::pair<int, int>> by_core;
+        by_core.reserve(cpus.size());
+        for (int const cpu : cpus) {
+            std::optional<std::string> const list = syscall_wrapper::read_file_wrapper(CPU_PREFIX + std::to_string(cpu) + SIBLINGS_FILE);
+            std::optional<cpu_set_t> const siblings = list.has_value() ? parse_cpu_list(list.value()) : std::nullopt;
+            by_core.emplace_back(siblings.has_value() ? cpus_of(siblings.value()).front() : cpu, cpu);
+        }
+        std::ranges::sort(by_core);
+        std::ranges::transform(by_core, std::begin(cpus), [](std::pair<int, int> const& core_cpu) { return core_cpu.second; });
+    }
+
+    return nodes.value();
+}
+
+auto cpu_affinity::place(affinity_policy const& policy, std::size_t stages) -> std::vector<std::optional<cpu_set_t>> {
+    std::vector<std::optional<cpu_set_t>> placement(stages, std::nullopt);
+
+    switch (policy.mode) {
+    case AFFINITY_MODE::FIXED: {
+        // the stages past the last list keep using it
+        assert(!policy.stage_sets.empty());
+        for (std::size_t i = 0; i < stages; ++i) {
+            placement[i] = policy.stage_sets[std::min(i, policy.stage_sets.size() - 1)];
+        }
+        break;
+    }
+    case AFFINITY_MODE::AUTO: {
+        std::vector<std::vector<int>> const& node_cpus = topology();
+        std::optional<cpu_set_t> const allowed = syscall_wrapper::sched_getaffinity_wrapper(0);
+        if (node_cpus.empty() || !allowed.has_value()) {
+            break;
+        }
+
+        // keep the pipeline on the node the shell is running on, its memory is most likely local to it
+        std::optional<int> const current = syscall_wrapper::sched_getcpu_wrapper();
+        auto node = std::ranges::find_if(node_cpus, [&](std::vector<int> const& cpus) { return current.has_value() && std::ranges::find(cpus, current.value()) != std::end(cpus); });
+        if (node == std::end(node_cpus)) {
+            node = std::begin(node_cpus);
+        }
+
+        // only the CPUs the shell itself may use can be handed out
+        std::vector<int> candidates;
+        std::ranges::copy_if(*node, std::back_inserter(candidates), [&](int cpu) { return CPU_ISSET(cpu, &allowed.value()); }); // NOLINT CPU_ISSET is a glibc macro
+        if (candidates.empty()) {
+            break;
+        }
+
+        // consecutive stages get consecutive CPUs in core order, so a producer and its consumer share a core's caches
+        for (std::size_t i = 0; i < stages; ++i) {
+            cpu_set_t set;
+            CPU_ZERO(&set);                                 // NOLINT CPU_ZERO is a glibc macro
+            CPU_SET(candidates[i % candidates.size()], &set); // NOLINT CPU_SET is a glibc macro
+            placement[i] = set;
+        }
+        break;
+    }
+    case AFFINITY_MODE::NONE:
+    case AFFINITY_MODE::COUNT: {
+        break;
+    }
+    }
+
+    return placement;
+}
+} // namespace jsh
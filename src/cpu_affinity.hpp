@@ -0,0 +1,110 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "environment.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * AFFINITY_MODE: how the stages of a pipeline are placed on CPUs
+ *
+ * NONE: the stages may run anywhere the shell may run
+ *
+ * FIXED: the stages are restricted to the CPU sets the user gave
+ *
+ * AUTO: every stage is pinned to one CPU of the shell's NUMA node, with adjacent stages on sibling CPUs
+ */
+enum class AFFINITY_MODE : char {
+    NONE = 0,
+    FIXED = 1,
+    AUTO = 2,
+    COUNT = 3
+};
+
+/**
+ * structure describing how the stages of a job should be placed
+ *
+ * mode: the placement mode
+ *
+ * stage_sets: the CPU sets for FIXED placement, stage i gets set i and the stages past the end reuse the last set
+ */
+struct affinity_policy {
+    AFFINITY_MODE mode = AFFINITY_MODE::NONE;
+    std::vector<cpu_set_t> stage_sets;
+};
+
+/**
+ * cpu_affinity: decides which CPUs each stage of a pipeline may run on
+ *
+ * NOTES: the CPU topology is read from sysfs the first time automatic placement is used, the masks are applied by the children with sched_setaffinity before they exec
+ */
+class cpu_affinity {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* NODE_DIRECTORY = "/sys/devices/system/node";
+    static constexpr char const* NODE_CPUS_FILE = "cpulist";
+    static constexpr char const* ONLINE_CPUS_FILE = "/sys/devices/system/cpu/online";
+    static constexpr char const* CPU_PREFIX = "/sys/devices/system/cpu/cpu";
+    static constexpr char const* SIBLINGS_FILE = "/topology/thread_siblings_list";
+    static constexpr std::string_view NODE_PREFIX = "node";
+    static constexpr std::string_view NONE_STR = "none";
+    static constexpr std::string_view AUTO_STR = "auto";
+    static constexpr char STAGE_SEPARATOR = ':';
+    static constexpr char LIST_SEPARATOR = ',';
+    static constexpr char RANGE_SEPARATOR = '-';
+
+    /**
+     * nodes: the CPUs of every NUMA node, ordered so that sibling CPUs of one core are next to each other, read once
+     */
+    static std::optional<std::vector<std::vector<int>>> nodes;
+
+    /**
+     * cpus_of: expands a CPU set into the list of CPUs in it
+     */
+    [[nodiscard]] static auto cpus_of(cpu_set_t const& set) -> std::vector<int>;
+
+    /**
+     * topology: reads the NUMA nodes and orders their CPUs by core
+     */
+    [[nodiscard]] static auto topology() -> std::vector<std::vector<int>> const&;
+
+  public:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* AFFINITY_VAR = "JSH_PIPELINE_AFFINITY";
+
+    /**
+     * parse_cpu_list: parses a kernel style CPU list such as 0-3,8
+     *
+     * returns std::nullopt if the list is empty or not understood
+     */
+    [[nodiscard]] static auto parse_cpu_list(std::string_view list) -> std::optional<cpu_set_t>;
+
+    /**
+     * parse_policy: parses none, auto, or CPU lists separated by : with one list per stage
+     *
+     * returns std::nullopt if the value is not understood
+     */
+    [[nodiscard]] static auto parse_policy(std::string_view value) -> std::optional<affinity_policy>;
+
+    /**
+     * policy: the policy selected through JSH_PIPELINE_AFFINITY, none if it is unset or invalid
+     */
+    [[nodiscard]] static auto policy() -> affinity_policy;
+
+    /**
+     * place: the CPU set of every stage of a pipeline, std::nullopt for a stage which is not placed
+     *
+     * policy: how the stages should be placed
+     *
+     * stages: the number of stages in the pipeline
+     */
+    [[nodiscard]] static auto place(affinity_policy const& policy, std::size_t stages) -> std::vector<std::optional<cpu_set_t>>;
+};
+} // namespace jsh
@@ -1,39 +1,340 @@
 #include "environment.hpp"
 
 namespace jsh {
-auto environment::get() -> char** {
-    return environ;
+bool environment::envp_stale = true;
+std::vector<char> environment::envp_strings;
+std::vector<char*> environment::envp_array;
+int environment::status = EXIT_SUCCESS;
+bool environment::status_stale = true;
+environment::int_string environment::status_string{};
+environment::int_string environment::shell_pid_string{};
+pid_t environment::background_pid = -1;
+bool environment::background_pid_stale = true;
+environment::int_string environment::background_pid_string{};
+std::vector<int> environment::pipestatus;
+bool environment::pipestatus_stale = true;
+std::string environment::pipestatus_string;
+std::vector<environment::int_string> environment::pipestatus_strings;
+
+auto variable_table::probe(std::string_view name, std::size_t hash) const -> std::size_t {
+    assert(!slots.empty());
+
+    // the slot count is a power of two, and the table is at most half full so there is always an empty slot to stop at
+    std::size_t const mask = slots.size() - 1;
+    for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        std::uint32_t const index = slots[slot];
+        if (index == EMPTY_SLOT || (entries[index].hash == hash && entries[index].name == name)) {
+            return slot;
+        }
+    }
+}
+
+void variable_table::rehash(std::size_t slot_count) {
+    assert(std::has_single_bit(slot_count));
+
+    slots.assign(slot_count, EMPTY_SLOT);
+    for (std::size_t index = 0; index < entries.size(); ++index) {
+        slots[probe(entries[index].name, entries[index].hash)] = static_cast<std::uint32_t>(index);
+    }
+}
+
+auto variable_table::find(std::string_view name) const -> variable const* {
+    if (slots.empty()) {
+        return nullptr;
+    }
+
+    std::uint32_t const index = slots[probe(name, std::hash<std::string_view>{}(name))];
+    return index == EMPTY_SLOT ? nullptr : &entries[index];
+}
+
+auto variable_table::set(std::string_view name, std::string_view value, std::optional<bool> exported) -> std::pair<variable const&, bool> {
+    // keep the table at most half full
+    if (2 * (entries.size() + 1) > slots.size()) {
+        rehash(std::max(MIN_SLOTS, 2 * slots.size()));
+    }
+
+    std::size_t const hash = std::hash<std::string_view>{}(name);
+    std::size_t const slot = probe(name, hash);
+
+    // a new variable
+    if (slots[slot] == EMPTY_SLOT) {
+        slots[slot] = static_cast<std::uint32_t>(entries.size());
+        variable const& var = entries.emplace_back(variable{.name = std::string{name}, .value = std::string{value}, .hash = hash, .exported = exported.value_or(false)});
+        return {var, var.exported};
+    }
+
+    // binaries only see a difference if the variable is or was exported
+    variable& var = entries[slots[slot]];
+    bool const was_exported = var.exported;
+    bool const changed = var.value != value;
+    if (changed) {
+        var.value = value;
+    }
+    var.exported = exported.value_or(var.exported);
+    return {var, (changed && (was_exported || var.exported)) || was_exported != var.exported};
+}
+
+void variable_table::reserve(std::size_t count) {
+    std::size_t const slot_count = std::bit_ceil(std::max(MIN_SLOTS, 2 * count));
+    if (slot_count > slots.size()) {
+        rehash(slot_count);
+    }
+}
+
+auto variable_table::size() const -> std::size_t {
+    return entries.size();
+}
+
+auto variable_table::variables() const -> std::deque<variable> const& {
+    return entries;
+}
+
+auto environment::table() -> variable_table& {
+    // the shell's environment is read in once, after that it is only written back out as envp
+    static variable_table variables = [] {
+        variable_table loaded;
+        std::size_t count = 0;
+        while (environ[count] != nullptr) { // NOLINT environ is null terminated
+            ++count;
+        }
+        loaded.reserve(count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            std::string_view const entry = environ[i]; // NOLINT environ is null terminated
+            std::size_t const equals = entry.find('=');
+            if (equals == std::string_view::npos || equals == 0) {
+                continue;
+            }
+            std::ignore = loaded.set(entry.substr(0, equals), entry.substr(equals + 1), true);
+        }
+        return loaded;
+    }();
+    return variables;
+}
+
+auto environment::format(int value, int_string& str) -> std::string_view {
+    auto [ptr, err] = std::to_chars(str.data(), str.data() + str.size() - 1, value);
+    assert(err == std::errc{}); // the buffer always fits an int
+    *ptr = '\0';
+    return {str.data(), ptr};
+}
+
+void environment::materialize_pipestatus() {
+    if (!pipestatus_stale) [[likely]] {
+        return;
+    }
+
+    // format every stage once no matter how many times PIPESTATUS is read
+    pipestatus_strings.resize(pipestatus.size());
+    pipestatus_string.clear();
+    for (std::size_t i = 0; i < pipestatus.size(); ++i) {
+        if (i != 0) {
+            pipestatus_string += ' ';
+        }
+        pipestatus_string += format(pipestatus[i], pipestatus_strings[i]);
+    }
+    pipestatus_stale = false;
+}
+
+auto environment::special(std::string_view name) -> std::optional<std::string_view> {
+    // ordinary names are told apart by their first character
+    if (name.empty() || (name.size() != 1 && name.front() != PIPESTATUS_NAME.front())) [[likely]] {
+        return std::nullopt;
+    }
+
+    // $? is only formatted when it is read
+    if (name == STATUS_STRING) {
+        if (status_stale) {
+            std::ignore = format(status, status_string);
+            status_stale = false;
+        }
+        return status_string.data();
+    }
+
+    // $$ never changes, so it was formatted once by the shell
+    if (name == SHELL_PID_STRING) {
+        return shell_pid_string.data();
+    }
+
+    // $! is empty until a background job has been started
+    if (name == BACKGROUND_PID_STRING) {
+        if (background_pid == -1) {
+            return EMPTY_STRING;
+        }
+        if (background_pid_stale) {
+            std::ignore = format(background_pid, background_pid_string);
+            background_pid_stale = false;
+        }
+        return background_pid_string.data();
+    }
+
+    if (!name.starts_with(PIPESTATUS_NAME)) {
+        return std::nullopt;
+    }
+    std::string_view subscript = name.substr(PIPESTATUS_NAME.size());
+
+    // PIPESTATUS is its first stage, PIPESTATUS[@] and PIPESTATUS[*] are every stage, PIPESTATUS[i] is stage i
+    std::size_t index = 0;
+    if (!subscript.empty()) {
+        if (subscript.size() < 3 || subscript.front() != '[' || subscript.back() != ']') {
+            return std::nullopt;
+        }
+        subscript = subscript.substr(1, subscript.size() - 2);
+
+        if (subscript == "@" || subscript == "*") {
+            materialize_pipestatus();
+            return pipestatus_string.c_str();
+        }
+
+        auto [ptr, err] = std::from_chars(subscript.data(), subscript.data() + subscript.size(), index);
+        if (err != std::errc{} || ptr != subscript.data() + subscript.size()) {
+            return std::nullopt;
+        }
+    }
+
+    if (index >= pipestatus.size()) {
+        return EMPTY_STRING;
+    }
+    materialize_pipestatus();
+    return pipestatus_strings[index].data();
+}
+
+void environment::set_status(int exit_status) {
+    status = exit_status;
+    status_stale = true;
+}
+
+auto environment::get_status() -> int {
+    return status;
+}
+
+void environment::record_shell_pid() {
+    std::ignore = format(syscall_wrapper::getpid_wrapper().value_or(-1), shell_pid_string);
+}
+
+void environment::set_background_pid(pid_t pid) {
+    background_pid = pid;
+    background_pid_stale = true;
+}
+
+auto environment::get_background_pid() -> pid_t {
+    return background_pid;
+}
+
+void environment::set_pipestatus(std::span<int const> statuses) {
+    // the vector keeps its capacity, so recording a pipeline no longer than the longest one so far does not allocate
+    pipestatus.assign(std::begin(statuses), std::end(statuses));
+    pipestatus_stale = true;
+}
+
+auto environment::get_pipestatus() -> std::span<int const> {
+    return pipestatus;
 }
 
 void environment::set_var(char const* var, char const* val) {
     // ensure that there is not an equals in the variable name
     assert(std::strstr(var, "=") == nullptr);
 
+    // $? is backed by the integer status, so it has to be parsed back in
+    if (std::strcmp(var, STATUS_STRING) == 0) [[unlikely]] {
+        int exit_status = EXIT_FAILURE;
+        std::from_chars(val, val + std::strlen(val), exit_status);
+        set_status(exit_status);
+        return;
+    }
+
     // set the environment variable to the appropriate value, overriding if necessary
-    setenv(var, val, 1); // NOLINT
+    envp_stale = table().set(var, val, true).second || envp_stale;
+}
+
+void environment::set_local(char const* var, char const* val) {
+    // ensure that there is not an equals in the variable name
+    assert(std::strstr(var, "=") == nullptr);
+
+    // $? is backed by the integer status, so it has to be parsed back in
+    if (std::strcmp(var, STATUS_STRING) == 0) [[unlikely]] {
+        set_var(var, val);
+        return;
+    }
+
+    // only a variable which is already exported makes envp stale
+    envp_stale = table().set(var, val, std::nullopt).second || envp_stale;
 }
 
 auto environment::get_var(char const* var) -> char const* {
     // ensure that there is not an equals in the variable name
     assert(std::strstr(var, "=") == nullptr);
 
-    // get the environment variable from environ
-    char const* val = getenv(var); // NOLINT
+    // every value lookup returns is null terminated
+    return lookup(var).data();
+}
+
+auto environment::lookup(std::string_view name) -> std::string_view {
+    // the special parameters are formatted from the integers the shell keeps
+    if (std::optional<std::string_view> const value = special(name); value.has_value()) [[unlikely]] {
+        return value.value();
+    }
+
+    // look the variable up in the shell's table
+    variable const* const found = table().find(name);
 
     // check for failure
-    if (val != nullptr) [[likely]] {
-        return val;
+    if (found != nullptr) [[likely]] {
+        return found->value;
     }
 
     return EMPTY_STRING;
 }
 
+auto environment::is_exported(char const* var) -> bool {
+    variable const* const found = table().find(var);
+    return found != nullptr && found->exported;
+}
+
+auto environment::envp() -> char** {
+    if (!envp_stale && !envp_array.empty()) [[likely]] {
+        return envp_array.data();
+    }
+
+    // size the strings first so they are written into one allocation
+    std::size_t size = 0;
+    std::size_t count = 0;
+    for (variable const& var : table().variables()) {
+        if (var.exported) {
+            size += var.name.size() + var.value.size() + 2;
+            ++count;
+        }
+    }
+
+    envp_strings.resize(size);
+    envp_array.resize(count + 1);
+    char* out = envp_strings.data();
+    std::size_t idx = 0;
+    for (variable const& var : table().variables()) {
+        if (!var.exported) {
+            continue;
+        }
+
+        // the strings are sized up front, so the pointers into them stay valid
+        envp_array[idx++] = out;
+        out = std::ranges::copy(var.name, out).out;
+        *out++ = '=';                                 // NOLINT the strings are sized for the name, value, = and null
+        out = std::ranges::copy(var.value, out).out;
+        *out++ = '\0';                                // NOLINT the strings are sized for the name, value, = and null
+    }
+    envp_array[idx] = nullptr;
+
+    // environ is left alone, a rebuild frees the old array, so it is only ever handed straight to posix_spawn and execve
+    envp_stale = false;
+    return envp_array.data();
+}
+
 void environment::print([[maybe_unused]] logger& log) {
     // iterate until nullptr
-    for (std::size_t i = 0; get()[i]; ++i) [[likely]] { // NOLINT
+    char** const env = envp();
+    for (std::size_t i = 0; env[i]; ++i) [[likely]] { // NOLINT
         // print the env variable of the form var=value
-        log.log(LOG_LEVEL::SILENT, get()[i], '\n'); // NOLINT
+        log.log(LOG_LEVEL::SILENT, env[i], '\n'); // NOLINT
     }
 }
-
 } // namespace jsh
@@ -3,10 +3,89 @@
 // JSH
 #include "macros.hpp"
 #include "pch.hpp"
+#include "posix_wrappers.hpp"
 
 namespace jsh {
+/**
+ * variable: one shell variable
+ *
+ * exported: whether the variable is handed to the binaries the shell runs, a local variable is only seen by the shell
+ */
+struct variable {
+    std::string name;
+    std::string value;
+    std::size_t hash;
+    bool exported;
+};
+
+/**
+ * variable_table: an open addressing hash table of variables
+ *
+ * NOTES: the variables live in a deque so growing the table never moves them, slots hold their indices and are probed linearly
+ */
+class variable_table {
+  private:
+    /**
+     * CONSTANTS
+     */
+    static constexpr std::uint32_t EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t MIN_SLOTS = 64;
+
+    /**
+     * entries: every variable in the order it was first set
+     */
+    std::deque<variable> entries;
+
+    /**
+     * slots: the index into entries of the variable hashed to each slot, EMPTY_SLOT if there is none, kept at most half full
+     */
+    std::vector<std::uint32_t> slots;
+
+    /**
+     * probe: the slot holding name, or the empty slot where it would go
+     */
+    [[nodiscard]] auto probe(std::string_view name, std::size_t hash) const -> std::size_t;
+
+    /**
+     * rehash: moves every variable into a table of slot_count slots
+     */
+    void rehash(std::size_t slot_count);
+
+  public:
+    /**
+     * find: the variable called name, nullptr if it is not set
+     */
+    [[nodiscard]] auto find(std::string_view name) const -> variable const*;
+
+    /**
+     * set: sets name to value, exported decides whether it is handed to binaries, std::nullopt keeps the flag the variable already has (new variables are local)
+     *
+     * returns the variable along with whether the binaries the shell runs would see a difference
+     */
+    auto set(std::string_view name, std::string_view value, std::optional<bool> exported) -> std::pair<variable const&, bool>;
+
+    /**
+     * reserve: makes room for count variables without rehashing
+     */
+    void reserve(std::size_t count);
+
+    /**
+     * size: the number of variables
+     */
+    [[nodiscard]] auto size() const -> std::size_t;
+
+    /**
+     * variables: every variable in the order it was first set
+     */
+    [[nodiscard]] auto variables() const -> std::deque<variable> const&;
+};
+
 /**
  * The goal of the environment class is to facilitate the shell's interaction with environment variables
+ *
+ * NOTES: the shell keeps its variables in a variable_table which is filled from environ the first time it is used, the environment binaries are run with is only rebuilt once an exported variable has changed
+ *
+ * the special parameters ($?, $$, $!, PIPESTATUS) are kept as integers and never enter the table or the environment
  */
 class environment {
   private:
@@ -16,20 +95,114 @@ class environment {
     static constexpr char const* EMPTY_STRING = "";
 
     /**
-     * get: gets the array of environment strings representing the current process' environment
+     * table: the shell's variables, read in from environ the first time they are needed
+     */
+    [[nodiscard]] static auto table() -> variable_table&;
+
+    /**
+     * envp_stale: indicates whether an exported variable has changed since envp was last built
      */
-    [[nodiscard]] static auto get() -> char**;
+    static bool envp_stale;
+
+    /**
+     * envp_strings: every exported variable as NAME=VALUE, back to back and null terminated
+     */
+    static std::vector<char> envp_strings;
+
+    /**
+     * envp_array: the null terminated array of pointers into envp_strings which binaries are run with
+     */
+    static std::vector<char*> envp_array;
+
+    static constexpr std::size_t INT_CHARS = std::numeric_limits<int>::digits10 + 3; // every digit, the sign and the null
+    static constexpr std::string_view PIPESTATUS_NAME = "PIPESTATUS";
+
+    using int_string = std::array<char, INT_CHARS>;
+
+    /**
+     * status: the exit status of the most recent job, kept as an integer so control flow never has to parse it
+     */
+    static int status;
+
+    /**
+     * status_stale: indicates whether status has changed since $? was last formatted
+     */
+    static bool status_stale;
+
+    /**
+     * status_string: $? formatted, only once someone reads it
+     */
+    static int_string status_string;
+
+    /**
+     * shell_pid_string: $$ formatted once by the shell before it forks anything, so a subshell keeps the pid of the shell it was forked from
+     */
+    static int_string shell_pid_string;
+
+    /**
+     * background_pid: the pid of the most recent background job, -1 if none has been started
+     */
+    static pid_t background_pid;
+
+    /**
+     * background_pid_stale: indicates whether background_pid has changed since $! was last formatted
+     */
+    static bool background_pid_stale;
+
+    /**
+     * background_pid_string: $! formatted, only once someone reads it
+     */
+    static int_string background_pid_string;
+
+    /**
+     * pipestatus: the exit status of each stage of the most recent foreground pipeline
+     */
+    static std::vector<int> pipestatus;
+
+    /**
+     * pipestatus_stale: indicates whether pipestatus has changed since PIPESTATUS was last formatted
+     */
+    static bool pipestatus_stale;
+
+    /**
+     * pipestatus_string: ${PIPESTATUS[@]}, every status separated by a space
+     *
+     * pipestatus_strings: ${PIPESTATUS[i]}, one null terminated status per stage
+     *
+     * NOTES: both keep their capacity, so formatting them again does not allocate once they have grown to the longest pipeline
+     */
+    static std::string pipestatus_string;
+    static std::vector<int_string> pipestatus_strings;
+
+    /**
+     * format: writes value into str as a null terminated string, returning the characters written
+     */
+    static auto format(int value, int_string& str) -> std::string_view;
+
+    /**
+     * materialize_pipestatus: formats pipestatus into PIPESTATUS if it has changed since the last time someone read it
+     */
+    static void materialize_pipestatus();
+
+    /**
+     * special: the value of the special parameter name ($?, $$, $!, PIPESTATUS), std::nullopt if name is not one
+     *
+     * NOTES: the values are formatted from the integers the shell keeps on demand, and are always null terminated
+     */
+    [[nodiscard]] static auto special(std::string_view name) -> std::optional<std::string_view>;
 
   public:
     /**
      * CONSTANT VARIABLES
      */
     static constexpr char const* STATUS_STRING = "?";
+    static constexpr char const* SHELL_PID_STRING = "$";
+    static constexpr char const* BACKGROUND_PID_STRING = "!";
     static constexpr char const* SUCCESS_STRING = "0";
 
     /**
      *
-     * set_var: sets the environment variable var to value
+     * set_var: sets the environment variable var to value and exports it
      *
      * var: the name of the environment variable being altered in c-string format
      *
@@ -37,13 +210,82 @@ class environment {
      */
     static void set_var(char const* var, char const* val);
 
+    /**
+     * set_local: sets the variable var to value, which stays exported if it already was and is local to the shell otherwise
+     *
+     * var: the name of the variable being altered in c-string format
+     *
+     * val: the value to which the variable should be set
+     */
+    static void set_local(char const* var, char const* val);
+
     /**
      * get_var: gets the value of the environment variable var
      *
      * var: the name of the environment variable
+     *
+     * NOTES: the value stays valid until var is set again
      */
     [[nodiscard]] static auto get_var(char const* var) -> char const*;
 
+    /**
+     * lookup: get_var without copying name into a c-string, for substitution
+     *
+     * name: the name of the variable, or of a special parameter
+     *
+     * NOTES: the value stays valid until name is set again, and is null terminated
+     */
+    [[nodiscard]] static auto lookup(std::string_view name) -> std::string_view;
+
+    /**
+     * is_exported: whether var is set and handed to the binaries the shell runs
+     */
+    [[nodiscard]] static auto is_exported(char const* var) -> bool;
+
+    /**
+     * envp: the exported variables as the null terminated NAME=VALUE array execve takes, only rebuilt if an exported variable changed since the last call
+     *
+     * NOTES: the array is only valid until the next rebuild, it is never installed as environ so getenv keeps reading the environment the shell started with
+     */
+    [[nodiscard]] static auto envp() -> char**;
+
+    /**
+     * set_status: records the exit status of the most recent job, $? is only updated once it is read
+     *
+     * exit_status: the exit status of the job
+     */
+    static void set_status(int exit_status);
+
+    /**
+     * get_status: gets the exit status of the most recent job without going through the environment
+     */
+    [[nodiscard]] static auto get_status() -> int;
+
+    /**
+     * record_shell_pid: formats $$ from the calling process, called by the shell before it forks anything
+     */
+    static void record_shell_pid();
+
+    /**
+     * set_background_pid: records the pid of the most recent background job, $! is only updated once it is read
+     */
+    static void set_background_pid(pid_t pid);
+
+    /**
+     * get_background_pid: gets the pid of the most recent background job, -1 if none has been started
+     */
+    [[nodiscard]] static auto get_background_pid() -> pid_t;
+
+    /**
+     * set_pipestatus: records the exit status of each stage of the most recent foreground pipeline, PIPESTATUS is only updated once it is read
+     */
+    static void set_pipestatus(std::span<int const> statuses);
+
+    /**
+     * get_pipestatus: gets the exit status of each stage of the most recent foreground pipeline
+     */
+    [[nodiscard]] static auto get_pipestatus() -> std::span<int const>;
+
     /**
      * print: prints the current processes environment
      */
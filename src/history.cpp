@@ -0,0 +1,270 @@
+#include "history.hpp"
+
+namespace jsh {
+std::string history::path{};
+std::optional<file_descriptor_wrapper> history::file = std::nullopt;
+void* history::mapped = nullptr;
+std::size_t history::mapped_size = 0;
+std::size_t history::max_entries = history::DEFAULT_SIZE;
+
+auto history::open(std::string file_path, std::size_t max_entries) -> bool {
+    close();
+    path = std::move(file_path);
+    history::max_entries = std::max<std::size_t>(max_entries, 1);
+    if (!reopen() || !refresh()) {
+        close();
+        return false;
+    }
+
+    // only the newest records are scanned, so opening costs the same no matter how large the file has grown
+    std::string_view const complete = records();
+    if (tail_offset(complete, history::max_entries) > complete.size() / 2) {
+        compact_in_background();
+    }
+    return true;
+}
+
+auto history::open_default() -> bool {
+    std::string file_path = environment::get_var(FILE_VAR);
+    if (file_path.empty()) {
+        std::string const home = environment::get_var(HOME_VAR);
+        if (home.empty()) {
+            return false;
+        }
+        file_path = home + "/" + DEFAULT_FILE;
+    }
+
+    // an unset or invalid size keeps the default
+    std::size_t size = DEFAULT_SIZE;
+    std::string_view const size_str = environment::get_var(SIZE_VAR);
+    std::ignore = std::from_chars(size_str.data(), size_str.data() + size_str.size(), size);
+
+    return open(std::move(file_path), size);
+}
+
+void history::close() {
+    unmap();
+    file.reset();
+}
+
+auto history::is_open() -> bool {
+    return file.has_value();
+}
+
+auto history::size_limit() -> std::size_t {
+    return max_entries;
+}
+
+auto history::replaced() -> bool {
+    assert(file.has_value());
+
+    std::optional<struct stat> const on_disk = syscall_wrapper::stat_wrapper(path);
+    std::optional<struct stat> const current = syscall_wrapper::fstat_wrapper(file.value()); // NOLINT assert catches this
+    return !on_disk.has_value() || !current.has_value() || on_disk->st_ino != current->st_ino || on_disk->st_dev != current->st_dev;
+}
+
+auto history::reopen() -> bool {
+    unmap();
+    file = syscall_wrapper::open_wrapper(path, OPEN_FLAGS, PERMS);
+    return file.has_value();
+}
+
+auto history::refresh() -> bool {
+    if (!file.has_value()) {
+        return false;
+    }
+
+    // another session compacted the file, the records now live in its replacement
+    if (replaced() && !reopen()) {
+        return false;
+    }
+
+    std::optional<struct stat> const info = syscall_wrapper::fstat_wrapper(file.value()); // NOLINT checked above
+    if (!info.has_value()) {
+        return false;
+    }
+
+    // the mapping only has to grow when another session appended since the last look
+    auto const size = static_cast<std::size_t>(info->st_size);
+    if (mapped != nullptr && size == mapped_size) {
+        return true;
+    }
+    unmap();
+    if (size == 0) {
+        return true;
+    }
+
+    std::optional<void*> const addr = syscall_wrapper::mmap_read_wrapper(file.value(), size); // NOLINT checked above
+    if (!addr.has_value()) {
+        return false;
+    }
+    mapped = addr.value();
+    mapped_size = size;
+    return true;
+}
+
+void history::unmap() {
+    if (mapped != nullptr) {
+        std::ignore = syscall_wrapper::munmap_wrapper(mapped, mapped_size);
+    }
+    mapped = nullptr;
+    mapped_size = 0;
+}
+
+auto history::records() -> std::string_view {
+    if (mapped == nullptr) {
+        return {};
+    }
+
+    std::string_view const contents(static_cast<char const*>(mapped), mapped_size);
+    return contents.substr(0, contents.rfind(RECORD_END) + 1);
+}
+
+auto history::tail_offset(std::string_view records, std::size_t count) -> std::size_t {
+    // every record ends in a newline, so the one before it ends the previous record
+    std::size_t offset = records.size();
+    for (std::size_t i = 0; i < count && offset > 0; ++i) {
+        std::size_t const previous = offset < 2 ? std::string_view::npos : records.rfind(RECORD_END, offset - 2);
+        offset = previous == std::string_view::npos ? 0 : previous + 1;
+    }
+    return offset;
+}
+
+auto history::record(history_entry const& entry) -> bool {
+    if (!file.has_value()) {
+        return false;
+    }
+
+    std::string const line = format(entry);
+
+    // appends share the lock and compaction takes it exclusively, whoever waited on a file compaction replaced follows it to the new one
+    while (true) {
+        if (!syscall_wrapper::flock_wrapper(file.value(), LOCK_SH)) { // NOLINT checked above
+            return false;
+        }
+        if (!replaced()) {
+            break;
+        }
+        std::ignore = syscall_wrapper::flock_wrapper(file.value(), LOCK_UN); // NOLINT checked above
+        if (!reopen()) {
+            return false;
+        }
+    }
+
+    // O_APPEND puts the whole record at the end of the file in one write, so records from concurrent sessions never interleave
+    std::optional<ssize_t> const num_written = syscall_wrapper::write_wrapper(file.value(), line.data(), line.size()); // NOLINT checked above
+    std::ignore = syscall_wrapper::flock_wrapper(file.value(), LOCK_UN);                                              // NOLINT checked above
+    return num_written.has_value() && static_cast<std::size_t>(num_written.value()) == line.size();
+}
+
+auto history::recent(std::size_t count) -> std::vector<history_entry> {
+    std::vector<history_entry> entries;
+    if (!refresh()) {
+        return entries;
+    }
+
+    std::string_view tail = records();
+    tail.remove_prefix(tail_offset(tail, count));
+
+    // malformed lines are skipped rather than ending the history
+    entries.reserve(std::min(count, static_cast<std::size_t>(std::ranges::count(tail, RECORD_END))));
+    while (!tail.empty()) {
+        std::size_t const end = tail.find(RECORD_END);
+        if (std::optional<history_entry> entry = parse(tail.substr(0, end)); entry.has_value()) {
+            entries.push_back(std::move(entry.value()));
+        }
+        tail.remove_prefix(end + 1);
+    }
+    return entries;
+}
+
+auto history::compact() -> bool {
+    // the lock is taken through a descriptor of its own, so it never mixes with the shared locks taken to append
+    std::optional<file_descriptor_wrapper> const target = syscall_wrapper::open_wrapper(path, O_RDONLY | O_CLOEXEC, 0);
+    if (!target.has_value() || !syscall_wrapper::flock_wrapper(target.value(), LOCK_EX)) {
+        return false;
+    }
+
+    // another session may have compacted the file while we waited for the lock
+    std::optional<struct stat> const on_disk = syscall_wrapper::stat_wrapper(path);
+    std::optional<struct stat> const current = syscall_wrapper::fstat_wrapper(target.value());
+    if (!on_disk.has_value() || !current.has_value() || on_disk->st_ino != current->st_ino || current->st_size == 0) {
+        return true;
+    }
+
+    auto const size = static_cast<std::size_t>(current->st_size);
+    std::optional<void*> const addr = syscall_wrapper::mmap_read_wrapper(target.value(), size);
+    if (!addr.has_value()) {
+        return false;
+    }
+
+    // nobody appends while the lock is held, so every record is complete
+    std::string_view contents(static_cast<char const*>(addr.value()), size);
+    contents = contents.substr(0, contents.rfind(RECORD_END) + 1);
+    contents.remove_prefix(tail_offset(contents, max_entries));
+
+    // the newest records go to a new file which atomically takes the old one's place, a crash part way through leaves the old file untouched
+    bool status = true;
+    if (contents.size() != size) {
+        std::optional<pid_t> const pid = syscall_wrapper::getpid_wrapper();
+        std::string const temp = path + TEMP_SUFFIX + std::to_string(pid.value_or(0));
+        std::optional<file_descriptor_wrapper> const out = syscall_wrapper::open_wrapper(temp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, PERMS);
+        status = out.has_value();
+        while (status && !contents.empty()) {
+            std::optional<ssize_t> const num_written = syscall_wrapper::write_wrapper(out.value(), contents.data(), contents.size()); // NOLINT checked above
+            status = num_written.has_value();
+            contents.remove_prefix(static_cast<std::size_t>(num_written.value_or(0)));
+        }
+        status = status && syscall_wrapper::rename_wrapper(temp, path);
+    }
+
+    std::ignore = syscall_wrapper::munmap_wrapper(addr.value(), size);
+    return status;
+}
+
+void history::compact_in_background() {
+    std::optional<pid_t> const pid = syscall_wrapper::fork_wrapper();
+    if (!pid.has_value() || pid.value() != 0) {
+        return;
+    }
+
+    // the child is a copy of the shell and must never return into the shell loop
+    _exit(compact() ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+auto history::format(history_entry const& entry) -> std::string {
+    std::string line = std::to_string(entry.timestamp);
+    line += FIELD_SEPARATOR;
+    line += std::to_string(entry.duration_ms);
+    line += FIELD_SEPARATOR;
+    line += std::to_string(entry.status);
+    line += FIELD_SEPARATOR;
+
+    // a newline would split the record in two
+    std::size_t const start = line.size();
+    line += entry.command;
+    std::replace(std::begin(line) + static_cast<std::ptrdiff_t>(start), std::end(line), RECORD_END, ' ');
+    line += RECORD_END;
+    return line;
+}
+
+auto history::parse(std::string_view line) -> std::optional<history_entry> {
+    history_entry entry{};
+
+    // the command is the last field so it may contain tabs itself
+    auto const field = [&line](auto& val) -> bool {
+        auto [ptr, err] = std::from_chars(line.data(), line.data() + line.size(), val);
+        if (err != std::errc{} || ptr == line.data() + line.size() || *ptr != FIELD_SEPARATOR) {
+            return false;
+        }
+        line.remove_prefix(static_cast<std::size_t>(ptr - line.data()) + 1);
+        return true;
+    };
+    if (!field(entry.timestamp) || !field(entry.duration_ms) || !field(entry.status)) {
+        return std::nullopt;
+    }
+
+    entry.command = line;
+    return std::make_optional<history_entry>(std::move(entry));
+}
+} // namespace jsh
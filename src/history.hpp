@@ -0,0 +1,176 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "environment.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * history_entry: one command run at the prompt
+ */
+struct history_entry {
+    /**
+     * timestamp: when the command was started, in seconds since the epoch
+     */
+    std::int64_t timestamp;
+
+    /**
+     * duration_ms: how long the command ran for in milliseconds
+     */
+    std::int64_t duration_ms;
+
+    /**
+     * status: the exit status of the command
+     */
+    int status;
+
+    /**
+     * command: the line as it was typed, before variables were substituted
+     */
+    std::string command;
+};
+
+/**
+ * history: the commands run at the prompt, kept in an append only file shared by every session
+ *
+ * NOTES: each record is one line (timestamp, duration, status, and command separated by tabs) appended in a single O_APPEND write, the file is memory mapped for reading so only the records which are looked at are ever read in, compaction copies the newest records to a new file and renames it over the old one while holding the file exclusively
+ */
+class history {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* HOME_VAR = "HOME";
+    static constexpr char const* DEFAULT_FILE = ".jsh_history";
+    static constexpr char const* TEMP_SUFFIX = ".compact.";
+    static constexpr char FIELD_SEPARATOR = '\t';
+    static constexpr char RECORD_END = '\n';
+    static constexpr int OPEN_FLAGS = O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC;
+    static constexpr mode_t PERMS = 0600;
+
+    /**
+     * path: where the history file lives
+     */
+    static std::string path;
+
+    /**
+     * file: the history file, opened for appending
+     */
+    static std::optional<file_descriptor_wrapper> file;
+
+    /**
+     * mapped: the history file mapped read only, nullptr while nothing is mapped
+     */
+    static void* mapped;
+    static std::size_t mapped_size;
+
+    /**
+     * max_entries: the number of records compaction keeps
+     */
+    static std::size_t max_entries;
+
+    /**
+     * replaced: whether the file at path is no longer the one we have open, which happens once another session compacts it
+     */
+    [[nodiscard]] static auto replaced() -> bool;
+
+    /**
+     * reopen: opens the file at path again, creating it if it was removed
+     */
+    [[nodiscard]] static auto reopen() -> bool;
+
+    /**
+     * refresh: follows the file to its replacement and maps whatever other sessions appended since the last look
+     */
+    [[nodiscard]] static auto refresh() -> bool;
+
+    /**
+     * unmap: drops the mapping of the file
+     */
+    static void unmap();
+
+    /**
+     * records: the complete records in the mapping, a record still being appended has no newline yet and is left out
+     */
+    [[nodiscard]] static auto records() -> std::string_view;
+
+    /**
+     * tail_offset: the offset the last count records of records start at, found by scanning backwards so only those records are touched
+     */
+    [[nodiscard]] static auto tail_offset(std::string_view records, std::size_t count) -> std::size_t;
+
+  public:
+    /**
+     * CONSTANTS
+     */
+    static constexpr char const* FILE_VAR = "JSH_HISTORY";
+    static constexpr char const* SIZE_VAR = "JSH_HISTSIZE";
+    static constexpr std::size_t DEFAULT_SIZE = 10000;
+
+    /**
+     * open: opens (creating if needed) the history file at file_path, if it holds more than twice max_entries records a child compacts it in the background
+     *
+     * returns false if the file could not be opened
+     */
+    [[nodiscard]] static auto open(std::string file_path, std::size_t max_entries) -> bool;
+
+    /**
+     * open_default: opens $JSH_HISTORY, or ~/.jsh_history without it, keeping $JSH_HISTSIZE records
+     */
+    [[nodiscard]] static auto open_default() -> bool;
+
+    /**
+     * close: closes the history file
+     */
+    static void close();
+
+    /**
+     * is_open: whether a history file is open
+     */
+    [[nodiscard]] static auto is_open() -> bool;
+
+    /**
+     * size_limit: the number of records compaction keeps
+     */
+    [[nodiscard]] static auto size_limit() -> std::size_t;
+
+    /**
+     * record: appends entry to the history file
+     *
+     * returns false if it could not be written
+     */
+    [[nodiscard]] static auto record(history_entry const& entry) -> bool;
+
+    /**
+     * recent: the last count entries from every session, oldest first
+     */
+    [[nodiscard]] static auto recent(std::size_t count) -> std::vector<history_entry>;
+
+    /**
+     * compact: drops all but the newest max_entries records
+     *
+     * returns false if the file could not be compacted
+     */
+    [[nodiscard]] static auto compact() -> bool;
+
+    /**
+     * compact_in_background: compacts the file in a child so the shell is not held up, the child is reaped along with finished jobs
+     */
+    static void compact_in_background();
+
+    /**
+     * format: the line entry is stored as, newlines in the command become spaces
+     */
+    [[nodiscard]] static auto format(history_entry const& entry) -> std::string;
+
+    /**
+     * parse: the entry stored in line (without its newline)
+     *
+     * returns std::nullopt if line is not a record
+     */
+    [[nodiscard]] static auto parse(std::string_view line) -> std::optional<history_entry>;
+};
+} // namespace jsh
@@ -0,0 +1,175 @@
+#include "io_ring.hpp"
+
+namespace jsh {
+std::unique_ptr<io_ring> io_ring::shared = nullptr;
+bool io_ring::unsupported = false;
+
+io_ring::io_ring(file_descriptor_wrapper ring_fd, pid_t owner, io_uring_params const& params) : ring_fd{std::move(ring_fd)}, owner{owner}, params{params} {}
+
+io_ring::~io_ring() {
+    // a child only unmaps its own copy, the parent's ring is untouched
+    if (sqes != nullptr) {
+        std::ignore = syscall_wrapper::munmap_wrapper(sqes, sqes_size);
+    }
+    if (cq_ring != nullptr) {
+        std::ignore = syscall_wrapper::munmap_wrapper(cq_ring, cq_ring_size);
+    }
+    if (sq_ring != nullptr) {
+        std::ignore = syscall_wrapper::munmap_wrapper(sq_ring, sq_ring_size);
+    }
+}
+
+auto io_ring::get() -> io_ring* {
+    if (unsupported) {
+        return nullptr;
+    }
+
+    // a ring inherited through fork belongs to the parent
+    std::optional<pid_t> const pid = syscall_wrapper::getpid_wrapper();
+    if (!pid.has_value()) {
+        return nullptr;
+    }
+    if (shared != nullptr && shared->owner == pid.value()) [[likely]] {
+        return shared.get();
+    }
+    shared = nullptr;
+
+    // the kernel may be too old or have io_uring disabled, either way it is not asked again
+    io_uring_params params{};
+    std::optional<file_descriptor_wrapper> ring_fd = syscall_wrapper::io_uring_setup_wrapper(ENTRIES, params);
+    if (!ring_fd.has_value()) {
+        unsupported = true;
+        return nullptr;
+    }
+
+    std::unique_ptr<io_ring> ring(new io_ring(std::move(ring_fd.value()), pid.value(), params));
+    if (!ring->map()) {
+        unsupported = true;
+        return nullptr;
+    }
+
+    shared = std::move(ring);
+    return shared.get();
+}
+
+auto io_ring::map() -> bool {
+    sq_ring_size = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+    cq_ring_size = params.cq_off.cqes + (params.cq_entries * sizeof(io_uring_cqe));
+
+    // newer kernels map both rings with a single mapping
+    bool const single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+
+    std::optional<void*> const sq_addr = syscall_wrapper::mmap_file_wrapper(ring_fd, sq_ring_size, IORING_OFF_SQ_RING);
+    if (!sq_addr.has_value()) {
+        return false;
+    }
+    sq_ring = sq_addr.value();
+
+    if (!single_mmap) {
+        std::optional<void*> const cq_addr = syscall_wrapper::mmap_file_wrapper(ring_fd, cq_ring_size, IORING_OFF_CQ_RING);
+        if (!cq_addr.has_value()) {
+            return false;
+        }
+        cq_ring = cq_addr.value();
+    }
+
+    sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    std::optional<void*> const sqes_addr = syscall_wrapper::mmap_file_wrapper(ring_fd, sqes_size, IORING_OFF_SQES);
+    if (!sqes_addr.has_value()) {
+        return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqes_addr.value());
+    return true;
+}
+
+auto io_ring::ring_field(void* ring, std::uint32_t offset) -> unsigned* {
+    return reinterpret_cast<unsigned*>(static_cast<char*>(ring) + offset); // NOLINT the kernel lays the ring out by offset
+}
+
+auto io_ring::submit(std::vector<open_request> const& requests, std::size_t first, unsigned count, std::vector<std::optional<int>>& results) -> bool {
+    assert(count <= ENTRIES && count <= params.sq_entries);
+    void* const completions = cq_ring != nullptr ? cq_ring : sq_ring;
+
+    // only this process produces submissions, so the tail can be read without synchronizing
+    unsigned const sq_mask = *ring_field(sq_ring, params.sq_off.ring_mask);
+    unsigned* const sq_array = ring_field(sq_ring, params.sq_off.array);
+    std::atomic_ref<unsigned> sq_tail(*ring_field(sq_ring, params.sq_off.tail));
+    unsigned tail = sq_tail.load(std::memory_order_relaxed);
+
+    for (unsigned i = 0; i < count; ++i) {
+        open_request const& request = requests[first + i];
+        unsigned const slot = tail & sq_mask;
+
+        io_uring_sqe& sqe = sqes[slot]; // NOLINT the ring is an array mapped by the kernel
+        sqe = io_uring_sqe{};
+        sqe.opcode = IORING_OP_OPENAT;
+        sqe.fd = AT_FDCWD;
+        sqe.addr = reinterpret_cast<std::uint64_t>(request.file.c_str()); // NOLINT the kernel takes the path as an integer
+        sqe.len = request.perms;
+        sqe.open_flags = static_cast<std::uint32_t>(request.flags);
+        sqe.user_data = first + i;
+
+        // every entry waits on the one before it
+        if (i + 1 < count) {
+            sqe.flags = IOSQE_IO_LINK;
+        }
+
+        sq_array[slot] = slot; // NOLINT the ring is an array mapped by the kernel
+        ++tail;
+    }
+
+    // publish the entries before the kernel is told about them
+    sq_tail.store(tail, std::memory_order_release);
+
+    unsigned const cq_mask = *ring_field(completions, params.cq_off.ring_mask);
+    auto* const cqes = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(completions) + params.cq_off.cqes); // NOLINT the kernel lays the ring out by offset
+    std::atomic_ref<unsigned> cq_head(*ring_field(completions, params.cq_off.head));
+    std::atomic_ref<unsigned> cq_tail(*ring_field(completions, params.cq_off.tail));
+
+    // one syscall submits the whole batch and waits for all of it
+    unsigned pending = count;
+    unsigned reaped = 0;
+    while (reaped < count) {
+        std::optional<int> const submitted = syscall_wrapper::io_uring_enter_wrapper(ring_fd, pending, count - reaped, IORING_ENTER_GETEVENTS);
+        if (!submitted.has_value()) {
+            return false;
+        }
+        pending -= std::min(pending, static_cast<unsigned>(submitted.value()));
+
+        unsigned head = cq_head.load(std::memory_order_relaxed);
+        unsigned const ready = cq_tail.load(std::memory_order_acquire);
+        for (; head != ready; ++head) {
+            io_uring_cqe const& cqe = cqes[head & cq_mask]; // NOLINT the ring is an array mapped by the kernel
+            results[cqe.user_data] = std::make_optional<int>(cqe.res);
+            ++reaped;
+        }
+        cq_head.store(head, std::memory_order_release);
+    }
+    return true;
+}
+
+auto io_ring::open(std::vector<open_request> const& requests) -> std::vector<std::optional<int>> {
+    std::vector<std::optional<int>> results(requests.size(), std::nullopt);
+
+    // a batch larger than the ring goes in as few submissions as it fits in
+    unsigned const capacity = std::min(ENTRIES, params.sq_entries);
+    for (std::size_t first = 0; first < requests.size(); first += capacity) {
+        auto const count = static_cast<unsigned>(std::min<std::size_t>(capacity, requests.size() - first));
+        if (!submit(requests, first, count, results)) {
+            // a ring which failed part way through may still hold entries, so it is never used again
+            unsupported = true;
+            break;
+        }
+
+        // the link does not carry over into the next submission, so a failure cancels the rest by hand
+        if (std::any_of(std::begin(results) + static_cast<std::ptrdiff_t>(first), std::begin(results) + static_cast<std::ptrdiff_t>(first + count), [](std::optional<int> const& res) { return res.value_or(0) < 0; })) {
+            std::fill(std::begin(results) + static_cast<std::ptrdiff_t>(first + count), std::end(results), std::make_optional<int>(-ECANCELED));
+            break;
+        }
+    }
+    return results;
+}
+} // namespace jsh
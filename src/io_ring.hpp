@@ -0,0 +1,116 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * io_ring: an io_uring instance which submits a whole batch of operations with a single syscall
+ *
+ * NOTES: the rings are shared memory, so a forked child would race its parent on them, each process sets up its own ring the first time it needs one
+ */
+class io_ring {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr unsigned ENTRIES = 32;
+
+    /**
+     * ring_fd: the io_uring instance
+     */
+    file_descriptor_wrapper ring_fd;
+
+    /**
+     * owner: the process which set the ring up
+     */
+    pid_t owner;
+
+    /**
+     * sq_ring, sq_ring_size: the submission ring, which also holds the completion ring when the kernel maps both at once
+     */
+    void* sq_ring = nullptr;
+    std::size_t sq_ring_size = 0;
+
+    /**
+     * cq_ring, cq_ring_size: the completion ring, only mapped separately on kernels without IORING_FEAT_SINGLE_MMAP
+     */
+    void* cq_ring = nullptr;
+    std::size_t cq_ring_size = 0;
+
+    /**
+     * sqes, sqes_size: the submission queue entries
+     */
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqes_size = 0;
+
+    /**
+     * params: the offsets the kernel handed back when the ring was set up
+     */
+    io_uring_params params{};
+
+    /**
+     * shared: the ring of the calling process
+     */
+    static std::unique_ptr<io_ring> shared;
+
+    /**
+     * unsupported: the kernel refused to set up a ring, or one failed, so io_uring is not tried again
+     */
+    static bool unsupported;
+
+    /**
+     * constructor which takes ownership of an io_uring instance
+     */
+    io_ring(file_descriptor_wrapper ring_fd, pid_t owner, io_uring_params const& params);
+
+    /**
+     * map: maps the rings of the instance into memory
+     *
+     * returns false if any of them could not be mapped
+     */
+    [[nodiscard]] auto map() -> bool;
+
+    /**
+     * ring_field: a field of the submission or completion ring at the offset the kernel handed back
+     */
+    [[nodiscard]] static auto ring_field(void* ring, std::uint32_t offset) -> unsigned*;
+
+    /**
+     * submit: opens every request in [first, first + count), count is at most ENTRIES, and stores the result or -errno of each in results
+     *
+     * NOTES: the entries are linked so the kernel opens them in order, a file created by one redirection can be read by the next, and the first failure cancels the rest
+     *
+     * returns false if the ring failed, the results of the requests it did complete are still stored
+     */
+    [[nodiscard]] auto submit(std::vector<open_request> const& requests, std::size_t first, unsigned count, std::vector<std::optional<int>>& results) -> bool;
+
+  public:
+    /**
+     * delete copy and move, the rings are mapped at fixed addresses
+     */
+    io_ring(io_ring const& other) = delete;
+    io_ring(io_ring&& other) = delete;
+    auto operator=(io_ring const& other) -> io_ring& = delete;
+    auto operator=(io_ring&& other) -> io_ring& = delete;
+
+    ~io_ring();
+
+    /**
+     * get: the ring of the calling process, set up the first time it is asked for
+     *
+     * returns nullptr if io_uring is not available
+     */
+    [[nodiscard]] static auto get() -> io_ring*;
+
+    /**
+     * open: opens every request relative to the current directory in as few submissions as the ring allows
+     *
+     * returns the file descriptor or -errno of each request, -ECANCELED once an earlier request failed, std::nullopt for the requests the ring never got to
+     */
+    [[nodiscard]] auto open(std::vector<open_request> const& requests) -> std::vector<std::optional<int>>;
+};
+} // namespace jsh
@@ -1,91 +1,144 @@
 #include "job.hpp"
+#include "job_table.hpp"
 
 namespace jsh {
 auto job::parse_job(std::string const& input) -> std::unique_ptr<job_data> {
     // stack allocated struct for job_data
     std::unique_ptr<job_data> j_data = std::make_unique<job_data>();
 
-    // structure for information about operators
-    static constexpr std::size_t OP_DATA_ALIGNMENT = 16;
-    struct __attribute((aligned(OP_DATA_ALIGNMENT))) op_data {
-        std::size_t index;
-        OPERATOR op;
-    };
-
-    // search for all instances of AND operator
-    std::vector<op_data> indices;
-    auto find_operators = [&](OPERATOR oprtr) {
-        op_data op_d{};
-        op_d.op = oprtr;
-        op_d.index = 0;
-        while (true) {
-            // find the first instance of the operator
-            op_d.index = input.find(OPERATOR_STR[oprtr], op_d.index);
-
-            // check to see if find was successful
-            if (op_d.index == std::string::npos) [[likely]] {
+    // remember what the user typed for the job table, the tokens point into it so they are lexed from the copy
+    j_data->input = input;
+    j_data->tokens = lexer::lex(j_data->input);
+    std::span<token const> tokens = j_data->tokens.tokens;
+
+    // a stage starts right after the operator before it, keeping the whitespace in between
+    std::string_view const line = j_data->input;
+    std::size_t stage_start = 0;
+    auto const offset = [&](std::string_view text) -> std::size_t { return static_cast<std::size_t>(text.data() - line.data()); };
+
+    // leading annotations configure the whole job
+    while (tokens.size() > 1) {
+        // an annotation is a plain word followed by the rest of the command, otherwise it is the command
+        token const& tok = tokens.front();
+        if (tok.kind != TOKEN_KIND::WORD || tok.value.data() != tok.text.data()) {
+            break;
+        }
+        std::string_view const word = tok.value;
+
+        // timeout=SECS gives the job a wall clock timeout
+        if (word.starts_with(TIMEOUT_PREFIX)) {
+            std::string_view const secs_str = word.substr(TIMEOUT_PREFIX.size());
+            unsigned int secs = 0;
+            auto [ptr, err] = std::from_chars(secs_str.data(), secs_str.data() + secs_str.size(), secs);
+            if (err != std::errc{} || ptr != secs_str.data() + secs_str.size()) {
                 break;
             }
-
-            // after this point we should no longer be dealing with npos
-            assert(op_d.index != std::string::npos);
-
-            // ensure that this index is unique
-            assert(std::ranges::find_if(indices, [&](op_data const& oprtr) { return oprtr.index == op_d.index; }) == std::end(indices));
-
-            // add index
-            indices.push_back(op_d);
-
-            // increment beyond operator
-            op_d.index += OPERATOR_LENGTH[oprtr];
+            j_data->timeout = std::chrono::seconds(secs);
+        } else if (word.starts_with(PIPE_SIZE_PREFIX)) {
+            // pipe_size=SIZE sizes the job's pipes
+            std::string_view const size_str = word.substr(PIPE_SIZE_PREFIX.size());
+            std::optional<pipe_policy> const policy = size_str.empty() ? std::nullopt : pipe_capacity::parse_policy(size_str);
+            if (!policy.has_value()) {
+                break;
+            }
+            j_data->pipe_sizing = policy;
+        } else if (word.starts_with(AFFINITY_PREFIX)) {
+            // cpus=LIST places the job's stages
+            std::string_view const cpus_str = word.substr(AFFINITY_PREFIX.size());
+            std::optional<affinity_policy> policy = cpus_str.empty() ? std::nullopt : cpu_affinity::parse_policy(cpus_str);
+            if (!policy.has_value()) {
+                break;
+            }
+            j_data->affinity = std::move(policy);
+        } else if (word == TIME_KEYWORD) {
+            // time reports the job's resource usage in the format of JSH_TIME_FORMAT
+            j_data->time_format = job_time::format();
+        } else if (word.starts_with(TIME_FORMAT_PREFIX)) {
+            // time=FORMAT reports it in the given format
+            std::optional<TIME_FORMAT> const format = job_time::parse_format(word.substr(TIME_FORMAT_PREFIX.size()));
+            if (!format.has_value()) {
+                break;
+            }
+            j_data->time_format = format;
+        } else if (word == PERFSTAT_KEYWORD) {
+            // perfstat counts the job's perf events per stage
+            j_data->perfstat = true;
+        } else if (word.starts_with(MEMORY_MAX_PREFIX)) {
+            // memory_max=SIZE limits the memory of the job's cgroup
+            std::optional<std::string> limit = job_cgroup::parse_memory_max(word.substr(MEMORY_MAX_PREFIX.size()));
+            if (!limit.has_value()) {
+                break;
+            }
+            j_data->limits.memory_max = std::move(limit);
+        } else if (word.starts_with(CPU_MAX_PREFIX)) {
+            // cpu_max=QUOTA[/PERIOD] limits the CPU time of the job's cgroup
+            std::optional<std::string> limit = job_cgroup::parse_cpu_max(word.substr(CPU_MAX_PREFIX.size()));
+            if (!limit.has_value()) {
+                break;
+            }
+            j_data->limits.cpu_max = std::move(limit);
+        } else {
+            // anything else is the command
+            break;
         }
 
-        return;
-    };
+        stage_start = offset(word) + word.size();
+        tokens = tokens.subspan(1);
+    }
 
-    // check for all of the operators
-    for (char op = OPERATOR::AND; op < OPERATOR::COUNT; ++op) {
-        find_operators(static_cast<OPERATOR>(op));
+    // a trailing & sends the whole job to the background, the whitespace before it stays with the last command
+    std::size_t stage_end = line.find_last_not_of(WHITESPACE) + 1;
+    if (!tokens.empty() && tokens.back().kind == TOKEN_KIND::BACKGROUND) {
+        stage_end = offset(tokens.back().text);
+        tokens = tokens.subspan(0, tokens.size() - 1);
+        j_data->is_background = true;
+        j_data->is_foreground = false;
     }
 
     // populate job_data
-    // sort based on indices, so commands will happen in the correct order
-    std::ranges::sort(indices, [](op_data const& lhs, op_data const& rhs) { return lhs.index < rhs.index; });
-
-    // resize job vectors
-    j_data->input_seq.reserve(indices.size() + 1);
-    j_data->process_seq.reserve(indices.size() + 1);
-    j_data->operator_seq.reserve(indices.size());
-
-    // split the strings based on processes
-    std::size_t index = 0;
-    for (auto const& idx : indices) {
-        // we don't want this to overflow
-        assert(idx.index >= index);
+    // the operators were found by the lexer, so splitting the stages is one walk over the tokens
+    std::size_t first = 0;
+    for (std::size_t idx = 0; idx < tokens.size(); ++idx) {
+        if (!lexer::is_operator(tokens[idx].kind)) [[likely]] {
+            continue;
+        }
 
-        j_data->input_seq.push_back(input.substr(index, idx.index - index));
-        index = idx.index + OPERATOR_LENGTH[idx.op];
+        j_data->input_seq.push_back(line.substr(stage_start, offset(tokens[idx].text) - stage_start));
+        j_data->token_seq.push_back(tokens.subspan(first, idx - first));
+        j_data->operator_seq.push_back(to_operator(tokens[idx].kind));
+        stage_start = offset(tokens[idx].text) + tokens[idx].text.size();
+        first = idx + 1;
     }
 
     // push back the final process command
-    j_data->input_seq.push_back(input.substr(index, input.size()));
-
-    // copy over all of the operators
-    for (op_data const& oprtr : indices) {
-        j_data->operator_seq.push_back(oprtr.op);
-    }
+    j_data->input_seq.push_back(line.substr(stage_start, stage_end - stage_start));
+    j_data->token_seq.push_back(tokens.subspan(first));
+    j_data->process_seq.reserve(j_data->input_seq.size());
 
     // make sure all of the sequences are appropriately sized
     assert(j_data->operator_seq.size() == j_data->input_seq.size() - 1);
+    assert(j_data->token_seq.size() == j_data->input_seq.size());
 
     return j_data;
 }
 
 void job::execute_job(std::unique_ptr<job_data>& data) {
+    // with the io_uring backend the redirections of every stage are collected and opened together
+    std::vector<redirection> redirections;
+    std::vector<redirection>* const deferred = process::io_backend() == process::IO_BACKEND::URING ? &redirections : nullptr;
+
+    // a quote or backslash left open swallows the rest of the line, so no command of it is run
+    if (data->tokens.error) {
+        cout_logger.log(LOG_LEVEL::ERROR, "Invalid process input...");
+        cout_logger.log(LOG_LEVEL::ERROR, "Error Parsing Process...");
+        return;
+    }
+
     // parse all of the individual process inputs
-    for (std::string const& input : data->input_seq) {
+    for (std::span<token const> const tokens : data->token_seq) {
         // parse the users input into a data describing a specific process
-        std::optional<std::unique_ptr<jsh::process_data>> proc_data = jsh::process::parse_process(input);
+        std::size_t const first_redirection = redirections.size();
+        std::optional<std::unique_ptr<jsh::process_data>> proc_data = jsh::process::parse_process(tokens, deferred);
 
         // check the to see if the input was valid
         if (!proc_data.has_value()) { // invalid
@@ -93,65 +146,399 @@ void job::execute_job(std::unique_ptr<job_data>& data) {
             return;
         }
 
+        // the redirections found in this input belong to the stage about to be added
+        for (std::size_t i = first_redirection; i < redirections.size(); ++i) {
+            redirections[i].stage = data->process_seq.size();
+        }
+
         // move the data from the optional into the vector
         assert(proc_data.has_value());
         data->process_seq.emplace_back(std::move(proc_data.value()));
     }
 
-    // if the job is running in the forground, relinquish control of the terminal
+    if (!redirections.empty() && !process::open_redirections(redirections, data->process_seq)) {
+        cout_logger.log(LOG_LEVEL::ERROR, "Error Parsing Process...");
+        return;
+    }
+
+    // a background job made of more than one pipeline runs in a subshell so the shell does not have to wait between them, a timed or counted one does so the subshell can wait on it and report
+    if (data->is_background && (data->time_format.has_value() || data->perfstat || std::ranges::any_of(data->operator_seq, [](OPERATOR oprtr) { return oprtr != OPERATOR::PIPE; }))) {
+        execute_subshell(*data);
+        return;
+    }
+
+    run_job(*data);
+
+    // a foreground job is finished with its cgroup, a stopped or background job's cgroup lives on in the job table
+    if (data->cgroup != nullptr) {
+        if (!data->is_background) {
+            job_cgroup::record(data->cgroup->usage());
+        }
+        data->cgroup = nullptr;
+    }
+}
+
+void job::run_job(job_data& data) {
+    // every process starts without an exit status
+    data.status_seq.assign(data.process_seq.size(), -1);
+
+    // a job which was handed a process group keeps all of its pipelines in it
+    bool const fixed_group = data.pgid != nullptr && *data.pgid != -1;
+
+    // the timeout covers every pipeline of the job
+    if (data.timeout.has_value() && !data.deadline.has_value()) {
+        data.deadline = std::chrono::steady_clock::now() + data.timeout.value();
+    }
+
+    // the wall time of a timed job covers every pipeline
+    std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+    data.stage_usages.clear();
+    data.counters.clear();
+
+    // control flow branches on the integer status, which starts out as the status of the previous job
+    compile_plan(data);
+    data.status = environment::get_status();
+
+    // PIPESTATUS is the status of every stage of the last foreground pipeline which ran to completion
+    plan_step const* completed = nullptr;
+
+    // perform the process' execution one pipeline at a time
+    for (plan_step const& step : data.plan) {
+        // && and || skip the pipeline depending on the status of the previous one, the status carries over untouched
+        if ((step.condition == OPERATOR::AND && data.status != EXIT_SUCCESS) || (step.condition == OPERATOR::OR && data.status == EXIT_SUCCESS)) {
+            continue;
+        }
+
+        // every pipeline gets its own process group
+        if (!fixed_group) {
+            data.pgid = std::make_shared<pid_t>(-1);
+        }
+
+        // run every stage of the pipeline at once, a stopped pipeline ends the job
+        if (!execute_pipeline(data, step.begin, step.end)) {
+            break;
+        }
+        completed = &step;
+    }
+
+    // $? and PIPESTATUS are only touched once per job no matter how many pipelines ran
+    environment::set_status(data.status);
+    if (completed != nullptr && !data.is_background) {
+        environment::set_pipestatus(std::span<int const>{data.status_seq}.subspan(completed->begin, completed->end - completed->begin + 1));
+    }
+
+    if (data.time_format.has_value()) {
+        std::ranges::sort(data.stage_usages, {}, &stage_usage::stage);
+        job_time::report(data.input, std::chrono::steady_clock::now() - start, data.status, data.stage_usages, data.time_format.value());
+    }
+
+    if (data.perfstat) {
+        perf_counters::report(data.counters);
+    }
+}
+
+auto job::stage_command(job_data const& data, std::size_t idx) -> std::string {
+    assert(idx < data.input_seq.size());
+
+    // the input of a stage keeps the whitespace around the operators
+    std::string_view command = data.input_seq[idx];
+    while (!command.empty() && static_cast<bool>(std::isspace(command.front()))) {
+        command.remove_prefix(1);
+    }
+    while (!command.empty() && static_cast<bool>(std::isspace(command.back()))) {
+        command.remove_suffix(1);
+    }
+    return std::string{command};
+}
+
+void job::compile_plan(job_data& data) {
+    assert(data.input_seq.size() == data.process_seq.size());
+    assert(data.input_seq.size() == data.operator_seq.size() + 1);
+
+    data.plan.clear();
+
+    // the first pipeline always runs
+    OPERATOR condition = OPERATOR::SEQUENCE;
+    std::size_t begin = 0;
+    while (begin < data.process_seq.size()) {
+        // extend the pipeline for as long as processes are piped into one another
+        std::size_t end = begin;
+        while (end + 1 < data.process_seq.size() && data.operator_seq[end] == OPERATOR::PIPE) {
+            ++end;
+        }
+
+        data.plan.push_back(plan_step{.begin = begin, .end = end, .condition = condition});
+
+        // the operator after the pipeline decides whether the next one runs
+        if (end + 1 < data.process_seq.size()) {
+            condition = data.operator_seq[end];
+            assert(condition != OPERATOR::PIPE);
+        }
+
+        begin = end + 1;
+    }
+}
+
+void job::execute_subshell(job_data& data) {
+    // the subshell and everything it starts share one cgroup, which has to exist before the fork
+    data.cgroup = job_cgroup::create(data.limits);
+
+    // fork a copy of the shell to run the job
+    std::optional<pid_t> const pid_op = syscall_wrapper::fork_wrapper();
+    if (!pid_op.has_value()) {
+        return;
+    }
+    pid_t const pid = pid_op.value();
+
+    if (pid == 0) { // child
+        // the subshell leads a process group which every pipeline of the job joins
+        std::optional<pid_t> const cur_pid = syscall_wrapper::getpid_wrapper();
+        assert(cur_pid.has_value()); // getpid never fails
+        if (!syscall_wrapper::setpgid_wrapper(0, 0) || !process::reset_signals()) {
+            _exit(EXIT_FAILURE);
+        }
+        data.pgid = std::make_shared<pid_t>(cur_pid.value());
+        if (data.cgroup != nullptr) {
+            std::ignore = data.cgroup->join();
+        }
+
+        // the subshell waits on the job like a foreground shell would, without the terminal
+        data.is_background = false;
+        run_job(data);
+
+        // exit with the status of the job
+        _exit(data.status);
+    }
+
+    // parent
+    // place the subshell in its own group before it can start any children
+    std::ignore = syscall_wrapper::setpgid_wrapper(pid, pid);
+
+    // the subshell owns the redirections now
+    data.process_seq.clear();
+
+    // starting a background job succeeds, $! is its subshell
+    environment::set_status(EXIT_SUCCESS);
+    environment::set_background_pid(pid);
+    std::size_t const job_id = job_table::add(pid, {pid}, data.input, JOB_STATE::RUNNING);
+    job_table::find(job_id)->cgroup = std::move(data.cgroup);
+    if (data.timeout.has_value()) {
+        job_table::set_deadline(job_id, std::chrono::steady_clock::now() + data.timeout.value());
+    }
+    cout_logger.log(LOG_LEVEL::SILENT, '[', job_id, "] ", pid, '\n');
+}
+
+auto job::execute_pipeline(job_data& data, std::size_t begin, std::size_t end) -> bool {
+    assert(begin <= end);
+    assert(end < data.process_seq.size());
 
-    // create the process control group
-    data->pgid = std::make_shared<pid_t>(-1);
-    assert(data->pgid != nullptr); // we should not have a nullptr
+    // every stage of the pipeline shares one process group
+    assert(data.pgid != nullptr); // we should not have a nullptr
 
-    // perform the process' execution
-    assert(data->input_seq.size() == data->process_seq.size());
-    assert(data->input_seq.size() == data->operator_seq.size() + 1);
-    for (std::size_t i = 0; i < data->process_seq.size(); ++i) {
+    // children which still need to be reaped, along with the index of the process they are running
+    std::vector<std::pair<std::size_t, pid_t>> children;
+    children.reserve(end - begin + 1);
+
+    // the job's annotation wins over JSH_PIPE_SIZE, which is only looked up when there is a pipe to size
+    pipe_policy const pipe_sizing = begin == end ? pipe_policy{} : data.pipe_sizing.value_or(pipe_capacity::policy());
+
+    // the CPUs of every stage, the job's annotation wins over JSH_PIPELINE_AFFINITY
+    std::vector<std::optional<cpu_set_t>> const placement = cpu_affinity::place(data.affinity.has_value() ? data.affinity.value() : cpu_affinity::policy(), end - begin + 1);
+
+    // the job's cgroup is created the first time it forks, so jobs made only of shell internals never get one
+    bool const forks = std::any_of(std::begin(data.process_seq) + static_cast<std::ptrdiff_t>(begin), std::begin(data.process_seq) + static_cast<std::ptrdiff_t>(end) + 1, [&](std::unique_ptr<process_data> const& proc) {
+        auto const* binary = std::get_if<binary_data>(proc.get());
+        return (binary != nullptr && !binary->args.empty()) || (begin != end && std::holds_alternative<builtin_data>(*proc));
+    });
+    if (forks && data.cgroup == nullptr) {
+        data.cgroup = job_cgroup::create(data.limits);
+    }
+
+    // the counters of this pipeline are read once it has been reaped
+    std::size_t const first_counters = data.counters.size();
+
+    // launch all of the stages before waiting on any of them so a producer never blocks on a reader that has not started
+    for (std::size_t i = begin; i <= end; ++i) {
         // get a reference to the process_data
-        std::unique_ptr<process_data>& proc_data = data->process_seq[i];
+        std::unique_ptr<process_data>& proc_data = data.process_seq[i];
 
-        if (i + 1 < data->process_seq.size()) {
+        // Check if the current process' output is being piped somewhere else
+        if (i < end) {
             // we should not have any invalid operators at this point
-            assert(data->operator_seq[i] < OPERATOR::COUNT);
+            assert(data.operator_seq[i] == OPERATOR::PIPE);
 
-            // Check if the current process' output is being piped somewhere else
-            if (data->operator_seq[i] == OPERATOR::PIPE) {
-                // create the pipe
-                std::optional<std::vector<file_descriptor_wrapper>> pipe_fds_op = syscall_wrapper::pipe_wrapper();
+            // create the pipe
+            std::optional<std::vector<file_descriptor_wrapper>> pipe_fds_op = syscall_wrapper::pipe_wrapper();
 
-                // error handle
-                if (!pipe_fds_op.has_value()) {
-                    return;
-                }
+            // error handle
+            if (!pipe_fds_op.has_value()) {
+                break;
+            }
+
+            // get pipe fds
+            assert(pipe_fds_op.has_value());
+            assert(pipe_fds_op.value().size() == 2);
+            std::vector<file_descriptor_wrapper> pipe_fds = std::move(pipe_fds_op.value());
+            assert(pipe_fds.size() == 2);
+
+            // size the pipe, only a pipeline the shell waits on can be sampled
+            pipe_capacity::add_pipe(pipe_fds[0], i, pipe_sizing, !data.is_background);
+
+            // set the current output and the next input to read from the pipe
+            std::visit([&](auto&& var) { var.stdout = std::move(pipe_fds[1]); }, *proc_data);
+            // there will always be another process since this is being piped somewhere else
+            assert(data.process_seq.size() > i + 1);
+            std::visit([&](auto&& var) { var.stdin = std::move(pipe_fds[0]); }, *data.process_seq[i + 1]);
+        }
+
+        // set the process group id ptr to be the process group id ptr for the job
+        std::visit([&](auto&& var) {var.pgid = data.pgid;var.is_foreground = data.is_foreground;var.affinity = placement[i - begin]; }, *proc_data);
+
+        // launch binaries in the background of the shell, shell internals and lone builtins run to completion immediately
+        if (auto* binary = std::get_if<binary_data>(proc_data.get())) {
+            // there is nothing to run for an empty command
+            if (binary->args.empty()) {
+                continue;
+            }
 
-                // get pipe fds
-                assert(pipe_fds_op.has_value());
-                assert(pipe_fds_op.value().size() == 2);
-                std::vector<file_descriptor_wrapper> pipe_fds = std::move(pipe_fds_op.value());
-                assert(pipe_fds.size() == 2);
-
-                // set the current output and the next input to read from the pipe
-                std::visit([&](auto&& var) { var.stdout = std::move(pipe_fds[1]); }, *proc_data);
-                // there will always be another process since this is being piped somewhere else
-                assert(data->process_seq.size() > i);
-                std::visit([&](auto&& var) { var.stdin = std::move(pipe_fds[0]); }, *data->process_seq[i + 1]);
-            } else if (data->operator_seq[i] == OPERATOR::AND) {
-                // get the exit status from previous process
-                std::string const exit_status = environment::get_var(environment::STATUS_STRING);
-
-                // check to see if it was not sucessful, if so break out of the loop
-                if (exit_status != environment::SUCCESS_STRING) {
-                    break;
+            binary->cgroup = data.cgroup;
+            std::optional<file_descriptor_wrapper> gate = data.perfstat ? perf_counters::hold(binary->exec_gate) : std::nullopt;
+            std::optional<pid_t> const pid = process::launch_process(*binary);
+            if (pid.has_value()) {
+                children.emplace_back(i, pid.value());
+                if (data.perfstat) {
+                    data.counters.push_back(stage_counters{.stage = i, .command = stage_command(data, i), .fds = perf_counters::attach(pid.value(), true, std::move(gate))});
                 }
+            } else {
+                data.status_seq[i] = process::COMMAND_NOT_FOUND_STATUS;
             }
+        } else if (auto* builtin = std::get_if<builtin_data>(proc_data.get()); builtin != nullptr && begin != end) {
+            // a builtin in a pipeline runs in a copy of the shell so it can not block on a reader which has not started yet
+            builtin->cgroup = data.cgroup;
+            std::optional<file_descriptor_wrapper> gate = data.perfstat ? perf_counters::hold(builtin->exec_gate) : std::nullopt;
+            std::optional<pid_t> const pid = process::launch_builtin(*builtin);
+            if (pid.has_value()) {
+                children.emplace_back(i, pid.value());
+                if (data.perfstat) {
+                    data.counters.push_back(stage_counters{.stage = i, .command = stage_command(data, i), .fds = perf_counters::attach(pid.value(), false, std::move(gate))});
+                }
+            }
+        } else if (data.time_format.has_value()) {
+            // a shell internal runs inside of the shell, so its usage is the shell's own usage while it ran
+            rusage before{};
+            rusage after{};
+            getrusage(RUSAGE_SELF, &before);
+            process::execute(proc_data);
+            getrusage(RUSAGE_SELF, &after);
+            data.status_seq[i] = environment::get_status();
+            data.stage_usages.push_back(stage_usage{.stage = i, .command = stage_command(data, i), .pid = -1, .status = data.status_seq[i], .usage = job_time::difference(after, before)});
+        } else {
+            process::execute(proc_data);
+            data.status_seq[i] = environment::get_status();
         }
+    }
 
-        // set the process group id ptr to be the process group id ptr for the job
-        std::visit([&](auto&& var) {var.pgid = std::make_shared<pid_t>(-1);var.is_foreground = data->is_foreground; }, *data->process_seq[i]);
+    // every stage after the first reads the pipe written by the stage before it
+    if (begin != end) {
+        for (auto const& [idx, pid] : children) {
+            if (idx > begin) {
+                pipe_capacity::set_reader(idx - 1, pid);
+            }
+        }
+    }
+
+    // a background pipeline is handed to the job table and reaped once SIGCHLD arrives
+    if (data.is_background) {
+        if (begin != end) {
+            pipe_capacity::finish();
+        }
 
-        // execute the process
-        jsh::process::execute(proc_data);
+        std::vector<pid_t> pids;
+        pids.reserve(children.size());
+        for (auto const& [idx, pid] : children) {
+            pids.push_back(pid);
+        }
+
+        // nothing was launched, so there is nothing to track
+        if (pids.empty()) {
+            return true;
+        }
+
+        // starting a background pipeline succeeds, $! is its last stage
+        data.status = EXIT_SUCCESS;
+        environment::set_background_pid(children.back().second);
+        std::size_t const job_id = job_table::add(*data.pgid, std::move(pids), data.input, JOB_STATE::RUNNING);
+        job_table::find(job_id)->cgroup = data.cgroup;
+        if (data.deadline.has_value()) {
+            job_table::set_deadline(job_id, data.deadline.value());
+        }
+        cout_logger.log(LOG_LEVEL::SILENT, '[', job_id, "] ", children.back().second, '\n');
+        return true;
     }
+
+    // reap every stage of the pipeline through their pidfds, so the deadline can be enforced while waiting
+    std::vector<pid_t> pids;
+    pids.reserve(children.size());
+    for (auto const& [idx, pid] : children) {
+        pids.push_back(pid);
+    }
+    supervision_data const supervision = process::supervise(pids, *data.pgid, data.deadline);
+    if (begin != end) {
+        pipe_capacity::finish();
+    }
+
+    // a stage's counters include every descendant it started once they have all exited
+    for (std::size_t idx = first_counters; idx < data.counters.size(); ++idx) {
+        perf_counters::collect(data.counters[idx]);
+    }
+
+    std::vector<pid_t> stopped;
+    for (std::size_t child = 0; child < children.size(); ++child) {
+        auto const& [idx, pid] = children[child];
+        std::optional<int> const& wait_status = supervision.wait_statuses[child];
+        if (!wait_status.has_value()) {
+            continue;
+        }
+
+        // a stopped stage will be tracked by the job table
+        if (WIFSTOPPED(wait_status.value())) {
+            stopped.push_back(pid);
+            continue;
+        }
+
+        if (std::optional<int> const exit_status = process::exit_status(wait_status.value()); exit_status.has_value()) {
+            data.status_seq[idx] = exit_status.value();
+        }
+
+        if (data.time_format.has_value()) {
+            data.stage_usages.push_back(stage_usage{.stage = idx, .command = stage_command(data, idx), .pid = pid, .status = data.status_seq[idx], .usage = supervision.usages[child]});
+        }
+    }
+
+    // give the terminal back to the shell
+    process::reclaim_terminal(data.is_foreground);
+
+    // a stopped pipeline becomes a job which can be resumed with fg or bg
+    if (!stopped.empty()) {
+        std::size_t const job_id = job_table::add(*data.pgid, std::move(stopped), data.input, JOB_STATE::STOPPED);
+        job_table::find(job_id)->cgroup = data.cgroup;
+        job_entry const* entry = job_table::find(job_id);
+        assert(entry != nullptr);
+        job_table::print_job(*entry);
+        return false;
+    }
+
+    // a job which timed out does not run any further
+    if (supervision.timed_out) {
+        data.status = TIMEOUT_STATUS;
+        return false;
+    }
+
+    // the exit status of a pipeline is the exit status of its last stage
+    if (data.status_seq[end] != -1) {
+        data.status = data.status_seq[end];
+    }
+
+    return true;
 }
 } // namespace jsh
@@ -4,6 +4,9 @@
 
 // JSH
 #include "macros.hpp"
+#include "job_time.hpp"
+#include "lexer.hpp"
+#include "perf_counters.hpp"
 #include "process.hpp"
 
 namespace jsh {
@@ -25,24 +28,112 @@ class job {
      */
     static void execute_job(std::unique_ptr<job_data>& data);
 
+    /**
+     * CONSTANTS
+     */
+    static constexpr int TIMEOUT_STATUS = 124;
+
     /**
      * OPERATOR: enum which describes what operator is used to chain together a series of processes
      */
     enum OPERATOR : char {
         AND = 0,
         PIPE = 1,
-        COUNT = 2
+        OR = 2,
+        SEQUENCE = 3,
+        COUNT = 4
     };
 
   private:
     /**
      * CONSTANTS
      */
-    static constexpr char const* OPERATOR_STR[OPERATOR::COUNT] = {"&&", "|"}; // NOLINT
+    static constexpr std::string_view WHITESPACE = " \t\n\v\f\r";
+    static constexpr std::string_view TIMEOUT_PREFIX = "timeout=";
+    static constexpr std::string_view PIPE_SIZE_PREFIX = "pipe_size=";
+    static constexpr std::string_view AFFINITY_PREFIX = "cpus=";
+    static constexpr std::string_view TIME_KEYWORD = "time";
+    static constexpr std::string_view TIME_FORMAT_PREFIX = "time=";
+    static constexpr std::string_view PERFSTAT_KEYWORD = "perfstat";
+    static constexpr std::string_view MEMORY_MAX_PREFIX = "memory_max=";
+    static constexpr std::string_view CPU_MAX_PREFIX = "cpu_max=";
+
+    /**
+     * to_operator: the operator an operator token joins two commands with
+     */
+    [[nodiscard]] static constexpr auto to_operator(TOKEN_KIND kind) -> OPERATOR {
+        switch (kind) {
+        case TOKEN_KIND::AND: {
+            return OPERATOR::AND;
+        }
+        case TOKEN_KIND::PIPE: {
+            return OPERATOR::PIPE;
+        }
+        case TOKEN_KIND::OR: {
+            return OPERATOR::OR;
+        }
+        default: {
+            assert(kind == TOKEN_KIND::SEQUENCE);
+            return OPERATOR::SEQUENCE;
+        }
+        }
+    }
+
+    /**
+     * stage_command: the command a stage of the job ran, without the whitespace around it
+     */
+    [[nodiscard]] static auto stage_command(job_data const& data, std::size_t idx) -> std::string;
 
-    static constexpr std::size_t OPERATOR_LENGTH[OPERATOR::COUNT] = {std::string_view(OPERATOR_STR[OPERATOR::AND]).size(), std::string_view(OPERATOR_STR[OPERATOR::PIPE]).size()}; // NOLINT
-    static_assert(OPERATOR_LENGTH[OPERATOR::AND] == 2, "&& operator not correct length");
-    static_assert(OPERATOR_LENGTH[OPERATOR::PIPE] == 1, "| operator not correct length");
+    /**
+     * compile_plan: groups the processes of a job into pipelines along with the condition each pipeline runs under
+     *
+     * data: job_data structure whose plan is populated
+     */
+    static void compile_plan(job_data& data);
+
+    /**
+     * run_job: executes the already parsed processes of a job by walking its plan one pipeline at a time
+     *
+     * data: job_data structure which describes how to execute the job
+     */
+    static void run_job(job_data& data);
+
+    /**
+     * execute_subshell: runs a background job in a forked copy of the shell and adds it to the job table
+     *
+     * data: job_data structure which describes how to execute the job
+     */
+    static void execute_subshell(job_data& data);
+
+    /**
+     * execute_pipeline: launches every process in [begin, end] concurrently in one process group and then reaps all of them
+     *
+     * data: the job which the pipeline belongs to
+     *
+     * begin: the index of the first process in the pipeline
+     *
+     * end: the index of the last process in the pipeline
+     *
+     * returns false if the rest of the job should not run, either because the pipeline was stopped and added to the job table or because the job timed out
+     *
+     * NOTES: the pipeline's exit status is stored in the job's status rather than in $?
+     */
+    static auto execute_pipeline(job_data& data, std::size_t begin, std::size_t end) -> bool;
+};
+
+/**
+ * plan_step: one pipeline of a compiled job
+ *
+ * begin: the index of the first process in the pipeline
+ *
+ * end: the index of the last process in the pipeline
+ *
+ * condition: the operator joining this pipeline to the previous one, it decides whether the pipeline runs given the previous status
+ */
+struct plan_step {
+    std::size_t begin;
+    std::size_t end;
+    job::OPERATOR condition;
 };
 
 /**
@@ -54,9 +145,24 @@ class job {
 static constexpr std::size_t JOB_DATA_ALIGNMENT = 128;
 struct __attribute__((packed)) __attribute__((aligned(JOB_DATA_ALIGNMENT))) job_data {
     /**
-     * input_seq: the sequence of commands which make up a job
+     * input: the command line the job was parsed from
      */
-    std::vector<std::string> input_seq;
+    std::string input;
+
+    /**
+     * tokens: the words and operators input was lexed into, they point into input
+     */
+    token_stream tokens;
+
+    /**
+     * input_seq: the sequence of commands which make up a job, as they were typed between the operators
+     */
+    std::vector<std::string_view> input_seq;
+
+    /**
+     * token_seq: the tokens of each command in input_seq
+     */
+    std::vector<std::span<token const>> token_seq;
 
     /**
      * operator_seq: the sequence of operators which make up the job
@@ -68,11 +174,81 @@ struct __attribute__((packed)) __attribute__((aligned(JOB_DATA_ALIGNMENT))) job_
      */
     std::vector<std::unique_ptr<process_data>> process_seq;
 
+    /**
+     * plan: the pipelines of the job in the order they run, compiled once all of the processes are parsed
+     */
+    std::vector<plan_step> plan;
+
+    /**
+     * status: the exit status of the most recently run pipeline, only written to $? once the job is done
+     */
+    int status = EXIT_SUCCESS;
+
+    /**
+     * status_seq: the exit status of each process in the job, -1 if the process did not report one
+     */
+    std::vector<int> status_seq;
+
     /**
      * is_foreground: indicates whether the job will be executing in the foreground or background
      */
     bool is_foreground = true;
 
+    /**
+     * is_background: indicates whether the shell returns to the prompt without waiting on the job (a trailing &)
+     */
+    bool is_background = false;
+
+    /**
+     * timeout: the wall clock time the job may run for before its process group is killed (a timeout=SECS prefix)
+     */
+    std::optional<std::chrono::seconds> timeout;
+
+    /**
+     * pipe_sizing: how the job's pipes are sized (a pipe_size=SIZE prefix), std::nullopt to use JSH_PIPE_SIZE
+     */
+    std::optional<pipe_policy> pipe_sizing;
+
+    /**
+     * affinity: which CPUs the stages of the job's pipelines run on (a cpus=LIST prefix), std::nullopt to use JSH_PIPELINE_AFFINITY
+     */
+    std::optional<affinity_policy> affinity;
+
+    /**
+     * limits: the limits placed on the job's cgroup (memory_max=SIZE and cpu_max=QUOTA[/PERIOD] prefixes)
+     */
+    cgroup_limits limits;
+
+    /**
+     * cgroup: the cgroup every process of the job runs in, created once the job first forks if JSH_CGROUP_ROOT is set
+     */
+    std::shared_ptr<job_cgroup> cgroup;
+
+    /**
+     * time_format: how the job's resource usage is reported once it finishes (a time or time=FORMAT prefix), std::nullopt if it is not timed
+     */
+    std::optional<TIME_FORMAT> time_format;
+
+    /**
+     * stage_usages: the resources used by each stage of a timed job
+     */
+    std::vector<stage_usage> stage_usages;
+
+    /**
+     * perfstat: whether the job's stages are counted with perf counters and reported once it finishes (a perfstat prefix)
+     */
+    bool perfstat = false;
+
+    /**
+     * counters: the perf counters of each forked stage of a job run with perfstat
+     */
+    std::vector<stage_counters> counters;
+
+    /**
+     * deadline: the point in time at which a job with a timeout is killed, set once the job starts running
+     */
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+
     /**
      * pgid: the process group id for the job
      */
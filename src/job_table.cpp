@@ -0,0 +1,291 @@
+#include "job_table.hpp"
+#include "job.hpp"
+#include "process.hpp"
+
+namespace jsh {
+std::unordered_map<std::size_t, job_entry> job_table::jobs{};
+std::unordered_map<pid_t, std::size_t> job_table::pid_index{};
+std::unordered_map<pid_t, std::size_t> job_table::pgid_index{};
+std::set<std::size_t> job_table::job_ids{};
+std::size_t job_table::next_id = 1;
+std::vector<std::size_t> job_table::finished{};
+reactor* job_table::events = nullptr;
+
+auto job_table::add(pid_t pgid, std::vector<pid_t> pids, std::string command, JOB_STATE state) -> std::size_t {
+    // job ids start back at 1 once every job is gone
+    if (jobs.empty()) {
+        next_id = 1;
+    }
+    std::size_t const job_id = next_id++;
+
+    // index every process of the job
+    for (pid_t const pid : pids) {
+        pid_index.emplace(pid, job_id);
+    }
+    pgid_index.emplace(pgid, job_id);
+    job_ids.emplace_hint(std::end(job_ids), job_id);
+
+    std::size_t const num_pids = pids.size();
+    jobs.emplace(job_id, job_entry{.id = job_id, .pgid = pgid, .command = std::move(command), .pids = std::move(pids), .status_seq = std::vector<int>(num_pids, -1), .remaining = num_pids, .state = state, .deadline = std::nullopt, .timer = std::nullopt, .timer_token = std::nullopt, .timed_out = false, .cgroup = nullptr});
+
+    return job_id;
+}
+
+auto job_table::find(std::size_t job_id) -> job_entry* {
+    auto itr = jobs.find(job_id);
+    return itr == std::end(jobs) ? nullptr : &itr->second;
+}
+
+auto job_table::find_by_pid(pid_t pid) -> job_entry* {
+    auto itr = pid_index.find(pid);
+    return itr == std::end(pid_index) ? nullptr : find(itr->second);
+}
+
+auto job_table::find_by_pgid(pid_t pgid) -> job_entry* {
+    auto itr = pgid_index.find(pgid);
+    return itr == std::end(pgid_index) ? nullptr : find(itr->second);
+}
+
+auto job_table::resolve(std::string const& spec) -> job_entry* {
+    // the most recent job
+    if (spec.empty()) {
+        return job_ids.empty() ? nullptr : find(*job_ids.rbegin());
+    }
+
+    // %id refers to a job id, anything else is a pid
+    bool const is_job_id = spec.front() == JOB_SPEC_PREFIX;
+    std::string_view const num_str = is_job_id ? std::string_view(spec).substr(1) : std::string_view(spec);
+
+    std::size_t num = 0;
+    auto [ptr, err] = std::from_chars(num_str.data(), num_str.data() + num_str.size(), num);
+    if (err != std::errc{} || ptr != num_str.data() + num_str.size()) {
+        return nullptr;
+    }
+
+    return is_job_id ? find(num) : find_by_pid(static_cast<pid_t>(num));
+}
+
+auto job_table::size() -> std::size_t {
+    return jobs.size();
+}
+
+auto job_table::update(pid_t pid, int wait_status) -> bool {
+    job_entry* entry = find_by_pid(pid);
+
+    // the child does not belong to a tracked job
+    if (entry == nullptr) {
+        return false;
+    }
+
+    if (WIFSTOPPED(wait_status)) {
+        entry->state = JOB_STATE::STOPPED;
+    } else if (WIFCONTINUED(wait_status)) {
+        entry->state = JOB_STATE::RUNNING;
+    } else {
+        // the process is gone, record its status
+        auto itr = std::ranges::find(entry->pids, pid);
+        assert(itr != std::end(entry->pids));
+        entry->status_seq[static_cast<std::size_t>(itr - std::begin(entry->pids))] = process::exit_status(wait_status).value_or(-1);
+
+        pid_index.erase(pid);
+        assert(entry->remaining > 0);
+        if (--entry->remaining == 0) {
+            entry->state = JOB_STATE::DONE;
+            finished.push_back(entry->id);
+        }
+    }
+
+    return true;
+}
+
+void job_table::remove(std::size_t job_id) {
+    job_entry* entry = find(job_id);
+    if (entry == nullptr) {
+        return;
+    }
+
+    // the job is over as far as the user is concerned, so account for it
+    if (entry->cgroup != nullptr) {
+        job_cgroup::record(entry->cgroup->usage());
+    }
+
+    // drop every index pointing at the job
+    for (pid_t const pid : entry->pids) {
+        pid_index.erase(pid);
+    }
+    pgid_index.erase(entry->pgid);
+    job_ids.erase(job_id);
+
+    // the timer has to leave the reactor before it is closed
+    if (entry->timer_token.has_value() && events != nullptr) {
+        assert(entry->timer.has_value());
+        events->remove(entry->timer.value(), entry->timer_token.value()); // NOLINT a token is only handed out for a timer
+    }
+    jobs.erase(job_id);
+}
+
+void job_table::reap() {
+    // only the table's own children are collected, the stages of a pipeline which is still starting belong to whoever supervises it
+    // coalesced SIGCHLDs may stand for many children, so every tracked process is checked, update drops them from the index as they go
+    std::vector<pid_t> pids;
+    pids.reserve(pid_index.size());
+    for (auto const& [pid, job_id] : pid_index) {
+        pids.push_back(pid);
+    }
+
+    for (pid_t const pid : pids) {
+        int wait_status = 0;
+        if (waitpid(pid, &wait_status, WNOHANG | WUNTRACED | WCONTINUED) == pid) {
+            std::ignore = update(pid, wait_status);
+        }
+    }
+}
+
+auto job_table::wait_job(std::size_t job_id, bool interruptible) -> std::optional<int> {
+    job_entry* entry = find(job_id);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+
+    // the job is supervised so it is killed on time and ctrl+c is read even while the shell waits on it
+    std::vector<pid_t> pids;
+    std::ranges::copy_if(entry->pids, std::back_inserter(pids), [](pid_t pid) { return pid_index.contains(pid); });
+
+    // a timer registered with the shell's reactor already kills the job on time
+    std::optional<std::chrono::steady_clock::time_point> const deadline = entry->timed_out || entry->timer_token.has_value() ? std::nullopt : entry->deadline;
+    supervision_data const supervision = process::supervise(pids, entry->pgid, deadline, interruptible);
+    entry->timed_out = entry->timed_out || supervision.timed_out;
+    for (std::size_t i = 0; i < pids.size(); ++i) {
+        if (supervision.wait_statuses[i].has_value()) {
+            std::ignore = update(pids[i], supervision.wait_statuses[i].value());
+        }
+    }
+
+    // an interrupted wait leaves the job running in the table
+    if (supervision.interrupted) {
+        return std::make_optional<int>(process::SIGNAL_STATUS_OFFSET + SIGINT);
+    }
+
+    // a stopped job stays in the table
+    if (entry->state == JOB_STATE::STOPPED) {
+        return std::nullopt;
+    }
+
+    // wait on every process that supervision could not collect
+    for (pid_t const pid : entry->pids) {
+        if (!pid_index.contains(pid)) {
+            continue;
+        }
+
+        std::optional<int> const wait_status = process::wait_process(pid);
+        if (!wait_status.has_value()) {
+            // the child was reaped elsewhere, there is nothing left to wait for
+            pid_index.erase(pid);
+            --entry->remaining;
+            continue;
+        }
+
+        std::ignore = update(pid, wait_status.value());
+
+        // a stopped job stays in the table
+        if (entry->state == JOB_STATE::STOPPED) {
+            return std::nullopt;
+        }
+    }
+
+    // the job is finished, its status is the status of its last process
+    int const status = entry->timed_out ? job::TIMEOUT_STATUS : entry->status_seq.back();
+    remove(job_id);
+    return std::make_optional<int>(status);
+}
+
+auto job_table::continue_job(std::size_t job_id) -> bool {
+    job_entry* entry = find(job_id);
+    if (entry == nullptr) {
+        return false;
+    }
+
+    // wake up the whole process group
+    if (!syscall_wrapper::kill_wrapper(-entry->pgid, SIGCONT)) {
+        return false;
+    }
+
+    entry->state = JOB_STATE::RUNNING;
+    return true;
+}
+
+void job_table::watch(reactor* events) {
+    job_table::events = events;
+}
+
+void job_table::set_deadline(std::size_t job_id, std::chrono::steady_clock::time_point deadline) {
+    job_entry* entry = find(job_id);
+    if (entry == nullptr) {
+        return;
+    }
+
+    // create and arm the timer
+    entry->deadline = deadline;
+    entry->timer = syscall_wrapper::timerfd_create_wrapper(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (entry->timer.has_value() && !syscall_wrapper::timerfd_settime_wrapper(entry->timer.value(), deadline)) {
+        entry->timer = std::nullopt;
+    }
+
+    // the timer stays registered until the job leaves the table, expiring a job twice is harmless
+    if (entry->timer.has_value() && events != nullptr) {
+        entry->timer_token = events->add(entry->timer.value(), [job_id]() { expire(job_id); });
+    }
+}
+
+void job_table::expire(std::size_t job_id) {
+    job_entry* entry = find(job_id);
+    if (entry == nullptr || !entry->timer.has_value()) {
+        return;
+    }
+
+    // consume the expiration so the timer stops being readable
+    std::uint64_t expirations = 0;
+    std::ignore = syscall_wrapper::read_wrapper(entry->timer.value(), &expirations, sizeof(expirations));
+
+    // a finished job's group may already belong to someone else
+    if (entry->state == JOB_STATE::DONE) {
+        return;
+    }
+
+    // kill the whole job, the children are reaped once SIGCHLD arrives
+    cout_logger.log(LOG_LEVEL::WARN, "Job ", job_id, " timed out, killing process group ", entry->pgid);
+    std::ignore = syscall_wrapper::kill_wrapper(-entry->pgid, SIGKILL);
+    entry->timed_out = true;
+}
+
+void job_table::notify([[maybe_unused]] logger& log) {
+    // only the jobs which finished since the last prompt are looked at, a job which was waited on has already left the table
+    for (std::size_t const job_id : finished) {
+        if (job_entry const* entry = find(job_id); entry != nullptr && entry->state == JOB_STATE::DONE) {
+            print_job(*entry, log);
+            remove(job_id);
+        }
+    }
+    finished.clear();
+}
+
+void job_table::forget() {
+    for (std::size_t const job_id : finished) {
+        if (job_entry const* entry = find(job_id); entry != nullptr && entry->state == JOB_STATE::DONE) {
+            remove(job_id);
+        }
+    }
+    finished.clear();
+}
+
+void job_table::print([[maybe_unused]] logger& log) {
+    // print in job id order
+    for (std::size_t const job_id : job_ids) {
+        print_job(jobs.at(job_id), log);
+    }
+}
+
+void job_table::print_job(job_entry const& entry, [[maybe_unused]] logger& log) {
+    log.log(LOG_LEVEL::SILENT, '[', entry.id, "] ", JOB_STATE_STR[static_cast<std::size_t>(entry.state)], '\t', entry.command, '\n');
+}
+} // namespace jsh
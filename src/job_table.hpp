@@ -0,0 +1,240 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "cgroup.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+#include "reactor.hpp"
+
+namespace jsh {
+/**
+ * JOB_STATE: the state of a job that is not running in the foreground
+ */
+enum class JOB_STATE : char {
+    RUNNING = 0,
+    STOPPED = 1,
+    DONE = 2,
+    COUNT = 3
+};
+
+/**
+ * job_entry: a job tracked by the job table
+ *
+ * NOTES: pids and status_seq are kept in pipeline order so the status of the job is the status of its last process
+ */
+struct job_entry {
+    /**
+     * id: the job number the user refers to the job by (%id)
+     */
+    std::size_t id;
+
+    /**
+     * pgid: the process group every process of the job belongs to
+     */
+    pid_t pgid;
+
+    /**
+     * command: the command line the job was started from
+     */
+    std::string command;
+
+    /**
+     * pids: every process of the job
+     */
+    std::vector<pid_t> pids;
+
+    /**
+     * status_seq: the exit status of each process, -1 until the process has been reaped
+     */
+    std::vector<int> status_seq;
+
+    /**
+     * remaining: the number of processes which have not been reaped yet
+     */
+    std::size_t remaining;
+
+    /**
+     * state: whether the job is running, stopped, or done
+     */
+    JOB_STATE state;
+
+    /**
+     * deadline: the point in time at which the job is killed, std::nullopt if the job has no timeout
+     */
+    std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt;
+
+    /**
+     * timer: expires once the deadline passes, watched by the shell's reactor while it waits for input
+     */
+    std::optional<file_descriptor_wrapper> timer = std::nullopt;
+
+    /**
+     * timer_token: the token of the timer in the shell's reactor, std::nullopt if it is not registered
+     */
+    std::optional<std::uint64_t> timer_token = std::nullopt;
+
+    /**
+     * timed_out: indicates whether the job was killed because its deadline passed
+     */
+    bool timed_out = false;
+
+    /**
+     * cgroup: the cgroup the job runs in, its usage is recorded once the job leaves the table
+     */
+    std::shared_ptr<job_cgroup> cgroup;
+};
+
+/**
+ * job_table: keeps track of every background and stopped job
+ *
+ * NOTES: jobs are indexed by job id, pid, and pgid so that every lookup made while reaping is O(1) no matter how many jobs are alive, the ids are kept in order as well so the most recent job is found without a scan
+ */
+class job_table {
+  private:
+    /**
+     * CONSTANTS
+     */
+    static constexpr char const* JOB_STATE_STR[static_cast<std::size_t>(JOB_STATE::COUNT)] = {"Running", "Stopped", "Done"}; // NOLINT
+    static constexpr char JOB_SPEC_PREFIX = '%';
+
+    /**
+     * jobs: every tracked job indexed by its job id
+     */
+    static std::unordered_map<std::size_t, job_entry> jobs;
+
+    /**
+     * pid_index: maps the pid of each unreaped process to its job id
+     */
+    static std::unordered_map<pid_t, std::size_t> pid_index;
+
+    /**
+     * pgid_index: maps the process group of each job to its job id
+     */
+    static std::unordered_map<pid_t, std::size_t> pgid_index;
+
+    /**
+     * job_ids: the id of every tracked job in increasing order, the last one is the most recent job
+     */
+    static std::set<std::size_t> job_ids;
+
+    /**
+     * next_id: the id which will be given to the next job
+     */
+    static std::size_t next_id;
+
+    /**
+     * finished: the ids of the jobs which finished since the last notify, in the order they finished
+     *
+     * NOTES: a job may have left the table or its id may have been reused since, so an id only counts while its job is done
+     */
+    static std::vector<std::size_t> finished;
+
+    /**
+     * events: the reactor the timers of jobs with a deadline are registered with, nullptr if nothing waits on them
+     */
+    static reactor* events;
+
+    /**
+     * update: records a wait status reported for pid, returns false if pid does not belong to a tracked job
+     */
+    static auto update(pid_t pid, int wait_status) -> bool;
+
+    /**
+     * remove: stops tracking a job
+     */
+    static void remove(std::size_t job_id);
+
+  public:
+    /**
+     * add: starts tracking a job, returns the new job's id
+     *
+     * pgid: the process group of the job
+     *
+     * pids: the processes of the job in pipeline order
+     *
+     * command: the command line the job was started from
+     *
+     * state: the state the job is in
+     */
+    static auto add(pid_t pgid, std::vector<pid_t> pids, std::string command, JOB_STATE state) -> std::size_t;
+
+    /**
+     * find: returns the job with the given id
+     */
+    [[nodiscard]] static auto find(std::size_t job_id) -> job_entry*;
+
+    /**
+     * find_by_pid: returns the job the unreaped process pid belongs to
+     */
+    [[nodiscard]] static auto find_by_pid(pid_t pid) -> job_entry*;
+
+    /**
+     * find_by_pgid: returns the job running in process group pgid
+     */
+    [[nodiscard]] static auto find_by_pgid(pid_t pgid) -> job_entry*;
+
+    /**
+     * resolve: finds the job a user refers to, either %id, a pid, or the most recent job when spec is empty
+     */
+    [[nodiscard]] static auto resolve(std::string const& spec) -> job_entry*;
+
+    /**
+     * size: the number of tracked jobs
+     */
+    [[nodiscard]] static auto size() -> std::size_t;
+
+    /**
+     * reap: collects every process of a tracked job which has changed state without blocking, other children are left to whoever waits on them
+     */
+    static void reap();
+
+    /**
+     * wait_job: blocks until every process of the job has exited or one of them stops, or until ctrl+c if interruptible
+     *
+     * returns the exit status of the job, 130 if ctrl+c stopped the wait and the job is left running, or std::nullopt if the job stopped
+     */
+    [[nodiscard]] static auto wait_job(std::size_t job_id, bool interruptible = false) -> std::optional<int>;
+
+    /**
+     * continue_job: sends SIGCONT to the job's process group and marks it as running
+     */
+    [[nodiscard]] static auto continue_job(std::size_t job_id) -> bool;
+
+    /**
+     * watch: registers the timers of jobs started from now on with events, nullptr to stop registering them
+     */
+    static void watch(reactor* events);
+
+    /**
+     * set_deadline: kills the job's process group once deadline passes, the timer is registered with the reactor being watched so it fires while the shell waits for input
+     */
+    static void set_deadline(std::size_t job_id, std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * expire: kills the job whose timer fired
+     */
+    static void expire(std::size_t job_id);
+
+    /**
+     * notify: prints and stops tracking every job which has finished
+     */
+    static void notify([[maybe_unused]] logger& log = cout_logger);
+
+    /**
+     * forget: stops tracking every job which has finished without printing it, for scripts which nobody watches
+     */
+    static void forget();
+
+    /**
+     * print: prints every tracked job
+     */
+    static void print([[maybe_unused]] logger& log = cout_logger);
+
+    /**
+     * print_job: prints a single job
+     */
+    static void print_job(job_entry const& entry, [[maybe_unused]] logger& log = cout_logger);
+};
+} // namespace jsh
@@ -0,0 +1,128 @@
+#include "job_time.hpp"
+
+namespace jsh {
+auto job_time::parse_format(std::string_view value) -> std::optional<TIME_FORMAT> {
+    if (value.empty() || value == HUMAN_STR) {
+        return std::make_optional<TIME_FORMAT>(TIME_FORMAT::HUMAN);
+    }
+    if (value == JSON_STR) {
+        return std::make_optional<TIME_FORMAT>(TIME_FORMAT::JSON);
+    }
+    return std::nullopt;
+}
+
+auto job_time::format() -> TIME_FORMAT {
+    std::string_view const value = environment::get_var(TIME_FORMAT_VAR);
+    std::optional<TIME_FORMAT> const parsed = parse_format(value);
+    if (!parsed.has_value()) {
+        cout_logger.log(LOG_LEVEL::WARN, "Ignoring invalid ", TIME_FORMAT_VAR, ": ", value);
+        return TIME_FORMAT::HUMAN;
+    }
+    return parsed.value();
+}
+
+auto job_time::to_usec(timeval const& time) -> long {
+    return time.tv_sec * USEC_PER_SEC + time.tv_usec;
+}
+
+auto job_time::difference(rusage const& after, rusage const& before) -> rusage {
+    rusage usage{};
+    timersub(&after.ru_utime, &before.ru_utime, &usage.ru_utime);
+    timersub(&after.ru_stime, &before.ru_stime, &usage.ru_stime);
+    usage.ru_maxrss = after.ru_maxrss;
+    usage.ru_nvcsw = after.ru_nvcsw - before.ru_nvcsw;
+    usage.ru_nivcsw = after.ru_nivcsw - before.ru_nivcsw;
+    usage.ru_inblock = after.ru_inblock - before.ru_inblock;
+    usage.ru_oublock = after.ru_oublock - before.ru_oublock;
+    return usage;
+}
+
+auto job_time::total(std::vector<stage_usage> const& stages) -> rusage {
+    rusage usage{};
+    for (stage_usage const& stage : stages) {
+        timeradd(&usage.ru_utime, &stage.usage.ru_utime, &usage.ru_utime);
+        timeradd(&usage.ru_stime, &stage.usage.ru_stime, &usage.ru_stime);
+        usage.ru_maxrss = std::max(usage.ru_maxrss, stage.usage.ru_maxrss);
+        usage.ru_nvcsw += stage.usage.ru_nvcsw;
+        usage.ru_nivcsw += stage.usage.ru_nivcsw;
+        usage.ru_inblock += stage.usage.ru_inblock;
+        usage.ru_oublock += stage.usage.ru_oublock;
+    }
+    return usage;
+}
+
+void job_time::print_seconds(long usec, logger& log) {
+    // seconds with millisecond precision, like the time keyword of other shells
+    static constexpr long USEC_PER_MSEC = 1000;
+    static constexpr int MSEC_WIDTH = 3;
+    long const msec = (usec / USEC_PER_MSEC) % USEC_PER_MSEC;
+    std::string msec_str = std::to_string(msec);
+    msec_str.insert(0, MSEC_WIDTH - msec_str.size(), '0');
+    log.log(LOG_LEVEL::SILENT, usec / USEC_PER_SEC, '.', msec_str, 's');
+}
+
+void job_time::print_json_string(std::string_view str, logger& log) {
+    std::string out = "\"";
+    for (char const chr : str) {
+        if (chr == '"' || chr == '\\') {
+            out += '\\';
+            out += chr;
+        } else if (static_cast<unsigned char>(chr) < ' ') {
+            // control characters are written as unicode escapes
+            static constexpr std::size_t ESCAPE_SIZE = 7;
+            std::array<char, ESCAPE_SIZE> escape{};
+            std::snprintf(escape.data(), escape.size(), "\\u%04x", static_cast<unsigned int>(chr)); // NOLINT
+            out += escape.data();
+        } else {
+            out += chr;
+        }
+    }
+    out += '"';
+    log.log(LOG_LEVEL::SILENT, out);
+}
+
+void job_time::print_json_usage(rusage const& usage, logger& log) {
+    log.log(LOG_LEVEL::SILENT, "\"user_usec\":", to_usec(usage.ru_utime), ",\"sys_usec\":", to_usec(usage.ru_stime), ",\"max_rss_kib\":", usage.ru_maxrss, ",\"voluntary_ctxsw\":", usage.ru_nvcsw, ",\"involuntary_ctxsw\":", usage.ru_nivcsw, ",\"in_blocks\":", usage.ru_inblock, ",\"out_blocks\":", usage.ru_oublock);
+}
+
+void job_time::report(std::string_view command, std::chrono::nanoseconds wall, int status, std::vector<stage_usage> const& stages, TIME_FORMAT format, [[maybe_unused]] logger& log) {
+    rusage const usage = total(stages);
+    long const real_usec = std::chrono::duration_cast<std::chrono::microseconds>(wall).count();
+
+    if (format == TIME_FORMAT::JSON) {
+        // one object per line, so a whole session can be collected with a line oriented reader
+        log.log(LOG_LEVEL::SILENT, "{\"command\":");
+        print_json_string(command, log);
+        log.log(LOG_LEVEL::SILENT, ",\"status\":", status, ",\"real_usec\":", real_usec, ',');
+        print_json_usage(usage, log);
+        log.log(LOG_LEVEL::SILENT, ",\"stages\":[");
+        for (std::size_t i = 0; i < stages.size(); ++i) {
+            log.log(LOG_LEVEL::SILENT, i == 0 ? "{" : ",{", "\"stage\":", stages[i].stage, ",\"command\":");
+            print_json_string(stages[i].command, log);
+            log.log(LOG_LEVEL::SILENT, ",\"pid\":", stages[i].pid, ",\"status\":", stages[i].status, ',');
+            print_json_usage(stages[i].usage, log);
+            log.log(LOG_LEVEL::SILENT, '}');
+        }
+        log.log(LOG_LEVEL::SILENT, "]}\n");
+        return;
+    }
+
+    // the totals first, then one row per stage
+    log.log(LOG_LEVEL::SILENT, "\nreal\t");
+    print_seconds(real_usec, log);
+    log.log(LOG_LEVEL::SILENT, "\nuser\t");
+    print_seconds(to_usec(usage.ru_utime), log);
+    log.log(LOG_LEVEL::SILENT, "\nsys\t");
+    print_seconds(to_usec(usage.ru_stime), log);
+    log.log(LOG_LEVEL::SILENT, "\nmaxrss\t", usage.ru_maxrss, " KiB\nctxsw\t", usage.ru_nvcsw, " voluntary, ", usage.ru_nivcsw, " involuntary\nblocks\t", usage.ru_inblock, " in, ", usage.ru_oublock, " out\n");
+
+    log.log(LOG_LEVEL::SILENT, "\nstage\tpid\tstatus\tuser\tsys\tmaxrss\tvcsw\tivcsw\tin\tout\tcommand\n");
+    for (stage_usage const& stage : stages) {
+        log.log(LOG_LEVEL::SILENT, stage.stage, '\t', stage.pid, '\t', stage.status, '\t');
+        print_seconds(to_usec(stage.usage.ru_utime), log);
+        log.log(LOG_LEVEL::SILENT, '\t');
+        print_seconds(to_usec(stage.usage.ru_stime), log);
+        log.log(LOG_LEVEL::SILENT, '\t', stage.usage.ru_maxrss, '\t', stage.usage.ru_nvcsw, '\t', stage.usage.ru_nivcsw, '\t', stage.usage.ru_inblock, '\t', stage.usage.ru_oublock, '\t', stage.command, '\n');
+    }
+}
+} // namespace jsh
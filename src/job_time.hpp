@@ -0,0 +1,121 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "environment.hpp"
+#include "macros.hpp"
+
+namespace jsh {
+/**
+ * TIME_FORMAT: how the resources used by a timed job are reported
+ *
+ * HUMAN: a table for reading at the prompt
+ *
+ * JSON: a single line JSON object per job for collecting in bulk
+ */
+enum class TIME_FORMAT : char {
+    HUMAN = 0,
+    JSON = 1,
+    COUNT = 2
+};
+
+/**
+ * structure describing the resources used by one stage of a timed job
+ *
+ * stage: the index of the process in the job
+ *
+ * command: the command the stage ran
+ *
+ * pid: the pid of the stage, -1 for a shell internal which ran inside of the shell
+ *
+ * status: the exit status of the stage
+ *
+ * usage: the rusage reported by wait4, or measured around the shell internal
+ */
+struct stage_usage {
+    std::size_t stage = 0;
+    std::string command;
+    pid_t pid = -1;
+    int status = -1;
+    rusage usage{};
+};
+
+/**
+ * job_time: reports the wall time and rusage of jobs run with the time keyword
+ *
+ * NOTES: a stage's rusage from wait4 includes every descendant it waited on, so a stage which is itself a shell script accounts for its children
+ */
+class job_time {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr std::string_view HUMAN_STR = "human";
+    static constexpr std::string_view JSON_STR = "json";
+    static constexpr long USEC_PER_SEC = 1000000;
+
+    /**
+     * to_usec: converts a timeval into microseconds
+     */
+    [[nodiscard]] static auto to_usec(timeval const& time) -> long;
+
+    /**
+     * print_seconds: prints microseconds as seconds with millisecond precision
+     */
+    static void print_seconds(long usec, logger& log);
+
+    /**
+     * print_json_string: prints a string as a quoted JSON string
+     */
+    static void print_json_string(std::string_view str, logger& log);
+
+    /**
+     * print_json_usage: prints the members of a JSON object describing the rusage
+     */
+    static void print_json_usage(rusage const& usage, logger& log);
+
+  public:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* TIME_FORMAT_VAR = "JSH_TIME_FORMAT";
+
+    /**
+     * parse_format: parses human or json
+     *
+     * returns std::nullopt if the value is not understood
+     */
+    [[nodiscard]] static auto parse_format(std::string_view value) -> std::optional<TIME_FORMAT>;
+
+    /**
+     * format: the format selected through JSH_TIME_FORMAT, human if it is unset or invalid
+     */
+    [[nodiscard]] static auto format() -> TIME_FORMAT;
+
+    /**
+     * difference: the resources used between two getrusage calls, the max RSS is a high water mark so it is taken as is
+     */
+    [[nodiscard]] static auto difference(rusage const& after, rusage const& before) -> rusage;
+
+    /**
+     * total: the resources used by every stage together, the max RSS is the largest of any stage
+     */
+    [[nodiscard]] static auto total(std::vector<stage_usage> const& stages) -> rusage;
+
+    /**
+     * report: prints the resources used by a job
+     *
+     * command: the command line of the job
+     *
+     * wall: the wall time the job took, measured on CLOCK_MONOTONIC
+     *
+     * status: the exit status of the job
+     *
+     * stages: the resources used by every stage which ran
+     *
+     * format: how the report is printed
+     */
+    static void report(std::string_view command, std::chrono::nanoseconds wall, int status, std::vector<stage_usage> const& stages, TIME_FORMAT format, [[maybe_unused]] logger& log = cerr_logger);
+};
+} // namespace jsh
@@ -0,0 +1,100 @@
+#include "lexer.hpp"
+
+namespace jsh {
+auto lexer::lex_operator(std::string_view rest) -> token {
+    assert(!rest.empty());
+
+    bool const doubled = rest.size() > 1 && rest[1] == rest[0];
+    switch (rest[0]) {
+    case '|': {
+        return doubled ? token{.kind = TOKEN_KIND::OR, .text = rest.substr(0, 2), .value = {}} : token{.kind = TOKEN_KIND::PIPE, .text = rest.substr(0, 1), .value = {}};
+    }
+    case '&': {
+        return doubled ? token{.kind = TOKEN_KIND::AND, .text = rest.substr(0, 2), .value = {}} : token{.kind = TOKEN_KIND::BACKGROUND, .text = rest.substr(0, 1), .value = {}};
+    }
+    case ';': {
+        return token{.kind = TOKEN_KIND::SEQUENCE, .text = rest.substr(0, 1), .value = {}};
+    }
+    case '<': {
+        return token{.kind = TOKEN_KIND::INPUT_REDIRECTION, .text = rest.substr(0, 1), .value = {}};
+    }
+    default: {
+        // the table only sends the operator characters here
+        assert(rest[0] == '>');
+        return token{.kind = TOKEN_KIND::OUTPUT_REDIRECTION, .text = rest.substr(0, 1), .value = {}};
+    }
+    }
+}
+
+auto lexer::lex(std::string_view line) -> token_stream {
+    token_stream stream;
+
+    // no value is longer than the line, so reserving it up front means the views into values never move
+    stream.values.reserve(line.size());
+
+    LEX_STATE state = BETWEEN;
+    std::size_t word_start = 0;
+    std::size_t value_start = 0;
+    bool quoted = false;
+
+    auto const end_word = [&](std::size_t end) {
+        std::string_view const text = line.substr(word_start, end - word_start);
+        std::string_view const value = quoted ? std::string_view(stream.values.data() + value_start, stream.values.size() - value_start) : text; // NOLINT the values were reserved
+        stream.tokens.push_back(token{.kind = TOKEN_KIND::WORD, .text = text, .value = value});
+    };
+
+    for (std::size_t idx = 0; idx < line.size(); ++idx) {
+        // inside of a word or quotes the only characters which matter are the ones which end the run, everything up to them is content
+        if (state == WORD || state == SINGLE || state == DOUBLE) {
+            metachar_set const& stops = state == WORD ? WORD_STOPS : state == SINGLE ? SINGLE_STOPS : DOUBLE_STOPS;
+            std::size_t const run_end = metachar_scan::find(line, idx, stops);
+            if (quoted) {
+                stream.values.insert(std::end(stream.values), line.data() + idx, line.data() + run_end); // NOLINT run_end is in the line
+            }
+            idx = run_end;
+            if (idx == line.size()) {
+                break;
+            }
+        }
+
+        char const chr = line[idx];
+        CHAR_CLASS const cls = CHAR_CLASSES[static_cast<unsigned char>(chr)];
+        LEX_STATE const next = TRANSITIONS[state][cls];
+
+        // a word starts on the first character which is not whitespace or an operator
+        if (state == BETWEEN && next != BETWEEN) {
+            word_start = idx;
+            quoted = false;
+        }
+
+        // the first quote or backslash of a word starts copying its value, along with everything before it
+        if (!quoted && next != BETWEEN && !CONTENT[state][cls]) {
+            quoted = true;
+            value_start = stream.values.size();
+            stream.values.insert(std::end(stream.values), line.data() + word_start, line.data() + idx); // NOLINT idx is in the line
+        }
+        if (quoted && CONTENT[state][cls]) {
+            stream.values.push_back(chr);
+        }
+
+        // whitespace or an operator ends the word, an operator is its own token
+        if (state != BETWEEN && next == BETWEEN) {
+            end_word(idx);
+        }
+        if (next == BETWEEN && cls == OPERATOR) {
+            stream.tokens.push_back(lex_operator(line.substr(idx)));
+            idx += stream.tokens.back().text.size() - 1;
+        }
+
+        state = next;
+    }
+
+    // the last word ends with the line, unless a quote or backslash was left open
+    if (state == WORD) {
+        end_word(line.size());
+    } else if (state != BETWEEN) {
+        stream.error = true;
+    }
+    return stream;
+}
+} // namespace jsh
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "macros.hpp"
+#include "metachar_scan.hpp"
+
+namespace jsh {
+/**
+ * TOKEN_KIND: what a token of a command line is
+ */
+enum class TOKEN_KIND : char {
+    WORD = 0,
+    AND = 1,
+    PIPE = 2,
+    OR = 3,
+    SEQUENCE = 4,
+    BACKGROUND = 5,
+    INPUT_REDIRECTION = 6,
+    OUTPUT_REDIRECTION = 7,
+    COUNT = 8
+};
+
+/**
+ * token: one word or operator of a command line
+ *
+ * text: the token as it was typed, quotes and backslashes included
+ *
+ * value: a word with its quotes and backslashes removed, which is text itself for a word without any
+ */
+struct token {
+    TOKEN_KIND kind;
+    std::string_view text;
+    std::string_view value;
+};
+
+/**
+ * token_stream: every token of a command line
+ *
+ * NOTES: the tokens point into the line they were lexed from, which has to outlive them, and into values, which holds the words which needed their quotes removed
+ */
+struct token_stream {
+    /**
+     * tokens: the tokens in the order they were typed
+     */
+    std::vector<token> tokens;
+
+    /**
+     * values: the unquoted words back to back, a vector so moving the stream never moves them
+     */
+    std::vector<char> values;
+
+    /**
+     * error: set if the line ends inside of a quote or after a backslash
+     */
+    bool error = false;
+};
+
+/**
+ * lexer: splits a command line into words and operators in a single pass driven by a character class table and a state transition table
+ *
+ * NOTES: quotes and backslashes are tracked inline, so an operator or whitespace inside of quotes is part of the word, a backslash escapes the next character inside of quotes as well
+ */
+class lexer {
+  private:
+    /**
+     * CHAR_CLASS: how the lexer treats a character
+     */
+    enum CHAR_CLASS : char {
+        ORDINARY = 0,
+        SPACE = 1,
+        SINGLE_QUOTE = 2,
+        DOUBLE_QUOTE = 3,
+        ESCAPE = 4,
+        OPERATOR = 5,
+        CHAR_CLASS_COUNT = 6
+    };
+
+    /**
+     * LEX_STATE: where in the line the lexer is
+     *
+     * BETWEEN: between tokens
+     *
+     * WORD: inside of a word, outside of quotes
+     *
+     * SINGLE, DOUBLE: inside of single or double quotes
+     *
+     * ESCAPED, SINGLE_ESCAPED, DOUBLE_ESCAPED: after a backslash, outside of quotes or inside of single or double quotes
+     */
+    enum LEX_STATE : char {
+        BETWEEN = 0,
+        WORD = 1,
+        SINGLE = 2,
+        DOUBLE = 3,
+        ESCAPED = 4,
+        SINGLE_ESCAPED = 5,
+        DOUBLE_ESCAPED = 6,
+        LEX_STATE_COUNT = 7
+    };
+
+    /**
+     * CHAR_CLASSES: the class of every byte
+     */
+    static constexpr std::array<CHAR_CLASS, UCHAR_MAX + 1> CHAR_CLASSES = [] {
+        std::array<CHAR_CLASS, UCHAR_MAX + 1> classes{};
+        for (char const chr : std::string_view(" \t\n\v\f\r")) {
+            classes[static_cast<unsigned char>(chr)] = SPACE;
+        }
+        for (char const chr : std::string_view("|&;<>")) {
+            classes[static_cast<unsigned char>(chr)] = OPERATOR;
+        }
+        classes['\''] = SINGLE_QUOTE;
+        classes['\"'] = DOUBLE_QUOTE;
+        classes['\\'] = ESCAPE;
+        return classes;
+    }();
+
+    /**
+     * TRANSITIONS: the state the lexer moves to from each state on each class of character, a word ends when it moves back to BETWEEN
+     */
+    static constexpr std::array<std::array<LEX_STATE, CHAR_CLASS_COUNT>, LEX_STATE_COUNT> TRANSITIONS = {{
+        // ORDINARY  SPACE    SINGLE_QUOTE DOUBLE_QUOTE ESCAPE          OPERATOR
+        {WORD, BETWEEN, SINGLE, DOUBLE, ESCAPED, BETWEEN},                                          // BETWEEN
+        {WORD, BETWEEN, SINGLE, DOUBLE, ESCAPED, BETWEEN},                                          // WORD
+        {SINGLE, SINGLE, WORD, SINGLE, SINGLE_ESCAPED, SINGLE},                                     // SINGLE
+        {DOUBLE, DOUBLE, DOUBLE, WORD, DOUBLE_ESCAPED, DOUBLE},                                     // DOUBLE
+        {WORD, WORD, WORD, WORD, WORD, WORD},                                                       // ESCAPED
+        {SINGLE, SINGLE, SINGLE, SINGLE, SINGLE, SINGLE},                                           // SINGLE_ESCAPED
+        {DOUBLE, DOUBLE, DOUBLE, DOUBLE, DOUBLE, DOUBLE},                                           // DOUBLE_ESCAPED
+    }};
+
+    /**
+     * CONTENT: whether a character of each class is part of the word's value in each state, quotes and backslashes which are doing their job are not
+     */
+    static constexpr std::array<std::array<bool, CHAR_CLASS_COUNT>, LEX_STATE_COUNT> CONTENT = {{
+        // ORDINARY SPACE SINGLE_QUOTE DOUBLE_QUOTE ESCAPE OPERATOR
+        {true, false, false, false, false, false}, // BETWEEN
+        {true, false, false, false, false, false}, // WORD
+        {true, true, false, true, false, true},    // SINGLE
+        {true, true, true, false, false, true},    // DOUBLE
+        {true, true, true, true, true, true},      // ESCAPED
+        {true, true, true, true, true, true},      // SINGLE_ESCAPED
+        {true, true, true, true, true, true},      // DOUBLE_ESCAPED
+    }};
+
+    /**
+     * WORD_STOPS, SINGLE_STOPS, DOUBLE_STOPS: the characters which can end a run inside of a word, single quotes, or double quotes, everything else is content which the lexer skips over with the vector kernels
+     */
+    static constexpr metachar_set WORD_STOPS{" \t\n\v\f\r|&;<>'\"\\"};
+    static constexpr metachar_set SINGLE_STOPS{"'\\"};
+    static constexpr metachar_set DOUBLE_STOPS{"\"\\"};
+
+    // a character missing from WORD_STOPS would be skipped over without changing the state
+    static_assert([] {
+        for (std::size_t chr = 0; chr <= UCHAR_MAX; ++chr) {
+            if ((CHAR_CLASSES[chr] == ORDINARY) == WORD_STOPS.members[chr]) {
+                return false;
+            }
+        }
+        return true;
+    }());
+
+    /**
+     * lex_operator: the operator starting at the front of rest, the longest one wins so || is never two pipes
+     */
+    [[nodiscard]] static auto lex_operator(std::string_view rest) -> token;
+
+  public:
+    /**
+     * lex: splits line into tokens, without copying any word which has no quotes or backslashes in it
+     */
+    [[nodiscard]] static auto lex(std::string_view line) -> token_stream;
+
+    /**
+     * is_operator: whether kind joins two commands (&&, |, ||, ;) rather than being part of one
+     */
+    [[nodiscard]] static constexpr auto is_operator(TOKEN_KIND kind) -> bool {
+        return kind == TOKEN_KIND::AND || kind == TOKEN_KIND::PIPE || kind == TOKEN_KIND::OR || kind == TOKEN_KIND::SEQUENCE;
+    }
+};
+} // namespace jsh
@@ -0,0 +1,164 @@
+#include "line_editor.hpp"
+
+namespace jsh {
+void line_editor::erase_last(std::string& echo) {
+    if (line.empty()) {
+        return;
+    }
+
+    // continuation bytes of a UTF-8 sequence go along with the byte which started it
+    static constexpr unsigned char CONTINUATION_MASK = 0xC0;
+    static constexpr unsigned char CONTINUATION = 0x80;
+    while (line.size() > 1 && (static_cast<unsigned char>(line.back()) & CONTINUATION_MASK) == CONTINUATION) {
+        line.pop_back();
+    }
+    line.pop_back();
+    echo += ERASE;
+}
+
+void line_editor::complete(std::string& echo) {
+    // without a completer a tab is kept as whitespace
+    if (!complete_word) {
+        line += TAB;
+        echo += TAB;
+        return;
+    }
+
+    completion_result const result = complete_word(line);
+    if (!result.suffix.empty()) {
+        line += result.suffix;
+        echo += result.suffix;
+        return;
+    }
+
+    // the user has to pick between the candidates, so they are listed and the line is shown again under them
+    if (result.candidates.size() < 2) {
+        return;
+    }
+    echo += '\n';
+    for (std::string const& candidate : result.candidates) {
+        echo += candidate;
+        echo += "  ";
+    }
+    if (result.total > result.candidates.size()) {
+        echo += "... (" + std::to_string(result.total - result.candidates.size()) + " more)";
+    }
+    echo += '\n';
+    echo += prompt;
+    echo += line;
+}
+
+void line_editor::set_completer(completer complete_word, std::string prompt) {
+    this->complete_word = std::move(complete_word);
+    this->prompt = std::move(prompt);
+}
+
+void line_editor::feed(std::string_view input, std::string& echo) {
+    for (char const chr : input) {
+        // a newline right after a carriage return ends the same line
+        bool const continues_return = after_return && chr == '\n';
+        after_return = chr == '\r';
+        if (continues_return) {
+            continue;
+        }
+
+        // escape sequences such as the arrow keys are not supported, so they are dropped whole
+        if (escape == ESCAPE_STATE::STARTED) {
+            escape = chr == '[' || chr == 'O' ? ESCAPE_STATE::PARAMETERS : ESCAPE_STATE::NONE;
+            continue;
+        }
+        if (escape == ESCAPE_STATE::PARAMETERS) {
+            if (static_cast<bool>(std::isalpha(static_cast<unsigned char>(chr))) || chr == '~') {
+                escape = ESCAPE_STATE::NONE;
+            }
+            continue;
+        }
+
+        switch (chr) {
+        case '\r':
+        case '\n': {
+            lines.push_back(std::move(line));
+            line.clear();
+            echo += '\n';
+            break;
+        }
+        case BACKSPACE:
+        case DELETE: {
+            erase_last(echo);
+            break;
+        }
+        case KILL_LINE: {
+            while (!line.empty()) {
+                erase_last(echo);
+            }
+            break;
+        }
+        case END_OF_FILE: {
+            // ctrl+d only means end of file on an empty line
+            if (line.empty()) {
+                closed = true;
+            }
+            break;
+        }
+        case ESCAPE: {
+            escape = ESCAPE_STATE::STARTED;
+            break;
+        }
+        case TAB: {
+            complete(echo);
+            break;
+        }
+        default: {
+            // every other control character is ignored
+            if (static_cast<unsigned char>(chr) < ' ') {
+                break;
+            }
+            line += chr;
+            echo += chr;
+            break;
+        }
+        }
+    }
+}
+
+auto line_editor::read(file_descriptor_wrapper const& fides, bool echo) -> bool {
+    chunk.resize(CHUNK_SIZE);
+    std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(fides, chunk.data(), chunk.size());
+    if (!num_read.has_value() || num_read.value() == 0) {
+        closed = true;
+        return false;
+    }
+
+    std::string shown;
+    feed(std::string_view(chunk.data(), static_cast<std::size_t>(num_read.value())), shown);
+
+    // the whole chunk is echoed with a single write
+    if (echo && !shown.empty()) {
+        cout_logger.log(LOG_LEVEL::SILENT, shown);
+    }
+    return true;
+}
+
+auto line_editor::next_line() -> std::optional<std::string> {
+    if (lines.empty()) {
+        return std::nullopt;
+    }
+
+    std::string next = std::move(lines.front());
+    lines.pop_front();
+    return std::make_optional<std::string>(std::move(next));
+}
+
+auto line_editor::buffered() const -> bool {
+    return !lines.empty();
+}
+
+auto line_editor::is_closed() const -> bool {
+    return closed;
+}
+
+void line_editor::discard() {
+    line.clear();
+    escape = ESCAPE_STATE::NONE;
+}
+} // namespace jsh
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * completion_result: what a tab completes the line being typed to
+ */
+struct completion_result {
+    /**
+     * suffix: appended to the line, empty if the candidates have nothing more in common
+     */
+    std::string suffix;
+
+    /**
+     * candidates: the first of the words the line could be completed to, in order
+     */
+    std::vector<std::string> candidates;
+
+    /**
+     * total: how many words the line could be completed to, which may be more than were handed back
+     */
+    std::size_t total = 0;
+};
+
+/**
+ * completer: completes the word at the end of line
+ */
+using completer = std::function<completion_result(std::string_view line)>;
+
+/**
+ * line_editor: edits the lines typed at a terminal in raw mode, everything the terminal had ready is read at once and every complete line is queued
+ *
+ * NOTES: a paste of many lines is read in large chunks and handed out one line at a time without going back to the terminal
+ */
+class line_editor {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr std::size_t CHUNK_SIZE = 64UL * 1024UL;
+    static constexpr char END_OF_FILE = '\x04';
+    static constexpr char KILL_LINE = '\x15';
+    static constexpr char BACKSPACE = '\x08';
+    static constexpr char DELETE = '\x7f';
+    static constexpr char ESCAPE = '\x1b';
+    static constexpr char TAB = '\t';
+    static constexpr char const* ERASE = "\b \b";
+
+    /**
+     * ESCAPE_STATE: how far into an escape sequence, such as an arrow key, the input is
+     *
+     * NONE: not in an escape sequence
+     *
+     * STARTED: after the escape character
+     *
+     * PARAMETERS: after a [ or O, the sequence ends with its first letter or ~
+     */
+    enum class ESCAPE_STATE : char {
+        NONE = 0,
+        STARTED = 1,
+        PARAMETERS = 2,
+        COUNT = 3
+    };
+
+    /**
+     * line: the line being typed
+     */
+    std::string line;
+
+    /**
+     * lines: complete lines which have not been handed out yet
+     */
+    std::deque<std::string> lines;
+
+    /**
+     * chunk: the buffer reads land in, kept between reads so reading never allocates
+     */
+    std::string chunk;
+
+    /**
+     * escape: the escape sequence state carried over between reads
+     */
+    ESCAPE_STATE escape = ESCAPE_STATE::NONE;
+
+    /**
+     * after_return: a carriage return was just read, so a newline right after it belongs to the same line
+     */
+    bool after_return = false;
+
+    /**
+     * complete_word: completes the word being typed at a tab, empty if tabs are kept as whitespace
+     */
+    completer complete_word;
+
+    /**
+     * prompt: shown again after the candidates of a completion are listed
+     */
+    std::string prompt;
+
+    /**
+     * closed: end of file was read, either ctrl+d on an empty line or the terminal going away
+     */
+    bool closed = false;
+
+    /**
+     * erase_last: removes the last character, along with the rest of its UTF-8 sequence, from the line being typed
+     */
+    void erase_last(std::string& echo);
+
+    /**
+     * complete: completes the word at the end of the line being typed, listing the candidates when there is nothing to add
+     */
+    void complete(std::string& echo);
+
+  public:
+    /**
+     * set_completer: completes the word being typed with complete_word whenever tab is pressed, prompt is reprinted under the list of candidates
+     */
+    void set_completer(completer complete_word, std::string prompt);
+
+    /**
+     * feed: edits input into the line being typed and queues every line it completes
+     *
+     * echo: what the terminal should show for the input, since raw mode does not echo
+     */
+    void feed(std::string_view input, std::string& echo);
+
+    /**
+     * read: reads everything fides has ready, at most one chunk, and feeds it
+     *
+     * echo: whether the input is echoed back to fides, which is only done when the terminal is in raw mode
+     *
+     * returns false once there is nothing more to read
+     */
+    [[nodiscard]] auto read(file_descriptor_wrapper const& fides, bool echo) -> bool;
+
+    /**
+     * next_line: hands out the oldest complete line
+     *
+     * returns std::nullopt if no line is complete
+     */
+    [[nodiscard]] auto next_line() -> std::optional<std::string>;
+
+    /**
+     * buffered: whether a complete line can be handed out without reading
+     */
+    [[nodiscard]] auto buffered() const -> bool;
+
+    /**
+     * is_closed: whether end of file was read
+     */
+    [[nodiscard]] auto is_closed() const -> bool;
+
+    /**
+     * discard: throws away the line being typed, for ctrl+c
+     */
+    void discard();
+};
+} // namespace jsh
@@ -0,0 +1,76 @@
+#include "line_reader.hpp"
+
+namespace jsh {
+auto line_reader::from_string(std::string text) -> line_reader {
+    line_reader reader;
+    reader.buffer = std::move(text);
+    reader.eof = true;
+    return reader;
+}
+
+auto line_reader::from_file(std::string const& path) -> std::optional<line_reader> {
+    std::optional<file_descriptor_wrapper> file = syscall_wrapper::open_wrapper(path, O_RDONLY | O_CLOEXEC, 0);
+    if (!file.has_value()) {
+        return std::nullopt;
+    }
+
+    line_reader reader;
+    reader.file = std::move(file);
+    return std::make_optional<line_reader>(std::move(reader));
+}
+
+auto line_reader::fides() const -> file_descriptor_wrapper const& {
+    return file.has_value() ? file.value() : syscall_wrapper::stdin_file_descriptor;
+}
+
+auto line_reader::fill() -> bool {
+    if (eof) {
+        return false;
+    }
+
+    // drop the lines already handed out before growing the buffer
+    buffer.erase(0, offset);
+    offset = 0;
+
+    std::size_t const size = buffer.size();
+    buffer.resize(size + CHUNK_SIZE);
+    std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(fides(), buffer.data() + size, CHUNK_SIZE); // NOLINT the buffer was just grown
+    buffer.resize(size + static_cast<std::size_t>(std::max<ssize_t>(num_read.value_or(0), 0)));
+
+    // a failed read ends the input just like the end of the file does
+    eof = !num_read.has_value() || num_read.value() == 0;
+    return !eof;
+}
+
+auto line_reader::next_line() -> std::optional<std::string> {
+    // the part of a long line which was already searched is not searched again after every chunk
+    std::size_t scanned = offset;
+    while (true) {
+        // hand out a whole line if one is buffered
+        std::size_t const newline = buffer.find('\n', scanned);
+        if (newline != std::string::npos) {
+            std::string line = buffer.substr(offset, newline - offset);
+            offset = newline + 1;
+            return std::make_optional<std::string>(std::move(line));
+        }
+
+        // filling moves the unread input to the front of the buffer
+        scanned = buffer.size() - offset;
+        if (!fill()) {
+            break;
+        }
+    }
+
+    // whatever is left over is the last line
+    if (offset == buffer.size()) {
+        return std::nullopt;
+    }
+    std::string line = buffer.substr(offset);
+    offset = buffer.size();
+    return std::make_optional<std::string>(std::move(line));
+}
+
+auto line_reader::buffered() const -> bool {
+    return buffer.find('\n', offset) != std::string::npos;
+}
+} // namespace jsh
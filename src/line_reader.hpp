@@ -0,0 +1,78 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * line_reader: splits its input into lines, reading the file descriptor behind it in large chunks rather than a line at a time
+ */
+class line_reader {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr std::size_t CHUNK_SIZE = 64UL * 1024UL;
+
+    /**
+     * file: the file being read, standard in when it is not set
+     */
+    std::optional<file_descriptor_wrapper> file;
+
+    /**
+     * buffer: input which has been read but not handed out yet, starting at offset
+     */
+    std::string buffer;
+    std::size_t offset = 0;
+
+    /**
+     * eof: set once the file descriptor has nothing more to give
+     */
+    bool eof = false;
+
+    /**
+     * fides: the file descriptor being read
+     */
+    [[nodiscard]] auto fides() const -> file_descriptor_wrapper const&;
+
+    /**
+     * fill: reads one more chunk into the buffer
+     *
+     * returns false once the end of the input is reached or reading failed
+     */
+    [[nodiscard]] auto fill() -> bool;
+
+  public:
+    /**
+     * constructor which reads standard in
+     */
+    line_reader() = default;
+
+    /**
+     * from_string: a reader which hands out the lines of text and never touches a file descriptor
+     */
+    [[nodiscard]] static auto from_string(std::string text) -> line_reader;
+
+    /**
+     * from_file: a reader for the file at path, which is opened close on exec so the commands it runs never see it
+     *
+     * returns std::nullopt if the file could not be opened
+     */
+    [[nodiscard]] static auto from_file(std::string const& path) -> std::optional<line_reader>;
+
+    /**
+     * next_line: the next line without its newline, blocking until a whole line is read, a last line without a newline is still handed out
+     *
+     * returns std::nullopt once the input is exhausted
+     */
+    [[nodiscard]] auto next_line() -> std::optional<std::string>;
+
+    /**
+     * buffered: whether a whole line can be handed out without reading
+     */
+    [[nodiscard]] auto buffered() const -> bool;
+};
+} // namespace jsh
@@ -56,5 +56,6 @@ class logger {
     }
 };
 
-inline static logger cout_logger;
+inline logger cout_logger;
+inline logger cerr_logger(std::cerr);
 }; // namespace jsh
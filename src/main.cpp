@@ -3,10 +3,37 @@
 // JSH
 #include "shell.hpp"
 
-auto main() noexcept -> int {
+auto main(int argc, char** argv) noexcept -> int {
     try {
         jsh::set_log_level(jsh::LOG_LEVEL::WARN);
 
+        // jsh -c 'command' runs a single line
+        std::vector<std::string_view> const args(argv, argv + argc); // NOLINT argv is argc long
+        if (args.size() > 1 && args[1] == jsh::shell::COMMAND_FLAG) {
+            if (args.size() < 3) {
+                jsh::cout_logger.log(jsh::LOG_LEVEL::ERROR, "usage: jsh [-c command | script]");
+                return jsh::shell::USAGE_STATUS;
+            }
+
+            jsh::line_reader reader = jsh::line_reader::from_string(std::string(args[2]));
+            return jsh::shell::run_script(reader);
+        }
+
+        // jsh script runs every line of the file
+        if (args.size() > 1) {
+            std::optional<jsh::line_reader> reader = jsh::line_reader::from_file(std::string(args[1]));
+            if (!reader.has_value()) {
+                return jsh::process::COMMAND_NOT_FOUND_STATUS;
+            }
+            return jsh::shell::run_script(reader.value());
+        }
+
+        // anything other than a terminal on standard in is a script
+        if (!jsh::syscall_wrapper::isatty_wrapper(jsh::syscall_wrapper::stdin_file_descriptor)) {
+            jsh::line_reader reader;
+            return jsh::shell::run_script(reader);
+        }
+
         jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, "Welcome to John's Shell\n");
 
         // this can throw an exception so it must be wrapped in a try and catch
@@ -0,0 +1,159 @@
+#include "metachar_scan.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSH_X86 1
+#endif
+
+namespace jsh {
+metachar_scan::scan_function metachar_scan::active = &metachar_scan::resolve;
+
+auto metachar_scan::scan_scalar(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+    while (pos < text.size() && !set.contains(text[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+#ifdef JSH_X86
+__attribute__((target("sse2"))) auto metachar_scan::scan_sse2(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+    static constexpr std::size_t WIDTH = sizeof(__m128i);
+
+    // every character of the set in every lane
+    alignas(WIDTH) __m128i needles[metachar_set::MAX_CHARS]; // NOLINT only the first size are read, std::array drops the vector type's alignment
+    for (std::size_t i = 0; i < set.size; ++i) {
+        needles[i] = _mm_set1_epi8(set.chars[i]); // NOLINT size is at most MAX_CHARS
+    }
+
+    // compare a block against each character of the set, most blocks of a long argument list match none of them
+    for (; pos + WIDTH <= text.size(); pos += WIDTH) {
+        __m128i const block = _mm_loadu_si128(reinterpret_cast<__m128i const*>(text.data() + pos)); // NOLINT unaligned load of the block
+        __m128i hits = _mm_setzero_si128();
+        for (std::size_t i = 0; i < set.size; ++i) {
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[i])); // NOLINT size is at most MAX_CHARS
+        }
+
+        auto const mask = static_cast<unsigned int>(_mm_movemask_epi8(hits));
+        if (mask != 0) {
+            return pos + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+    }
+
+    // the tail is shorter than a block
+    return scan_scalar(text, pos, set);
+}
+
+__attribute__((target("avx2"))) auto metachar_scan::scan_avx2(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+    static constexpr std::size_t WIDTH = sizeof(__m256i);
+    static constexpr int NIBBLE_BITS = 4;
+
+    // sets spread over more than 8 high nibbles fall back to comparing against each character
+    if (!set.nibble_lookup) {
+        return scan_sse2(text, pos, set);
+    }
+
+    // the nibble tables in both lanes, vpshufb looks up each lane separately
+    __m256i const low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(set.low_nibbles.data())));   // NOLINT unaligned load of the table
+    __m256i const high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(set.high_nibbles.data()))); // NOLINT unaligned load of the table
+    __m256i const nibble_mask = _mm256_set1_epi8(0x0f);
+
+    // a byte is in the set if its low and high nibble entries share a bit, the nibbles are masked so vpshufb never sees an index with the top bit set
+    for (; pos + WIDTH <= text.size(); pos += WIDTH) {
+        __m256i const block = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(text.data() + pos)); // NOLINT unaligned load of the block
+        __m256i const low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(block, nibble_mask));
+        __m256i const high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(block, NIBBLE_BITS), nibble_mask));
+        __m256i const misses = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+
+        auto const mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(misses));
+        if (mask != 0) {
+            return pos + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+    }
+
+    // the tail is shorter than a block
+    return scan_scalar(text, pos, set);
+}
+#else
+auto metachar_scan::scan_sse2(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+    return scan_scalar(text, pos, set);
+}
+
+auto metachar_scan::scan_avx2(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+    return scan_scalar(text, pos, set);
+}
+#endif
+
+auto metachar_scan::supported(KERNEL kernel) -> bool {
+    switch (kernel) {
+    case KERNEL::SCALAR: {
+        return true;
+    }
+#ifdef JSH_X86
+    case KERNEL::SSE2: {
+        return static_cast<bool>(__builtin_cpu_supports("sse2"));
+    }
+    case KERNEL::AVX2: {
+        return static_cast<bool>(__builtin_cpu_supports("avx2"));
+    }
+#endif
+    default: {
+        return false;
+    }
+    }
+}
+
+auto metachar_scan::function(KERNEL kernel) -> scan_function {
+    switch (kernel) {
+    case KERNEL::AVX2: {
+        return &scan_avx2;
+    }
+    case KERNEL::SSE2: {
+        return &scan_sse2;
+    }
+    default: {
+        return &scan_scalar;
+    }
+    }
+}
+
+auto metachar_scan::resolve(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+    // the widest kernel the CPU runs
+    KERNEL kernel = KERNEL::SCALAR;
+    if (supported(KERNEL::AVX2)) {
+        kernel = KERNEL::AVX2;
+    } else if (supported(KERNEL::SSE2)) {
+        kernel = KERNEL::SSE2;
+    }
+
+    active = function(kernel);
+    return active(text, pos, set);
+}
+
+auto metachar_scan::scan(KERNEL kernel, std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+    assert(supported(kernel));
+    return function(kernel)(text, pos, set);
+}
+
+auto metachar_scan::kernel() -> KERNEL {
+    // find has not been called yet, so resolve picks the kernel now
+    if (active == &resolve) {
+        static_cast<void>(resolve({}, 0, metachar_set{""}));
+    }
+
+    if (active == &scan_avx2) {
+        return KERNEL::AVX2;
+    }
+    if (active == &scan_sse2) {
+        return KERNEL::SSE2;
+    }
+    return KERNEL::SCALAR;
+}
+
+auto metachar_scan::set_kernel(KERNEL kernel) -> bool {
+    if (!supported(kernel)) {
+        return false;
+    }
+    active = function(kernel);
+    return true;
+}
+} // namespace jsh
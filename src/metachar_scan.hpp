@@ -0,0 +1,160 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "macros.hpp"
+
+namespace jsh {
+/**
+ * metachar_set: a small set of characters the scanning kernels stop at
+ */
+struct metachar_set {
+    /**
+     * CONSTANTS
+     */
+    static constexpr std::size_t MAX_CHARS = 16;
+    static constexpr std::size_t NIBBLES = 16;
+
+    /**
+     * chars: the characters of the set, which the vector kernels compare every byte against
+     */
+    std::array<char, MAX_CHARS> chars{};
+
+    /**
+     * size: how many of chars are in the set
+     */
+    std::size_t size = 0;
+
+    /**
+     * members: whether each byte is in the set, for the scalar kernel and the tail of the vector ones
+     */
+    std::array<bool, UCHAR_MAX + 1> members{};
+
+    /**
+     * low_nibbles, high_nibbles: a byte is in the set if the entries for its low and high nibble share a bit, which lets the AVX2 kernel classify 32 bytes with two shuffles
+     */
+    std::array<unsigned char, NIBBLES> low_nibbles{};
+    std::array<unsigned char, NIBBLES> high_nibbles{};
+
+    /**
+     * nibble_lookup: whether the nibble tables describe the set exactly, which needs the set's bytes to have at most 8 distinct high nibbles
+     */
+    bool nibble_lookup = true;
+
+    constexpr explicit metachar_set(std::string_view set) {
+        assert(set.size() <= MAX_CHARS);
+        for (char const chr : set) {
+            chars[size++] = chr; // NOLINT size is checked above
+            members[static_cast<unsigned char>(chr)] = true;
+        }
+
+        // every distinct high nibble gets a bit, and each low nibble holds the bits of the high nibbles it appears with
+        std::size_t bits = 0;
+        for (std::size_t high = 0; high < high_nibbles.size(); ++high) {
+            bool used = false;
+            for (std::size_t low = 0; low < low_nibbles.size(); ++low) {
+                used = used || members[high * low_nibbles.size() + low];
+            }
+            if (!used) {
+                continue;
+            }
+            if (bits == CHAR_BIT) {
+                nibble_lookup = false;
+                break;
+            }
+
+            high_nibbles[high] = static_cast<unsigned char>(1U << bits++);
+            for (std::size_t low = 0; low < low_nibbles.size(); ++low) {
+                if (members[high * low_nibbles.size() + low]) {
+                    low_nibbles[low] |= high_nibbles[high];
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr auto contains(char chr) const -> bool {
+        return members[static_cast<unsigned char>(chr)];
+    }
+};
+
+/**
+ * metachar_scan: finds the next shell metacharacter in a line, skipping runs of ordinary characters 16 or 32 bytes at a time
+ *
+ * NOTES: the kernel is picked from what the CPU supports the first time a line is scanned, so starting the shell does not pay for it
+ */
+class metachar_scan {
+  public:
+    /**
+     * KERNEL: how a line is scanned
+     *
+     * SCALAR: one byte at a time through a lookup table
+     *
+     * SSE2: 16 bytes at a time
+     *
+     * AVX2: 32 bytes at a time
+     */
+    enum class KERNEL : char {
+        SCALAR = 0,
+        SSE2 = 1,
+        AVX2 = 2,
+        COUNT = 3
+    };
+
+    static constexpr char const* KERNEL_STR[static_cast<std::size_t>(KERNEL::COUNT)] = {"scalar", "sse2", "avx2"}; // NOLINT
+
+    /**
+     * find: the index of the first character of text at or after pos which is in set, text.size() if there is none
+     */
+    [[nodiscard]] static auto find(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t {
+        return active(text, pos, set);
+    }
+
+    /**
+     * scan: find, with the given kernel rather than the one picked for the CPU
+     *
+     * NOTES: the kernel has to be supported
+     */
+    [[nodiscard]] static auto scan(KERNEL kernel, std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t;
+
+    /**
+     * supported: whether the CPU can run kernel
+     */
+    [[nodiscard]] static auto supported(KERNEL kernel) -> bool;
+
+    /**
+     * kernel: the kernel find is using
+     */
+    [[nodiscard]] static auto kernel() -> KERNEL;
+
+    /**
+     * set_kernel: makes find use kernel, returns false if the CPU cannot run it
+     */
+    static auto set_kernel(KERNEL kernel) -> bool;
+
+  private:
+    using scan_function = std::size_t (*)(std::string_view, std::size_t, metachar_set const&);
+
+    /**
+     * active: the kernel find calls, which starts out as resolve
+     */
+    static scan_function active;
+
+    /**
+     * resolve: picks the widest kernel the CPU supports, then scans with it
+     */
+    static auto resolve(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t;
+
+    /**
+     * kernels: one function per kernel
+     */
+    static auto scan_scalar(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t;
+    static auto scan_sse2(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t;
+    static auto scan_avx2(std::string_view text, std::size_t pos, metachar_set const& set) -> std::size_t;
+
+    /**
+     * function: the function which runs kernel
+     */
+    [[nodiscard]] static auto function(KERNEL kernel) -> scan_function;
+};
+} // namespace jsh
@@ -0,0 +1,447 @@
+#include "parallel.hpp"
+
+namespace jsh {
+work_ranges::work_ranges(std::size_t workers, std::size_t count) : workers{workers} {
+    assert(workers > 0);
+    assert(count <= END_MASK);
+
+    // the cancelled flag sits right after the last range
+    std::optional<void*> const addr = syscall_wrapper::mmap_shared_wrapper((workers + 1) * sizeof(std::atomic<std::uint64_t>));
+    if (!addr.has_value()) {
+        return;
+    }
+    ranges = static_cast<std::atomic<std::uint64_t>*>(addr.value());
+    new (&ranges[workers]) std::atomic<std::uint64_t>(0); // NOLINT placement into the shared mapping
+
+    // every worker starts with an even share, the first ones take the remainder
+    std::size_t next = 0;
+    for (std::size_t worker = 0; worker < workers; ++worker) {
+        std::size_t const share = count / workers + (worker < count % workers ? 1 : 0);
+        new (&ranges[worker]) std::atomic<std::uint64_t>(pack(next, next + share)); // NOLINT placement into the shared mapping
+        next += share;
+    }
+}
+
+work_ranges::~work_ranges() {
+    if (ranges != nullptr) {
+        std::ignore = syscall_wrapper::munmap_wrapper(ranges, (workers + 1) * sizeof(std::atomic<std::uint64_t>));
+    }
+}
+
+auto work_ranges::valid() const -> bool {
+    return ranges != nullptr;
+}
+
+auto work_ranges::pack(std::uint64_t next, std::uint64_t end) -> std::uint64_t {
+    return (next << END_BITS) | end;
+}
+
+auto work_ranges::pop(std::size_t worker) -> std::optional<std::size_t> {
+    std::atomic<std::uint64_t>& range = ranges[worker]; // NOLINT
+    std::uint64_t packed = range.load();
+    while (true) {
+        std::uint64_t const next = packed >> END_BITS;
+        std::uint64_t const end = packed & END_MASK;
+        if (next >= end) {
+            return std::nullopt;
+        }
+
+        // a failed exchange reloads the range, which a thief may have shortened
+        if (range.compare_exchange_weak(packed, pack(next + 1, end))) {
+            return std::make_optional<std::size_t>(next);
+        }
+    }
+}
+
+auto work_ranges::steal(std::size_t worker) -> std::optional<std::size_t> {
+    // look at every other worker once, starting with the next one so thieves spread out
+    for (std::size_t offset = 1; offset < workers; ++offset) {
+        std::atomic<std::uint64_t>& victim = ranges[(worker + offset) % workers]; // NOLINT
+        std::uint64_t packed = victim.load();
+        while (true) {
+            std::uint64_t const next = packed >> END_BITS;
+            std::uint64_t const end = packed & END_MASK;
+            if (next >= end) {
+                break;
+            }
+
+            // take the back half, rounding up so a single command can still be stolen
+            std::uint64_t const half = (end - next + 1) / 2;
+            if (victim.compare_exchange_weak(packed, pack(next, end - half))) {
+                // the worker's own range is empty, so no thief can be racing on it
+                ranges[worker].store(pack(end - half + 1, end)); // NOLINT
+                return std::make_optional<std::size_t>(end - half);
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+auto work_ranges::claim(std::size_t worker) -> std::optional<std::size_t> {
+    assert(worker < workers);
+
+    // a cancelled run hands out nothing more
+    if (ranges[workers].load() != 0) { // NOLINT
+        return std::nullopt;
+    }
+
+    std::optional<std::size_t> idx = pop(worker);
+    if (!idx.has_value()) {
+        idx = steal(worker);
+    }
+    return idx;
+}
+
+void work_ranges::cancel() {
+    ranges[workers].store(1); // NOLINT
+}
+
+auto parallel::parse_args(std::vector<std::string> const& args) -> std::optional<parallel_options> {
+    assert(!args.empty());
+
+    // by default run as many commands as there are CPUs to run them on
+    parallel_options options;
+    std::optional<cpu_set_t> const cpus = syscall_wrapper::sched_getaffinity_wrapper(0);
+    options.jobs = cpus.has_value() ? static_cast<std::size_t>(std::max(CPU_COUNT(&cpus.value()), 1)) : 1;
+
+    // the flags come first, everything after them is the template
+    std::size_t idx = 1;
+    for (; idx < args.size(); ++idx) {
+        std::string_view const arg = args[idx];
+        if (arg == KEEP_ORDER_FLAG) {
+            options.keep_order = true;
+        } else if (arg.starts_with(JOBS_FLAG)) {
+            // both -j N and -jN are accepted
+            std::string_view jobs_str = arg.substr(JOBS_FLAG.size());
+            if (jobs_str.empty()) {
+                if (idx + 1 == args.size()) {
+                    return std::nullopt;
+                }
+                jobs_str = args[++idx];
+            }
+
+            std::size_t jobs = 0;
+            auto [ptr, err] = std::from_chars(jobs_str.data(), jobs_str.data() + jobs_str.size(), jobs);
+            if (err != std::errc{} || ptr != jobs_str.data() + jobs_str.size() || jobs == 0) {
+                return std::nullopt;
+            }
+            options.jobs = jobs;
+        } else {
+            break;
+        }
+    }
+
+    options.command_template.assign(std::begin(args) + static_cast<std::ptrdiff_t>(idx), std::end(args));
+    return std::make_optional<parallel_options>(std::move(options));
+}
+
+auto parallel::read_lines(file_descriptor_wrapper const& fides) -> std::vector<std::string> {
+    std::vector<std::string> lines;
+    std::string line;
+    std::array<char, READ_SIZE> buf{};
+    while (true) {
+        std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(fides, buf.data(), buf.size());
+        if (!num_read.has_value() || num_read.value() == 0) {
+            break;
+        }
+
+        for (char const chr : std::string_view(buf.data(), static_cast<std::size_t>(num_read.value()))) {
+            if (chr != '\n') {
+                line += chr;
+            } else if (!line.empty()) {
+                lines.push_back(std::move(line));
+                line.clear();
+            }
+        }
+    }
+
+    // the last line does not need a newline
+    if (!line.empty()) {
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+auto parallel::expand(std::vector<std::string> const& command_template, std::string const& line) -> std::string {
+    // without a template every line is a command of its own
+    if (command_template.empty()) {
+        return line;
+    }
+
+    // substitute the line for every {}
+    std::string command;
+    bool substituted = false;
+    for (std::string const& word : command_template) {
+        if (!command.empty()) {
+            command += ' ';
+        }
+
+        std::string_view rest = word;
+        for (std::size_t pos = rest.find(PLACEHOLDER); pos != std::string_view::npos; pos = rest.find(PLACEHOLDER)) {
+            command += rest.substr(0, pos);
+            command += line;
+            rest.remove_prefix(pos + PLACEHOLDER.size());
+            substituted = true;
+        }
+        command += rest;
+    }
+
+    // a template without a {} takes the line as its last argument
+    if (!substituted) {
+        command += ' ';
+        command += line;
+    }
+    return command;
+}
+
+auto parallel::read_all(file_descriptor_wrapper const& fides, void* buf, std::size_t count) -> bool {
+    auto* bytes = static_cast<char*>(buf);
+    while (count > 0) {
+        std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(fides, bytes, count);
+        if (!num_read.has_value() || num_read.value() == 0) {
+            return false;
+        }
+        bytes += num_read.value(); // NOLINT
+        count -= static_cast<std::size_t>(num_read.value());
+    }
+    return true;
+}
+
+auto parallel::write_all(file_descriptor_wrapper const& fides, void const* buf, std::size_t count) -> bool {
+    auto const* bytes = static_cast<char const*>(buf);
+    while (count > 0) {
+        std::optional<ssize_t> const num_written = syscall_wrapper::write_wrapper(fides, bytes, count);
+        if (!num_written.has_value()) {
+            return false;
+        }
+        bytes += num_written.value(); // NOLINT
+        count -= static_cast<std::size_t>(num_written.value());
+    }
+    return true;
+}
+
+auto parallel::capture(std::string const& command) -> std::pair<int, std::string> {
+    std::optional<file_descriptor_wrapper> output = syscall_wrapper::memfd_create_wrapper(OUTPUT_NAME);
+    if (!output.has_value() || !syscall_wrapper::dup2_wrapper(output.value(), syscall_wrapper::stdout_file_descriptor)) {
+        return {EXIT_FAILURE, ""};
+    }
+
+    // the command runs as a background job of the worker, so it never touches the terminal
+    std::unique_ptr<job_data> job = job::parse_job(command);
+    job->is_foreground = false;
+    job::execute_job(job);
+
+    // read back everything the command wrote
+    std::string out;
+    if (syscall_wrapper::lseek_wrapper(output.value(), 0, SEEK_SET).has_value()) {
+        std::array<char, READ_SIZE> buf{};
+        while (true) {
+            std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(output.value(), buf.data(), buf.size());
+            if (!num_read.has_value() || num_read.value() == 0) {
+                break;
+            }
+            out.append(buf.data(), static_cast<std::size_t>(num_read.value()));
+        }
+    }
+    int const status = job->status;
+    return {status, std::move(out)};
+}
+
+void parallel::work(work_ranges& ranges, std::size_t worker, std::vector<std::string> const& commands, file_descriptor_wrapper const& results) {
+    // the commands read /dev/null instead of competing for the shell's standard in
+    if (std::optional<file_descriptor_wrapper> const null_device = syscall_wrapper::open_wrapper(NULL_DEVICE, O_RDONLY | O_CLOEXEC, 0); null_device.has_value()) {
+        std::ignore = syscall_wrapper::dup2_wrapper(null_device.value(), syscall_wrapper::stdin_file_descriptor);
+    }
+
+    for (std::optional<std::size_t> idx = ranges.claim(worker); idx.has_value(); idx = ranges.claim(worker)) {
+        auto [status, out] = capture(commands[idx.value()]);
+
+        // each result is sent whole, so the shell never sees half of one
+        result_header const header{.index = idx.value(), .status = status, .length = out.size()};
+        if (!write_all(results, &header, sizeof(header)) || !write_all(results, out.data(), out.size())) {
+            _exit(EXIT_FAILURE);
+        }
+    }
+
+    // the worker is a copy of the shell and must never return into the shell loop
+    _exit(EXIT_SUCCESS);
+}
+
+auto parallel::collect(work_ranges& ranges, std::vector<file_descriptor_wrapper> const& results, bool keep_order, logger& log) -> std::pair<std::size_t, std::size_t> {
+    // print results as they arrive, or hold them back until every earlier command has been printed
+    std::size_t failed = 0;
+    std::size_t received = 0;
+    std::size_t next_print = 0;
+    std::unordered_map<std::size_t, std::string> pending;
+    std::vector<bool> open(results.size(), true);
+    auto const receive = [&](std::size_t worker) {
+        // a worker which closed its pipe has run out of commands
+        result_header header;
+        if (!read_all(results[worker], &header, sizeof(header))) {
+            open[worker] = false;
+            return;
+        }
+        std::string out(header.length, '\0');
+        if (!read_all(results[worker], out.data(), out.size())) {
+            open[worker] = false;
+            return;
+        }
+
+        ++received;
+        if (header.status != EXIT_SUCCESS) {
+            ++failed;
+        }
+
+        if (!keep_order) {
+            log.log(LOG_LEVEL::SILENT, out);
+            return;
+        }
+
+        pending.emplace(header.index, std::move(out));
+        for (auto it = pending.find(next_print); it != std::end(pending); it = pending.find(next_print)) {
+            log.log(LOG_LEVEL::SILENT, it->second);
+            pending.erase(it);
+            ++next_print;
+        }
+    };
+    auto const any_open = [&open]() { return std::ranges::any_of(open, [](bool is_open) { return is_open; }); };
+
+    // the shell's signalfd reads ctrl+c and SIGCHLD, so the results are waited on through its reactor when there is one
+    reactor* const shell = process::shell_events();
+    std::vector<std::optional<std::uint64_t>> tokens(results.size(), std::nullopt);
+    std::vector<bool> ready(results.size(), false);
+    if (shell != nullptr) {
+        for (std::size_t worker = 0; worker < results.size(); ++worker) {
+            tokens[worker] = shell->add(results[worker], [&ready, worker]() { ready[worker] = true; });
+        }
+    }
+    auto const unregister = [&](std::size_t worker) {
+        if (tokens[worker].has_value()) {
+            shell->remove(results[worker], tokens[worker].value()); // NOLINT a token is only handed out with the reactor
+            tokens[worker] = std::nullopt;
+        }
+    };
+
+    if (shell != nullptr && std::ranges::all_of(tokens, [](std::optional<std::uint64_t> const& token) { return token.has_value(); })) {
+        // the workers are waited on once the results are in, so the shell must not reap them before then
+        process::set_collecting(true);
+        while (any_open()) {
+            if (!shell->dispatch(-1)) {
+                break;
+            }
+
+            for (std::size_t worker = 0; worker < results.size(); ++worker) {
+                if (!ready[worker]) {
+                    continue;
+                }
+                ready[worker] = false;
+                receive(worker);
+                if (!open[worker]) {
+                    unregister(worker);
+                }
+            }
+
+            // ctrl+c stops the workers from claiming another command, the commands already running are interrupted by their workers
+            if (process::take_interrupt()) {
+                ranges.cancel();
+            }
+        }
+        process::set_collecting(false);
+    } else {
+        std::vector<syscall_wrapper::pollfd_wrapper> pfds;
+        std::vector<std::size_t> pfd_workers;
+        while (any_open()) {
+            pfds.clear();
+            pfd_workers.clear();
+            for (std::size_t worker = 0; worker < results.size(); ++worker) {
+                if (open[worker]) {
+                    pfds.emplace_back(results[worker], POLLIN, 0);
+                    pfd_workers.push_back(worker);
+                }
+            }
+
+            if (!syscall_wrapper::poll_wrapper(pfds, -1).has_value()) {
+                break;
+            }
+
+            for (std::size_t i = 0; i < pfds.size(); ++i) {
+                if (pfds[i].revents != 0) {
+                    receive(pfd_workers[i]);
+                }
+            }
+        }
+    }
+
+    // nothing may stay registered once the pipes close
+    for (std::size_t worker = 0; worker < results.size(); ++worker) {
+        unregister(worker);
+    }
+
+    // a worker which died leaves a gap, so whatever is still held back is printed in order around it
+    std::vector<std::size_t> held;
+    held.reserve(pending.size());
+    for (auto const& [idx, out] : pending) {
+        held.push_back(idx);
+    }
+    std::ranges::sort(held);
+    for (std::size_t const idx : held) {
+        log.log(LOG_LEVEL::SILENT, pending[idx]);
+    }
+
+    return {received, failed};
+}
+
+auto parallel::run(std::vector<std::string> const& commands, std::size_t jobs, bool keep_order, [[maybe_unused]] logger& log) -> std::size_t {
+    if (commands.empty()) {
+        return 0;
+    }
+
+    // there is no point in a worker which could never claim a command
+    std::size_t const workers = std::clamp<std::size_t>(jobs, 1, commands.size());
+    work_ranges ranges(workers, commands.size());
+    if (!ranges.valid()) {
+        return commands.size();
+    }
+
+    // start every worker with a pipe to send its results back on
+    std::vector<file_descriptor_wrapper> results;
+    std::vector<pid_t> pids;
+    results.reserve(workers);
+    pids.reserve(workers);
+    for (std::size_t worker = 0; worker < workers; ++worker) {
+        std::optional<std::vector<file_descriptor_wrapper>> pipe_fds = syscall_wrapper::pipe_wrapper();
+        if (!pipe_fds.has_value()) {
+            break;
+        }
+
+        std::optional<pid_t> const pid = syscall_wrapper::fork_wrapper();
+        if (!pid.has_value()) {
+            break;
+        }
+        if (pid.value() == 0) { // child
+            // only the parent reads results, this closes the child's copies of the other workers' pipes
+            results.clear();
+            pipe_fds.value().erase(std::begin(pipe_fds.value()));
+            work(ranges, worker, commands, pipe_fds.value().front());
+        }
+
+        // parent
+        results.push_back(std::move(pipe_fds.value()[0]));
+        pids.push_back(pid.value());
+    }
+
+    // the commands of a worker which could not be started are stolen by the others, unless none started at all
+    if (pids.empty()) {
+        return commands.size();
+    }
+
+    auto const [received, failed] = collect(ranges, results, keep_order, log);
+
+    for (pid_t const pid : pids) {
+        std::ignore = process::wait_process(pid);
+    }
+
+    // a command whose result never arrived counts as failed
+    return failed + (commands.size() - received);
+}
+} // namespace jsh
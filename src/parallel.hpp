@@ -0,0 +1,181 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "job.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+#include "process.hpp"
+#include "reactor.hpp"
+
+namespace jsh {
+/**
+ * structure describing how a parallel run was requested
+ *
+ * jobs: the most commands which run at once (a -j N flag), the CPUs the shell may run on by default
+ *
+ * keep_order: whether the output of each command is printed in input order (a -k flag), otherwise it is printed as each command finishes
+ *
+ * command_template: the command every input line is substituted into at each {}, or appended to if there is no {}, empty to run each line as a command
+ */
+struct parallel_options {
+    std::size_t jobs = 1;
+    bool keep_order = false;
+    std::vector<std::string> command_template;
+};
+
+/**
+ * work_ranges: the commands each worker still has to run, kept in memory shared between the workers so an idle worker can steal from a busy one
+ *
+ * NOTES: a range is packed into one 64 bit atomic as NEXT << 32 | END, the owner takes from the front and a thief takes the back half, both with a compare and swap, so neither ever blocks
+ */
+class work_ranges {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr int END_BITS = 32;
+    static constexpr std::uint64_t END_MASK = (std::uint64_t{1} << END_BITS) - 1;
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "a range has to be lock free to be shared between processes");
+
+    /**
+     * ranges: one range per worker followed by the cancelled flag, placed in shared memory
+     */
+    std::atomic<std::uint64_t>* ranges = nullptr;
+
+    /**
+     * workers: the number of ranges
+     */
+    std::size_t workers = 0;
+
+    /**
+     * pack: packs the half open range [next, end) into one word
+     */
+    [[nodiscard]] static auto pack(std::uint64_t next, std::uint64_t end) -> std::uint64_t;
+
+    /**
+     * pop: takes the next command from the front of the worker's own range
+     */
+    [[nodiscard]] auto pop(std::size_t worker) -> std::optional<std::size_t>;
+
+    /**
+     * steal: moves the back half of the first non empty range after the worker's into the worker's range, and returns the first command of it
+     */
+    [[nodiscard]] auto steal(std::size_t worker) -> std::optional<std::size_t>;
+
+  public:
+    /**
+     * constructor which splits count commands into one contiguous range per worker
+     */
+    work_ranges(std::size_t workers, std::size_t count);
+
+    /**
+     * delete other constructors
+     */
+    work_ranges(work_ranges const& other) = delete;
+    work_ranges(work_ranges&& other) = delete;
+    auto operator=(work_ranges const& other) -> work_ranges& = delete;
+    auto operator=(work_ranges&& other) -> work_ranges& = delete;
+
+    /**
+     * destructor which unmaps the ranges
+     */
+    ~work_ranges();
+
+    /**
+     * valid: whether the shared memory could be mapped
+     */
+    [[nodiscard]] auto valid() const -> bool;
+
+    /**
+     * claim: the next command the worker should run, from its own range or else stolen from another, std::nullopt once every command has been claimed or the run was cancelled
+     */
+    [[nodiscard]] auto claim(std::size_t worker) -> std::optional<std::size_t>;
+
+    /**
+     * cancel: stops every worker from claiming another command, the commands already claimed still run
+     */
+    void cancel();
+};
+
+/**
+ * parallel: runs many independent commands through the job machinery with a bounded number in flight
+ *
+ * NOTES: each worker is a forked copy of the shell which runs its commands with job::execute_job, the standard output of every command is captured in a memfd and sent back to the shell whole, so the output of two commands never interleaves
+ * a worker keeps the shell's signal mask, so ctrl+c reaches the command it is running through its supervision while the shell cancels the commands not yet claimed
+ */
+class parallel {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr std::string_view PLACEHOLDER = "{}";
+    static constexpr std::string_view JOBS_FLAG = "-j";
+    static constexpr std::string_view KEEP_ORDER_FLAG = "-k";
+    static constexpr char const* NULL_DEVICE = "/dev/null";
+    static constexpr char const* OUTPUT_NAME = "jsh-parallel";
+    static constexpr std::size_t READ_SIZE = 4096;
+
+    /**
+     * structure which precedes the output of each command on a worker's result pipe
+     */
+    struct result_header {
+        std::size_t index = 0;
+        int status = EXIT_SUCCESS;
+        std::size_t length = 0;
+    };
+
+    /**
+     * read_all: reads exactly count bytes, returns false if the pipe closes first
+     */
+    [[nodiscard]] static auto read_all(file_descriptor_wrapper const& fides, void* buf, std::size_t count) -> bool;
+
+    /**
+     * write_all: writes exactly count bytes
+     */
+    [[nodiscard]] static auto write_all(file_descriptor_wrapper const& fides, void const* buf, std::size_t count) -> bool;
+
+    /**
+     * capture: runs one command with its standard output in a memfd, and returns its exit status and output
+     */
+    [[nodiscard]] static auto capture(std::string const& command) -> std::pair<int, std::string>;
+
+    /**
+     * work: the body of a worker, runs commands until none are left to claim and then exits
+     */
+    [[noreturn]] static void work(work_ranges& ranges, std::size_t worker, std::vector<std::string> const& commands, file_descriptor_wrapper const& results);
+
+    /**
+     * collect: reads the results of every worker and prints them, through the shell's reactor if there is one so ctrl+c cancels the run
+     *
+     * returns the number of commands which were received and the number of those which failed
+     */
+    [[nodiscard]] static auto collect(work_ranges& ranges, std::vector<file_descriptor_wrapper> const& results, bool keep_order, logger& log) -> std::pair<std::size_t, std::size_t>;
+
+  public:
+    /**
+     * parse_args: parses the arguments of the parallel builtin
+     *
+     * returns std::nullopt if a flag is not understood
+     */
+    [[nodiscard]] static auto parse_args(std::vector<std::string> const& args) -> std::optional<parallel_options>;
+
+    /**
+     * read_lines: reads every non empty line until EOF
+     */
+    [[nodiscard]] static auto read_lines(file_descriptor_wrapper const& fides) -> std::vector<std::string>;
+
+    /**
+     * expand: the command a line runs as with the template
+     */
+    [[nodiscard]] static auto expand(std::vector<std::string> const& command_template, std::string const& line) -> std::string;
+
+    /**
+     * run: runs every command with at most jobs in flight, and prints their output
+     *
+     * returns the number of commands which failed
+     */
+    [[nodiscard]] static auto run(std::vector<std::string> const& commands, std::size_t jobs, bool keep_order, [[maybe_unused]] logger& log = cout_logger) -> std::size_t;
+};
+} // namespace jsh
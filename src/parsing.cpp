@@ -11,85 +11,59 @@ auto parsing::peek_char(std::string const& str, std::size_t index) -> std::optio
     return std::make_optional<char>(str[index]);
 }
 
-auto parsing::variable_substitution(std::string const& input) -> std::string {
-    // create a copy of the input
-    std::string output = input;
-
-    std::size_t last_dollar_sign_location = 0;
-
-    // while there exists a $ in the string perform substitutions
-    for (std::size_t sub = 0; sub < MAX_SUBSTITUTIONS; ++sub) {
-        // location of the desired character
-        std::size_t dollar_sign_location = std::string::npos;
-        std::size_t open_brace_location = std::string::npos;
-        std::size_t closed_brace_location = std::string::npos;
-
-        // find the first instance of the $
-        for (std::size_t i = last_dollar_sign_location; i < output.size(); ++i) {
-            if (auto chr = peek_char(output, i); chr && chr.value() == '$') {
-                dollar_sign_location = i;
-                break;
-            }
-        }
+auto parsing::name_length(std::string_view text) -> std::size_t {
+    // a name starts with a letter or an underscore, digits may follow
+    if (text.empty() || !(static_cast<bool>(std::isalpha(static_cast<unsigned char>(text.front()))) || text.front() == '_')) {
+        return 0;
+    }
+    return static_cast<std::size_t>(std::ranges::find_if_not(text, [](char chr) { return static_cast<bool>(std::isalnum(static_cast<unsigned char>(chr))) || chr == '_'; }) - std::begin(text));
+}
 
-        // if we didn't find a $ break out of the loop
-        if (dollar_sign_location == std::string::npos) {
+auto parsing::variable_substitution(std::string const& input) -> std::string {
+    // values are usually about as long as the names they replace, so the output rarely grows past the input
+    std::string output;
+    output.reserve(input.size());
+
+    std::string_view const line = input;
+    std::size_t literal_start = 0;
+    std::size_t pos = 0;
+    while (true) {
+        // the text up to the next $ is copied as is
+        std::size_t const dollar_sign_location = metachar_scan::find(line, pos, DOLLAR_SIGN);
+        if (dollar_sign_location == line.size()) {
             break;
         }
 
-        // find the first instance of the {
-        for (std::size_t i = dollar_sign_location; i < output.size(); ++i) {
-            if (auto chr = peek_char(output, i); chr && chr.value() == '{') {
-                open_brace_location = i;
-                break;
+        std::string_view name;
+        std::size_t end = 0;
+        if (peek_char(input, dollar_sign_location + 1) == '{') {
+            // ${NAME} runs to the next }, without one the $ is kept
+            std::size_t const closed_brace_location = metachar_scan::find(line, dollar_sign_location + 2, CLOSED_BRACE);
+            if (closed_brace_location == line.size()) {
+                pos = dollar_sign_location + 1;
+                continue;
             }
-        }
-
-        // the addition here is not going to overflow since dollar_sign_location cannot be std::string::npos
-        assert(dollar_sign_location != std::string::npos);
-
-        // if we didn't find a { continue to the next substitution
-        // beyond the current one
-        if (open_brace_location == std::string::npos || dollar_sign_location + 1 != open_brace_location) {
-            last_dollar_sign_location = dollar_sign_location + 1;
-            continue;
-        }
-
-        // find the first instance of the }
-        for (std::size_t i = open_brace_location; i < output.size(); ++i) {
-            if (auto chr = peek_char(output, i); chr && chr.value() == '}') {
-                closed_brace_location = i;
-                break;
+            name = line.substr(dollar_sign_location + 2, closed_brace_location - dollar_sign_location - 2);
+            end = closed_brace_location + 1;
+        } else {
+            // $NAME runs for as long as the name does, $?, $$ and $! are one character long, a $ before anything else is kept
+            std::optional<char> const next = peek_char(input, dollar_sign_location + 1);
+            std::size_t const length = next.has_value() && SPECIAL_PARAMETERS.contains(next.value()) ? 1 : name_length(line.substr(dollar_sign_location + 1));
+            if (length == 0) {
+                pos = dollar_sign_location + 1;
+                continue;
             }
+            name = line.substr(dollar_sign_location + 1, length);
+            end = dollar_sign_location + 1 + length;
         }
 
-        // if we failed this substitution continue to the next one
-        if (closed_brace_location == std::string::npos) {
-            last_dollar_sign_location = dollar_sign_location + 1;
-            continue;
-        }
-
-        // make sure the characters are in the correct order
-        // $
-        assert(dollar_sign_location != std::string::npos);
-        assert(dollar_sign_location + 1 == open_brace_location);
-        assert(dollar_sign_location < closed_brace_location);
-
-        // {
-        assert(open_brace_location != std::string::npos);
-        assert(open_brace_location < closed_brace_location);
-
-        // }
-        assert(closed_brace_location != std::string::npos);
-
-        // make the substitution
-        std::string prefix = output.substr(0, dollar_sign_location);
-        std::string const suffix = output.substr(std::min(closed_brace_location + 1, output.size()), output.size());
-        std::string const var = output.substr(open_brace_location + 1, closed_brace_location - open_brace_location - 1);
-
-        output = prefix.append(environment::get_var(var.c_str())).append(suffix);
+        // the value replaces everything from the $ to the end of the name, the table never holds a name with an = in it
+        output.append(line.substr(literal_start, dollar_sign_location - literal_start));
+        output.append(environment::lookup(name));
+        literal_start = end;
+        pos = end;
     }
-
+    output.append(line.substr(literal_start));
     return output;
 }
 } // namespace jsh
@@ -5,6 +5,7 @@
 // JSH
 #include "environment.hpp"
 #include "macros.hpp"
+#include "metachar_scan.hpp"
 
 namespace jsh {
 class parsing {
@@ -12,9 +13,16 @@ class parsing {
     /**
      * CONSTANT VARIABLES
      */
-    static constexpr int MAX_SUBSTITUTIONS = 1000000;
+    static constexpr metachar_set DOLLAR_SIGN{"$"};
+    static constexpr metachar_set CLOSED_BRACE{"}"};
+    static constexpr metachar_set SPECIAL_PARAMETERS{"?$!"};
 
   public:
+    /**
+     * name_length: how long the variable name at the front of text is, 0 if text does not start with one
+     */
+    [[nodiscard]] static auto name_length(std::string_view text) -> std::size_t;
+
     /**
      * peek_char: returns a the character of a string at a given index or std::nullopt if it is invalid (index is npos or index is out of bounds)
      *
@@ -25,9 +33,11 @@ class parsing {
     static auto peek_char(std::string const& str, std::size_t index) -> std::optional<char>;
 
     /**
-     * variable_substition will perform any environment variable substitutions in a given string
+     * variable_substition will perform any environment variable substitutions in a given string, both ${NAME} and $NAME, in a single pass
      *
      * input: the input which will have substitutions performed on it
+     *
+     * NOTES: the values which are substituted in are not substituted again, the special parameters $?, $$ and $! need no braces
      */
     static auto variable_substitution(std::string const& input) -> std::string;
 };
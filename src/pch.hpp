@@ -1,27 +1,54 @@
 // STL
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <cctype>
+#include <charconv>
+#include <chrono>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <deque>
 #include <exception>
+#include <filesystem>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <memory>
+#include <numeric>
 #include <optional>
+#include <set>
+#include <span>
 #include <sstream>
-#include <stack>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
 // OS
 #include <fcntl.h>
+#include <linux/io_uring.h>
+#include <linux/perf_event.h>
 #include <poll.h>
+#include <sched.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <sys/signalfd.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <sys/timerfd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <termios.h>
@@ -0,0 +1,168 @@
+#include "perf_counters.hpp"
+
+namespace jsh {
+auto perf_counters::attr(PERF_COUNTER counter, bool on_exec) -> perf_event_attr {
+    perf_event_attr event{};
+    event.size = sizeof(event);
+
+    switch (counter) {
+    case PERF_COUNTER::CYCLES: {
+        event.type = PERF_TYPE_HARDWARE;
+        event.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    }
+    case PERF_COUNTER::INSTRUCTIONS: {
+        event.type = PERF_TYPE_HARDWARE;
+        event.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    }
+    case PERF_COUNTER::CACHE_MISSES: {
+        event.type = PERF_TYPE_HARDWARE;
+        event.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    }
+    case PERF_COUNTER::BRANCH_MISSES: {
+        event.type = PERF_TYPE_HARDWARE;
+        event.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    }
+    case PERF_COUNTER::CONTEXT_SWITCHES: {
+        event.type = PERF_TYPE_SOFTWARE;
+        event.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+        break;
+    }
+    case PERF_COUNTER::CPU_MIGRATIONS: {
+        event.type = PERF_TYPE_SOFTWARE;
+        event.config = PERF_COUNT_SW_CPU_MIGRATIONS;
+        break;
+    }
+    case PERF_COUNTER::PAGE_FAULTS: {
+        event.type = PERF_TYPE_SOFTWARE;
+        event.config = PERF_COUNT_SW_PAGE_FAULTS;
+        break;
+    }
+    case PERF_COUNTER::TASK_CLOCK:
+    case PERF_COUNTER::COUNT: {
+        event.type = PERF_TYPE_SOFTWARE;
+        event.config = PERF_COUNT_SW_TASK_CLOCK;
+        break;
+    }
+    }
+
+    // the counters are read one at a time since inherited counters can not be read as a group
+    event.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    event.inherit = 1;
+
+    // unprivileged users may only count hardware events in user space, software events such as context switches only happen inside of the kernel
+    if (event.type == PERF_TYPE_HARDWARE) {
+        event.exclude_kernel = 1;
+        event.exclude_hv = 1;
+    }
+
+    // a child which is about to exec only starts counting once it runs the binary
+    event.disabled = on_exec ? 1 : 0;
+    event.enable_on_exec = on_exec ? 1 : 0;
+
+    return event;
+}
+
+auto perf_counters::hold(std::optional<file_descriptor_wrapper>& exec_gate) -> std::optional<file_descriptor_wrapper> {
+    std::optional<std::vector<file_descriptor_wrapper>> pipe_fds = syscall_wrapper::pipe_wrapper();
+    if (!pipe_fds.has_value()) {
+        return std::nullopt;
+    }
+
+    exec_gate = std::move(pipe_fds.value()[0]);
+    return std::make_optional<file_descriptor_wrapper>(std::move(pipe_fds.value()[1]));
+}
+
+auto perf_counters::attach(pid_t pid, bool on_exec, std::optional<file_descriptor_wrapper> gate) -> std::array<std::optional<file_descriptor_wrapper>, static_cast<std::size_t>(PERF_COUNTER::COUNT)> {
+    std::array<std::optional<file_descriptor_wrapper>, static_cast<std::size_t>(PERF_COUNTER::COUNT)> fds;
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+        perf_event_attr event = attr(static_cast<PERF_COUNTER>(i), on_exec);
+        fds[i] = syscall_wrapper::perf_event_open_wrapper(event, pid);
+    }
+
+    // release the child whether or not any counter could be opened, the child also holds the write end so it waits on a byte rather than on EOF
+    if (gate.has_value()) {
+        static constexpr char RELEASE = '\0';
+        std::ignore = syscall_wrapper::write_wrapper(gate.value(), &RELEASE, sizeof(RELEASE));
+    }
+
+    return fds;
+}
+
+void perf_counters::collect(stage_counters& counters) {
+    for (std::size_t i = 0; i < counters.fds.size(); ++i) {
+        if (!counters.fds[i].has_value()) {
+            continue;
+        }
+
+        // the value, then how long the counter was enabled and how long it actually ran
+        std::array<std::uint64_t, 3> read_value{};
+        std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(counters.fds[i].value(), read_value.data(), sizeof(read_value));
+        counters.fds[i] = std::nullopt;
+        if (!num_read.has_value() || num_read.value() != sizeof(read_value)) {
+            continue;
+        }
+
+        // a counter which had to share the PMU is scaled up to the time it was enabled
+        auto const [value, enabled, running] = read_value;
+        if (running == 0) {
+            counters.values[i] = 0;
+        } else if (running < enabled) {
+            counters.values[i] = static_cast<std::uint64_t>(static_cast<double>(value) * static_cast<double>(enabled) / static_cast<double>(running));
+        } else {
+            counters.values[i] = value;
+        }
+    }
+}
+
+void perf_counters::print_row(std::string_view stage, std::array<std::optional<std::uint64_t>, static_cast<std::size_t>(PERF_COUNTER::COUNT)> const& values, std::string_view command, logger& log) {
+    log.log(LOG_LEVEL::SILENT, stage);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        log.log(LOG_LEVEL::SILENT, '\t');
+
+        // unsupported counters are printed as -
+        if (!values[i].has_value()) {
+            log.log(LOG_LEVEL::SILENT, '-');
+        } else if (static_cast<PERF_COUNTER>(i) == PERF_COUNTER::TASK_CLOCK) {
+            log.log(LOG_LEVEL::SILENT, values[i].value() / NSEC_PER_MSEC);
+        } else {
+            log.log(LOG_LEVEL::SILENT, values[i].value());
+        }
+    }
+
+    // instructions per cycle tells whether the stage is stalling
+    std::optional<std::uint64_t> const& cycles = values[static_cast<std::size_t>(PERF_COUNTER::CYCLES)];
+    std::optional<std::uint64_t> const& instructions = values[static_cast<std::size_t>(PERF_COUNTER::INSTRUCTIONS)];
+    if (cycles.has_value() && instructions.has_value() && cycles.value() != 0) {
+        static constexpr int IPC_PRECISION = 100;
+        std::uint64_t const ipc = instructions.value() * IPC_PRECISION / cycles.value();
+        log.log(LOG_LEVEL::SILENT, '\t', ipc / IPC_PRECISION, '.', (ipc % IPC_PRECISION) / 10, ipc % 10); // NOLINT two decimal places
+    } else {
+        log.log(LOG_LEVEL::SILENT, "\t-");
+    }
+
+    log.log(LOG_LEVEL::SILENT, '\t', command, '\n');
+}
+
+void perf_counters::report(std::vector<stage_counters> const& stages, [[maybe_unused]] logger& log) {
+    log.log(LOG_LEVEL::SILENT, "\nstage");
+    for (char const* name : COUNTER_STR) {
+        log.log(LOG_LEVEL::SILENT, '\t', name);
+    }
+    log.log(LOG_LEVEL::SILENT, "\tipc\tcommand\n");
+
+    // a counter is only part of the total if every stage supported it
+    std::array<std::optional<std::uint64_t>, static_cast<std::size_t>(PERF_COUNTER::COUNT)> total{};
+    total.fill(0);
+    for (stage_counters const& stage : stages) {
+        print_row(std::to_string(stage.stage), stage.values, stage.command, log);
+        for (std::size_t i = 0; i < total.size(); ++i) {
+            total[i] = total[i].has_value() && stage.values[i].has_value() ? std::make_optional<std::uint64_t>(total[i].value() + stage.values[i].value()) : std::nullopt;
+        }
+    }
+    print_row("total", total, "", log);
+}
+} // namespace jsh
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * PERF_COUNTER: the counters opened on every stage of a job run with perfstat
+ */
+enum class PERF_COUNTER : char {
+    CYCLES = 0,
+    INSTRUCTIONS = 1,
+    CACHE_MISSES = 2,
+    BRANCH_MISSES = 3,
+    CONTEXT_SWITCHES = 4,
+    CPU_MIGRATIONS = 5,
+    PAGE_FAULTS = 6,
+    TASK_CLOCK = 7,
+    COUNT = 8
+};
+
+/**
+ * structure describing the counters of one stage of a job
+ *
+ * stage: the index of the process in the job
+ *
+ * command: the command the stage ran
+ *
+ * fds: the counters while the stage runs, std::nullopt for a counter the kernel or hardware does not support
+ *
+ * values: the counts once the stage has been reaped, scaled up if the counter had to share the PMU, std::nullopt if the counter is not supported
+ */
+struct stage_counters {
+    std::size_t stage = 0;
+    std::string command;
+    std::array<std::optional<file_descriptor_wrapper>, static_cast<std::size_t>(PERF_COUNTER::COUNT)> fds;
+    std::array<std::optional<std::uint64_t>, static_cast<std::size_t>(PERF_COUNTER::COUNT)> values{};
+};
+
+/**
+ * perf_counters: counts hardware and software events for the stages of a job with perf_event_open
+ *
+ * NOTES: a counted child waits on a gate pipe before it execs so its counters can be attached first, the counters are inherited so everything the child starts is counted, and the counts of a descendant are folded in when it exits
+ */
+class perf_counters {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* COUNTER_STR[static_cast<std::size_t>(PERF_COUNTER::COUNT)] = {"cycles", "instructions", "cache_misses", "branch_misses", "ctxsw", "migrations", "page_faults", "task_clock_ms"}; // NOLINT
+    static constexpr std::uint64_t NSEC_PER_MSEC = 1000000;
+
+    /**
+     * attr: the perf_event_attr describing a counter
+     *
+     * on_exec: whether the counter starts once the child execs instead of immediately
+     */
+    [[nodiscard]] static auto attr(PERF_COUNTER counter, bool on_exec) -> perf_event_attr;
+
+    /**
+     * print_row: prints the counts of one stage, or of the whole job
+     */
+    static void print_row(std::string_view stage, std::array<std::optional<std::uint64_t>, static_cast<std::size_t>(PERF_COUNTER::COUNT)> const& values, std::string_view command, logger& log);
+
+  public:
+    /**
+     * hold: creates the gate a child waits on before exec, exec_gate is handed to the child and the write end is returned
+     */
+    [[nodiscard]] static auto hold(std::optional<file_descriptor_wrapper>& exec_gate) -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * attach: opens every counter on the held child and releases it
+     *
+     * pid: the child being counted
+     *
+     * on_exec: whether the child is about to exec, otherwise the counters start right away
+     *
+     * gate: the write end returned by hold
+     */
+    [[nodiscard]] static auto attach(pid_t pid, bool on_exec, std::optional<file_descriptor_wrapper> gate) -> std::array<std::optional<file_descriptor_wrapper>, static_cast<std::size_t>(PERF_COUNTER::COUNT)>;
+
+    /**
+     * collect: reads and closes the counters of a stage which has been reaped
+     */
+    static void collect(stage_counters& counters);
+
+    /**
+     * report: prints the counts of every stage of a job and their total
+     */
+    static void report(std::vector<stage_counters> const& stages, [[maybe_unused]] logger& log = cerr_logger);
+};
+} // namespace jsh
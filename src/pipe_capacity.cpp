@@ -0,0 +1,200 @@
+#include "pipe_capacity.hpp"
+
+namespace jsh {
+std::optional<int> pipe_capacity::max_size_cache = std::nullopt;
+std::vector<pipe_capacity::monitored_pipe> pipe_capacity::pipes{};
+std::vector<pipe_stats> pipe_capacity::last_stats{};
+std::optional<file_descriptor_wrapper> pipe_capacity::timer = std::nullopt;
+
+auto pipe_capacity::parse_policy(std::string_view value) -> std::optional<pipe_policy> {
+    if (value.empty() || value == DEFAULT_STR) {
+        return std::make_optional<pipe_policy>();
+    }
+    if (value == ADAPTIVE_STR) {
+        return std::make_optional<pipe_policy>(pipe_policy{.sizing = PIPE_SIZING::ADAPTIVE, .size = 0});
+    }
+    if (value == MAX_SIZE_STR) {
+        return std::make_optional<pipe_policy>(pipe_policy{.sizing = PIPE_SIZING::FIXED, .size = max_size()});
+    }
+
+    // a byte count, optionally in KiB or MiB
+    int size = 0;
+    auto [ptr, err] = std::from_chars(value.data(), value.data() + value.size(), size);
+    if (err != std::errc{} || size <= 0) {
+        return std::nullopt;
+    }
+    std::string_view const suffix = value.substr(static_cast<std::size_t>(ptr - value.data()));
+    if (suffix == "K" || suffix == "k") {
+        size *= KIBI;
+    } else if (suffix == "M" || suffix == "m") {
+        size *= KIBI * KIBI;
+    } else if (!suffix.empty()) {
+        return std::nullopt;
+    }
+
+    // unprivileged processes can not go past pipe-max-size
+    return std::make_optional<pipe_policy>(pipe_policy{.sizing = PIPE_SIZING::FIXED, .size = std::min(size, max_size())});
+}
+
+auto pipe_capacity::policy() -> pipe_policy {
+    std::string_view const value = environment::get_var(PIPE_SIZE_VAR);
+    std::optional<pipe_policy> const parsed = parse_policy(value);
+    if (!parsed.has_value()) {
+        cout_logger.log(LOG_LEVEL::WARN, "Ignoring invalid ", PIPE_SIZE_VAR, ": ", value);
+        return pipe_policy{};
+    }
+    return parsed.value();
+}
+
+auto pipe_capacity::max_size() -> int {
+    if (max_size_cache.has_value()) [[likely]] {
+        return max_size_cache.value();
+    }
+
+    // the limit only changes if root writes to it, so it is read once
+    max_size_cache = FALLBACK_MAX_SIZE;
+    std::optional<file_descriptor_wrapper> const fides = syscall_wrapper::open_wrapper(PIPE_MAX_SIZE_FILE, O_RDONLY | O_CLOEXEC, 0);
+    if (!fides.has_value()) {
+        return max_size_cache.value();
+    }
+
+    std::array<char, std::numeric_limits<int>::digits10 + 2> buf{};
+    std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(fides.value(), buf.data(), buf.size());
+    if (num_read.has_value() && num_read.value() > 0) {
+        int size = 0;
+        auto [ptr, err] = std::from_chars(buf.data(), buf.data() + num_read.value(), size);
+        if (err == std::errc{} && size > 0) {
+            max_size_cache = size;
+        }
+    }
+
+    return max_size_cache.value();
+}
+
+void pipe_capacity::arm_timer() {
+    if (!timer.has_value()) {
+        timer = syscall_wrapper::timerfd_create_wrapper(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    }
+    if (timer.has_value() && !syscall_wrapper::timerfd_settime_wrapper(timer.value(), std::chrono::steady_clock::now() + SAMPLE_INTERVAL)) {
+        timer = std::nullopt;
+    }
+}
+
+void pipe_capacity::add_pipe(file_descriptor_wrapper const& read_end, std::size_t stage, pipe_policy const& policy, bool sample) {
+    monitored_pipe& pipe = pipes.emplace_back();
+    pipe.stats.stage = stage;
+
+    // fixed pipes are resized up front, default and adaptive pipes start at the kernel's default
+    std::optional<int> capacity = std::nullopt;
+    if (policy.sizing == PIPE_SIZING::FIXED) {
+        capacity = syscall_wrapper::set_pipe_size_wrapper(read_end, policy.size);
+    }
+    if (!capacity.has_value()) {
+        capacity = syscall_wrapper::get_pipe_size_wrapper(read_end);
+    }
+    pipe.stats.capacity = capacity.value_or(0);
+
+    // the default policy is never sampled, and only the foreground shell is around to sample the pipe at all
+    if (policy.sizing == PIPE_SIZING::DEFAULT || !sample) {
+        return;
+    }
+    pipe.read_end = syscall_wrapper::dup_wrapper(read_end);
+    pipe.grow = policy.sizing == PIPE_SIZING::ADAPTIVE;
+    if (pipe.read_end.has_value() && !timer.has_value()) {
+        arm_timer();
+    }
+}
+
+void pipe_capacity::set_reader(std::size_t stage, pid_t reader) {
+    auto itr = std::ranges::find_if(pipes, [&](monitored_pipe const& pipe) { return pipe.stats.stage == stage; });
+    if (itr != std::end(pipes)) {
+        itr->reader = reader;
+    }
+}
+
+auto pipe_capacity::sample_timer() -> file_descriptor_wrapper const* {
+    return timer.has_value() ? &timer.value() : nullptr;
+}
+
+void pipe_capacity::sample() {
+    // consume the expiration
+    if (timer.has_value()) {
+        std::uint64_t expirations = 0;
+        std::ignore = syscall_wrapper::read_wrapper(timer.value(), &expirations, sizeof(expirations));
+    }
+
+    bool sampling = false;
+    for (monitored_pipe& pipe : pipes) {
+        if (!pipe.read_end.has_value()) {
+            continue;
+        }
+
+        // nothing was launched to read the pipe, so the shell must not be the one keeping it open
+        if (pipe.reader == -1) {
+            pipe.read_end = std::nullopt;
+            continue;
+        }
+        sampling = true;
+
+        std::optional<int> const fill = syscall_wrapper::pipe_fill_wrapper(pipe.read_end.value());
+        if (!fill.has_value()) {
+            continue;
+        }
+
+        ++pipe.stats.samples;
+        pipe.stats.peak_fill = std::max(pipe.stats.peak_fill, fill.value());
+
+        // a full pipe means the writer is blocked waiting on the reader
+        if (fill.value() < pipe.stats.capacity) {
+            continue;
+        }
+        ++pipe.stats.full_samples;
+
+        // an adaptive pipe doubles until it reaches pipe-max-size
+        if (pipe.grow && pipe.stats.capacity < max_size()) {
+            std::optional<int> const capacity = syscall_wrapper::set_pipe_size_wrapper(pipe.read_end.value(), std::min(pipe.stats.capacity * 2, max_size()));
+            if (capacity.has_value() && capacity.value() > pipe.stats.capacity) {
+                pipe.stats.capacity = capacity.value();
+                ++pipe.stats.grows;
+            }
+        }
+    }
+
+    // keep sampling until every reader has exited
+    if (sampling) {
+        arm_timer();
+    } else {
+        timer = std::nullopt;
+    }
+}
+
+void pipe_capacity::release(pid_t pid) {
+    for (monitored_pipe& pipe : pipes) {
+        if (pipe.reader == pid) {
+            pipe.read_end = std::nullopt;
+        }
+    }
+}
+
+void pipe_capacity::finish() {
+    // keep only the statistics, dropping every duplicate read end
+    last_stats.clear();
+    last_stats.reserve(pipes.size());
+    for (monitored_pipe const& pipe : pipes) {
+        last_stats.push_back(pipe.stats);
+    }
+    pipes.clear();
+    timer = std::nullopt;
+}
+
+auto pipe_capacity::stats() -> std::vector<pipe_stats> const& {
+    return last_stats;
+}
+
+void pipe_capacity::print([[maybe_unused]] logger& log) {
+    log.log(LOG_LEVEL::SILENT, "stage\tcapacity\tpeak_fill\tsamples\tfull\tgrows\n");
+    for (pipe_stats const& stat : last_stats) {
+        log.log(LOG_LEVEL::SILENT, stat.stage, '\t', stat.capacity, '\t', stat.peak_fill, '\t', stat.samples, '\t', stat.full_samples, '\t', stat.grows, '\n');
+    }
+}
+} // namespace jsh
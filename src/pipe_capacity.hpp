@@ -0,0 +1,195 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "environment.hpp"
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * PIPE_SIZING: how the pipes of a pipeline are sized
+ *
+ * DEFAULT: the pipes keep the kernel's default capacity
+ *
+ * FIXED: every pipe is resized once when it is created
+ *
+ * ADAPTIVE: pipes start at the default capacity and double every time they are observed full
+ */
+enum class PIPE_SIZING : char {
+    DEFAULT = 0,
+    FIXED = 1,
+    ADAPTIVE = 2,
+    COUNT = 3
+};
+
+/**
+ * structure describing how the pipes of a job should be sized
+ *
+ * sizing: the sizing mode
+ *
+ * size: the requested capacity in bytes for FIXED sizing
+ */
+struct pipe_policy {
+    PIPE_SIZING sizing = PIPE_SIZING::DEFAULT;
+    int size = 0;
+};
+
+/**
+ * structure describing one pipe of the most recent pipeline
+ *
+ * stage: the index of the process writing into the pipe
+ *
+ * capacity: the capacity of the pipe once the pipeline finished
+ *
+ * peak_fill: the most unread bytes observed in the pipe
+ *
+ * samples: how many times the pipe's fill was sampled
+ *
+ * full_samples: how many samples found the pipe full
+ *
+ * grows: how many times the pipe was grown
+ */
+struct pipe_stats {
+    std::size_t stage = 0;
+    int capacity = 0;
+    int peak_fill = 0;
+    std::size_t samples = 0;
+    std::size_t full_samples = 0;
+    std::size_t grows = 0;
+};
+
+/**
+ * pipe_capacity: sizes the pipes between pipeline stages with F_SETPIPE_SZ and keeps statistics about how full they get
+ *
+ * NOTES: a pipeline with a non-default policy keeps a duplicate of each pipe's read end so the shell can sample it while supervising the pipeline, the duplicate is closed as soon as the real reader exits so the writer still sees EPIPE
+ */
+class pipe_capacity {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* PIPE_MAX_SIZE_FILE = "/proc/sys/fs/pipe-max-size";
+    static constexpr std::string_view DEFAULT_STR = "default";
+    static constexpr std::string_view ADAPTIVE_STR = "adaptive";
+    static constexpr std::string_view MAX_SIZE_STR = "max";
+    static constexpr int KIBI = 1024;
+    static constexpr int FALLBACK_MAX_SIZE = 1024 * 1024;
+    static constexpr std::chrono::milliseconds SAMPLE_INTERVAL{5};
+
+    /**
+     * structure for a pipe which is being sampled
+     *
+     * read_end: the shell's duplicate of the pipe's read end
+     *
+     * reader: the process reading from the pipe, the duplicate is released once it is collected
+     *
+     * grow: whether the pipe is grown when it is observed full
+     *
+     * stats: what has been observed so far
+     */
+    struct monitored_pipe {
+        std::optional<file_descriptor_wrapper> read_end;
+        pid_t reader = -1;
+        bool grow = false;
+        pipe_stats stats;
+    };
+
+    /**
+     * max_size_cache: the value of pipe-max-size, read once
+     */
+    static std::optional<int> max_size_cache;
+
+    /**
+     * pipes: every pipe of the pipeline currently being run
+     */
+    static std::vector<monitored_pipe> pipes;
+
+    /**
+     * last_stats: the statistics of the most recently finished pipeline
+     */
+    static std::vector<pipe_stats> last_stats;
+
+    /**
+     * timer: fires every SAMPLE_INTERVAL while an adaptive pipeline is running
+     */
+    static std::optional<file_descriptor_wrapper> timer;
+
+    /**
+     * arm_timer: schedules the next sample
+     */
+    static void arm_timer();
+
+  public:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr char const* PIPE_SIZE_VAR = "JSH_PIPE_SIZE";
+
+    /**
+     * parse_policy: parses default, adaptive, max, or a byte count with an optional K or M suffix
+     *
+     * returns std::nullopt if the value is not understood
+     */
+    [[nodiscard]] static auto parse_policy(std::string_view value) -> std::optional<pipe_policy>;
+
+    /**
+     * policy: the policy selected through JSH_PIPE_SIZE, default if it is unset or invalid
+     */
+    [[nodiscard]] static auto policy() -> pipe_policy;
+
+    /**
+     * max_size: the largest capacity an unprivileged process may give a pipe
+     */
+    [[nodiscard]] static auto max_size() -> int;
+
+    /**
+     * add_pipe: sizes a freshly created pipe according to the policy and starts tracking it
+     *
+     * read_end: the read end of the pipe
+     *
+     * stage: the index of the process writing into the pipe
+     *
+     * policy: how the pipe should be sized
+     *
+     * sample: whether the pipe should be sampled while the pipeline runs, only the foreground shell waits around to do so
+     */
+    static void add_pipe(file_descriptor_wrapper const& read_end, std::size_t stage, pipe_policy const& policy, bool sample);
+
+    /**
+     * set_reader: records which process reads from the pipe written by stage
+     */
+    static void set_reader(std::size_t stage, pid_t reader);
+
+    /**
+     * sample_timer: the timer which should be polled while supervising the pipeline, nullptr if nothing is being sampled
+     */
+    [[nodiscard]] static auto sample_timer() -> file_descriptor_wrapper const*;
+
+    /**
+     * sample: measures how full every pipe is, growing the full ones
+     */
+    static void sample();
+
+    /**
+     * release: closes the duplicate read end of any pipe read by pid, since the reader has exited
+     */
+    static void release(pid_t pid);
+
+    /**
+     * finish: stops tracking the current pipeline and keeps its statistics
+     */
+    static void finish();
+
+    /**
+     * stats: the statistics of the most recently finished pipeline
+     */
+    [[nodiscard]] static auto stats() -> std::vector<pipe_stats> const&;
+
+    /**
+     * print: prints the statistics of the most recently finished pipeline
+     */
+    static void print([[maybe_unused]] logger& log = cout_logger);
+};
+} // namespace jsh
@@ -1,5 +1,8 @@
 #include "posix_wrappers.hpp"
 
+// JSH
+#include "io_ring.hpp"
+
 namespace jsh {
 named_pipe_wrapper::named_pipe_wrapper(std::string pipe_name) : success{true}, name{std::move(pipe_name)} {
     // create the pipe
@@ -85,9 +88,36 @@ auto syscall_wrapper::open_wrapper(std::string const& file, int flags, mode_t pe
     return std::make_optional<file_descriptor_wrapper>(std::move(fdw));
 }
 
+auto syscall_wrapper::open_batch_wrapper(std::vector<open_request>& requests) -> bool {
+    // without a ring every request is left for the fallback
+    std::vector<std::optional<int>> results(requests.size(), std::nullopt);
+    if (io_ring* ring = io_ring::get(); ring != nullptr && !requests.empty()) {
+        results = ring->open(requests);
+    }
+
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        open_request& request = requests[i];
+
+        // requests the ring never got to are opened the usual way
+        if (!results[i].has_value()) {
+            request.fides = open_wrapper(request.file, request.flags, request.perms);
+        } else if (results[i].value() < 0) {
+            cout_logger.log(jsh::LOG_LEVEL::ERROR, "Error occurred while opening file ", request.file, ": ", strerror_wrapper(-results[i].value()));
+        } else {
+            request.fides = std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(results[i].value()));
+        }
+
+        // once a file could not be opened the rest are not opened either, just like opening them one at a time
+        if (!request.fides.has_value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 auto syscall_wrapper::dup_wrapper(file_descriptor_wrapper const& fides) -> std::optional<file_descriptor_wrapper> {
     // call dup on the current file descriptor
-    int const new_fides = fcntl(fides._fides, F_DUPFD_CLOEXEC);
+    int const new_fides = fcntl(fides._fides, F_DUPFD_CLOEXEC, 0);
 
     // check to see if there was an error
     if (new_fides == -1) {
@@ -147,13 +177,254 @@ auto syscall_wrapper::read_wrapper(file_descriptor_wrapper const& fides, void* b
     return std::make_optional<ssize_t>(status);
 }
 
+auto syscall_wrapper::read_nonblocking_wrapper(file_descriptor_wrapper const& fides, void* buf, std::size_t count) -> std::optional<ssize_t> {
+    // perform the read
+    ssize_t status = read(fides._fides, buf, count);
+
+    // nothing being ready is not an error for a nonblocking file descriptor
+    if (status == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return std::make_optional<ssize_t>(0);
+    }
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Error while reading file descriptor: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<ssize_t>(status);
+}
+
+auto syscall_wrapper::write_wrapper(file_descriptor_wrapper const& fides, void const* buf, std::size_t count) -> std::optional<ssize_t> {
+    // perform the write
+    ssize_t status = write(fides._fides, buf, count);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Error while writing file descriptor: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<ssize_t>(status);
+}
+
+auto syscall_wrapper::lseek_wrapper(file_descriptor_wrapper const& fides, off_t offset, int whence) -> std::optional<off_t> {
+    // move the file offset
+    off_t const status = lseek(fides._fides, offset, whence);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to seek file descriptor: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<off_t>(status);
+}
+
+auto syscall_wrapper::memfd_create_wrapper(std::string const& name) -> std::optional<file_descriptor_wrapper> {
+    // create the file
+    int const fides = memfd_create(name.c_str(), MFD_CLOEXEC);
+
+    // error handle
+    if (fides == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to create memory file ", name, ": ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // create the new file descriptor
+    return std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(fides));
+}
+
+auto syscall_wrapper::mmap_shared_wrapper(std::size_t length) -> std::optional<void*> {
+    // map the memory
+    void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    // error handle
+    if (addr == MAP_FAILED) { // NOLINT MAP_FAILED is a cast in the system header
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to map shared memory: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<void*>(addr);
+}
+
+auto syscall_wrapper::mmap_file_wrapper(file_descriptor_wrapper const& fides, std::size_t length, off_t offset) -> std::optional<void*> {
+    // map the memory, populated up front since the kernel writes to it anyway
+    void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fides._fides, offset);
+
+    // error handle
+    if (addr == MAP_FAILED) { // NOLINT MAP_FAILED is a cast in the system header
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to map file: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<void*>(addr);
+}
+
+auto syscall_wrapper::mmap_read_wrapper(file_descriptor_wrapper const& fides, std::size_t length) -> std::optional<void*> {
+    // map the file, nothing is read until it is touched
+    void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fides._fides, 0);
+
+    // error handle
+    if (addr == MAP_FAILED) { // NOLINT MAP_FAILED is a cast in the system header
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to map file: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<void*>(addr);
+}
+
+auto syscall_wrapper::munmap_wrapper(void* addr, std::size_t length) -> bool {
+    // unmap the memory
+    int const status = munmap(addr, length);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to unmap shared memory: ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::read_file_wrapper(std::string const& path) -> std::optional<std::string> {
+    // missing attribute files are expected on some kernels, so they are not reported
+    std::error_code err;
+    if (!std::filesystem::exists(path, err)) {
+        return std::nullopt;
+    }
+
+    std::optional<file_descriptor_wrapper> const fides = open_wrapper(path, O_RDONLY | O_CLOEXEC, 0);
+    if (!fides.has_value()) {
+        return std::nullopt;
+    }
+
+    // attribute files are generated in one go, so a single read sees all of it
+    static constexpr std::size_t MAX_FILE_SIZE = 4096;
+    std::string contents(MAX_FILE_SIZE, '\0');
+    std::optional<ssize_t> const num_read = read_wrapper(fides.value(), contents.data(), contents.size());
+    if (!num_read.has_value()) {
+        return std::nullopt;
+    }
+    contents.resize(static_cast<std::size_t>(num_read.value()));
+
+    // success
+    return std::make_optional<std::string>(std::move(contents));
+}
+
+auto syscall_wrapper::mkdir_wrapper(std::string const& path, mode_t perms) -> bool {
+    // create the directory
+    int const status = mkdir(path.c_str(), perms);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to create directory ", path, ": ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::rmdir_wrapper(std::string const& path) -> bool {
+    // remove the directory
+    int const status = rmdir(path.c_str());
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::WARN, "Failed to remove directory ", path, ": ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::stat_wrapper(std::string const& path) -> std::optional<struct stat> {
+    struct stat info{};
+    int const status = stat(path.c_str(), &info);
+
+    // error handle, callers check for files which may not exist yet
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::DEBUG, "Failed to stat ", path, ": ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<struct stat>(info);
+}
+
+auto syscall_wrapper::is_executable_wrapper(std::string const& path, bool known_regular) -> bool {
+    // directories are never commands, even with the execute bit set
+    if (!known_regular) {
+        struct stat info{};
+        if (stat(path.c_str(), &info) == -1 || !S_ISREG(info.st_mode)) {
+            return false;
+        }
+    }
+
+    return access(path.c_str(), X_OK) == 0;
+}
+
+auto syscall_wrapper::fstat_wrapper(file_descriptor_wrapper const& fides) -> std::optional<struct stat> {
+    struct stat info{};
+    int const status = fstat(fides._fides, &info);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to stat file descriptor: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<struct stat>(info);
+}
+
+auto syscall_wrapper::flock_wrapper(file_descriptor_wrapper const& fides, int operation) -> bool {
+    // a signal may arrive while waiting for the lock
+    int status = -1;
+    do {
+        status = flock(fides._fides, operation);
+    } while (status == -1 && errno == EINTR);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to lock file: ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::rename_wrapper(std::string const& from, std::string const& to) -> bool {
+    // replace the file
+    int const status = rename(from.c_str(), to.c_str());
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to rename ", from, " to ", to, ": ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
 auto syscall_wrapper::isatty_wrapper(file_descriptor_wrapper const& fides) -> bool {
     // check if jsh is a terminal
     int const status = isatty(fides._fides);
 
-    // error handle
+    // not being a terminal is expected when running a script
     if (status != 1) {
-        cout_logger.log(jsh::LOG_LEVEL::WARN, "JSH is not running as a terminal: ", strerror_wrapper(errno));
+        cout_logger.log(jsh::LOG_LEVEL::DEBUG, "JSH is not running as a terminal: ", strerror_wrapper(errno));
         return false;
     }
 
@@ -199,6 +470,11 @@ auto syscall_wrapper::setpgid_wrapper(pid_t pid, pid_t pgid) -> bool {
     // try and set pgid
     int const status = setpgid(pid, pgid);
 
+    // a child which has already exec'd joined its group itself before doing so, so losing that race is not an error
+    if (status == -1 && errno == EACCES) {
+        return true;
+    }
+
     // error handle
     if (status == -1) {
         cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to set the process' process group id: ", strerror_wrapper(errno));
@@ -357,6 +633,315 @@ auto syscall_wrapper::poll_wrapper(std::vector<pollfd_wrapper>& fds, int timeout
     return std::make_optional<int>(num_fds);
 }
 
+auto syscall_wrapper::epoll_create_wrapper() -> std::optional<file_descriptor_wrapper> {
+    // create the epoll set
+    int const fides = epoll_create1(EPOLL_CLOEXEC);
+
+    // error handle
+    if (fides == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to create epoll set: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // create the new file descriptor
+    return std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(fides));
+}
+
+auto syscall_wrapper::epoll_ctl_wrapper(file_descriptor_wrapper const& epoll_fides, int op, file_descriptor_wrapper const& fides, std::uint32_t events, std::uint64_t data) -> bool {
+    // add, modify, or remove the file descriptor
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = data;
+    int const status = epoll_ctl(epoll_fides._fides, op, fides._fides, &event);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to update epoll set: ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::epoll_wait_wrapper(file_descriptor_wrapper const& epoll_fides, epoll_event* events, int max_events, int timeout) -> std::optional<int> {
+    // wait for events
+    int const num_events = epoll_wait(epoll_fides._fides, events, max_events, timeout);
+
+    // a signal handler ran, which is not an error
+    if (num_events == -1 && errno == EINTR) {
+        return std::make_optional<int>(0);
+    }
+
+    // error handle
+    if (num_events == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to wait on epoll set: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<int>(num_events);
+}
+
+auto syscall_wrapper::inotify_init_wrapper(int flags) -> std::optional<file_descriptor_wrapper> {
+    // create the inotify instance
+    int const fides = inotify_init1(flags);
+
+    // error handle
+    if (fides == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to create inotify instance: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // create the new file descriptor
+    return std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(fides));
+}
+
+auto syscall_wrapper::inotify_add_watch_wrapper(file_descriptor_wrapper const& fides, std::string const& path, std::uint32_t mask) -> std::optional<int> {
+    // add the watch
+    int const watch = inotify_add_watch(fides._fides, path.c_str(), mask);
+
+    // error handle
+    if (watch == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::WARN, "Failed to watch ", path, ": ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<int>(watch);
+}
+
+auto syscall_wrapper::inotify_rm_watch_wrapper(file_descriptor_wrapper const& fides, int watch) -> bool {
+    // remove the watch
+    int const status = inotify_rm_watch(fides._fides, watch);
+
+    // error handle, the watch is already gone if its directory was removed
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::DEBUG, "Failed to remove watch: ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::pidfd_open_wrapper(pid_t pid) -> std::optional<file_descriptor_wrapper> {
+    // glibc does not wrap pidfd_open on every system, so call it directly
+    auto const fides = static_cast<int>(syscall(SYS_pidfd_open, pid, 0)); // NOLINT
+
+    // error handle
+    if (fides == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::DEBUG, "Failed to open pidfd: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // create the new file descriptor
+    return std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(fides));
+}
+
+auto syscall_wrapper::timerfd_create_wrapper(int clockid, int flags) -> std::optional<file_descriptor_wrapper> {
+    // create the timer
+    int const fides = timerfd_create(clockid, flags);
+
+    // error handle
+    if (fides == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to create timer: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // create the new file descriptor
+    return std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(fides));
+}
+
+auto syscall_wrapper::timerfd_settime_wrapper(file_descriptor_wrapper const& fides, std::chrono::steady_clock::time_point deadline) -> bool {
+    // steady_clock is CLOCK_MONOTONIC, so the deadline can be used as an absolute time
+    auto const since_epoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+    auto const secs = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(secs.count());
+    spec.it_value.tv_nsec = static_cast<long>((since_epoch - secs).count()); // NOLINT timespec uses long
+
+    // a zero it_value disarms the timer, so make sure deadlines in the past still fire
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+        spec.it_value.tv_nsec = 1;
+    }
+
+    // arm the timer
+    int const status = timerfd_settime(fides._fides, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to arm timer: ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::get_pipe_size_wrapper(file_descriptor_wrapper const& fides) -> std::optional<int> {
+    // get the pipe's capacity
+    int const size = fcntl(fides._fides, F_GETPIPE_SZ);
+
+    // error handle
+    if (size == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to get the size of a pipe: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<int>(size);
+}
+
+auto syscall_wrapper::set_pipe_size_wrapper(file_descriptor_wrapper const& fides, int size) -> std::optional<int> {
+    // resize the pipe, the kernel rounds the size up to a power of two number of pages
+    int const new_size = fcntl(fides._fides, F_SETPIPE_SZ, size);
+
+    // error handle, EPERM and EBUSY leave the pipe usable at its old size
+    if (new_size == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::WARN, "Failed to resize a pipe to ", size, " bytes: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<int>(new_size);
+}
+
+auto syscall_wrapper::pipe_fill_wrapper(file_descriptor_wrapper const& fides) -> std::optional<int> {
+    // count the unread bytes
+    int fill = 0;
+    int const status = ioctl(fides._fides, FIONREAD, &fill);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to get the number of bytes in a pipe: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<int>(fill);
+}
+
+auto syscall_wrapper::sched_setaffinity_wrapper(pid_t pid, cpu_set_t const& set) -> bool {
+    // set the mask
+    int const status = sched_setaffinity(pid, sizeof(set), &set);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::WARN, "Failed to set the CPU affinity: ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::sched_getaffinity_wrapper(pid_t pid) -> std::optional<cpu_set_t> {
+    // get the mask
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int const status = sched_getaffinity(pid, sizeof(set), &set);
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to get the CPU affinity: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<cpu_set_t>(set);
+}
+
+auto syscall_wrapper::sched_getcpu_wrapper() -> std::optional<int> {
+    // find the current CPU
+    int const cpu = sched_getcpu();
+
+    // error handle
+    if (cpu == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to get the current CPU: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<int>(cpu);
+}
+
+auto syscall_wrapper::perf_event_open_wrapper(perf_event_attr& attr, pid_t pid) -> std::optional<file_descriptor_wrapper> {
+    // glibc does not wrap perf_event_open, so call it directly
+    auto const fides = static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC)); // NOLINT
+
+    // error handle, an unsupported event is expected on virtual machines and without a PMU
+    if (fides == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::DEBUG, "Failed to open perf event: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // create the new file descriptor
+    return std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(fides));
+}
+
+auto syscall_wrapper::io_uring_setup_wrapper(unsigned entries, io_uring_params& params) -> std::optional<file_descriptor_wrapper> {
+    // glibc does not wrap io_uring_setup, so call it directly, the ring is created close on exec
+    auto const fides = static_cast<int>(syscall(SYS_io_uring_setup, entries, &params)); // NOLINT
+
+    // error handle, io_uring is missing on old kernels and can be disabled by the administrator
+    if (fides == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::DEBUG, "Failed to set up io_uring: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // create the new file descriptor
+    return std::make_optional<file_descriptor_wrapper>(file_descriptor_wrapper(fides));
+}
+
+auto syscall_wrapper::io_uring_enter_wrapper(file_descriptor_wrapper const& ring_fides, unsigned to_submit, unsigned min_complete, unsigned flags) -> std::optional<int> {
+    // glibc does not wrap io_uring_enter, so call it directly
+    auto const submitted = static_cast<int>(syscall(SYS_io_uring_enter, ring_fides._fides, to_submit, min_complete, flags, nullptr, 0)); // NOLINT
+
+    // a signal arriving while waiting is not an error, the caller simply waits again
+    if (submitted == -1 && errno == EINTR) {
+        return std::make_optional<int>(0);
+    }
+
+    // error handle
+    if (submitted == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to enter io_uring: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    return std::make_optional<int>(submitted);
+}
+
+auto syscall_wrapper::chdir_wrapper(std::string const& path) -> bool {
+    // change directory
+    int const status = chdir(path.c_str());
+
+    // error handle
+    if (status == -1) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to change directory to ", path, ": ", strerror_wrapper(errno));
+        return false;
+    }
+
+    // success
+    return true;
+}
+
+auto syscall_wrapper::getcwd_wrapper() -> std::optional<std::string> {
+    // get the current working directory
+    std::array<char, PATH_MAX> buf{};
+    char const* const status = getcwd(buf.data(), buf.size());
+
+    // error handle
+    if (status == nullptr) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to get the current working directory: ", strerror_wrapper(errno));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<std::string>(buf.data());
+}
+
 auto syscall_wrapper::fork_wrapper() -> std::optional<pid_t> {
     // fork
     pid_t const pid = fork();
@@ -371,6 +956,82 @@ auto syscall_wrapper::fork_wrapper() -> std::optional<pid_t> {
     return std::make_optional<pid_t>(pid);
 }
 
+auto syscall_wrapper::spawn_wrapper(std::string const& path, std::vector<char*>& args, char* const* envp, std::optional<file_descriptor_wrapper> const& new_stdout, std::optional<file_descriptor_wrapper> const& new_stdin, std::optional<file_descriptor_wrapper> const& new_stderr, pid_t pgid, bool foreground) -> std::optional<pid_t> {
+    // the argument vector must be null terminated
+    assert(!args.empty() && args.back() == nullptr);
+
+    posix_spawnattr_t attr{};
+    posix_spawn_file_actions_t actions{};
+
+    // every step returns zero on success or an error number
+    int status = posix_spawnattr_init(&attr);
+    if (status != 0) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to create spawn attributes: ", strerror_wrapper(status));
+        return std::nullopt;
+    }
+
+    status = posix_spawn_file_actions_init(&actions);
+    if (status != 0) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to create spawn file actions: ", strerror_wrapper(status));
+        posix_spawnattr_destroy(&attr);
+        return std::nullopt;
+    }
+
+    // the job control signals are ignored by the shell, so they must be reset in the child
+    sigset_t default_sigs;
+    sigemptyset(&default_sigs);
+    for (int const sig : {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGCHLD}) {
+        sigaddset(&default_sigs, sig);
+    }
+
+    // the shell blocks signals it reads through a signalfd, the child should not inherit that mask
+    sigset_t mask;
+    sigemptyset(&mask);
+
+    short flags = POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK; // NOLINT posix_spawnattr_setflags takes a short
+    status = posix_spawnattr_setflags(&attr, flags);
+    status = status == 0 ? posix_spawnattr_setpgroup(&attr, pgid) : status;
+    status = status == 0 ? posix_spawnattr_setsigdefault(&attr, &default_sigs) : status;
+    status = status == 0 ? posix_spawnattr_setsigmask(&attr, &mask) : status;
+
+#if __GLIBC_PREREQ(2, 35)
+    // hand the terminal to the child's process group before any redirection replaces standard in
+    // the action fails the whole spawn when standard in is not a terminal, so only request it for one
+    if (status == 0 && foreground && isatty(STDIN_FILENO) == 1) {
+        status = posix_spawn_file_actions_addtcsetpgrp_np(&actions, STDIN_FILENO);
+    }
+#endif
+
+    // redirect the standard streams
+    if (status == 0 && new_stdout.has_value()) {
+        status = posix_spawn_file_actions_adddup2(&actions, new_stdout.value()._fides, STDOUT_FILENO);
+    }
+    if (status == 0 && new_stdin.has_value()) {
+        status = posix_spawn_file_actions_adddup2(&actions, new_stdin.value()._fides, STDIN_FILENO);
+    }
+    if (status == 0 && new_stderr.has_value()) {
+        status = posix_spawn_file_actions_adddup2(&actions, new_stderr.value()._fides, STDERR_FILENO);
+    }
+
+    // launch the binary
+    pid_t pid = -1;
+    if (status == 0) {
+        status = posix_spawn(&pid, path.c_str(), &actions, &attr, args.data(), envp);
+    }
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    // error handle
+    if (status != 0) {
+        cout_logger.log(jsh::LOG_LEVEL::ERROR, "Failed to spawn ", path, ": ", strerror_wrapper(status));
+        return std::nullopt;
+    }
+
+    // success
+    return std::make_optional<pid_t>(pid);
+}
+
 auto syscall_wrapper::strerror_wrapper(int err) -> bool {
     // call strerror_r
     char const* status = strerror_r(err, err_buf.data(), err_buf.size());
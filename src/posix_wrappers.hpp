@@ -92,6 +92,16 @@ class file_descriptor_wrapper {
     friend syscall_wrapper;
 };
 
+/**
+ * open_request: a file opened as part of a batch, fides holds the file descriptor once the batch has been opened
+ */
+struct open_request {
+    std::string file;
+    int flags;
+    mode_t perms;
+    std::optional<file_descriptor_wrapper> fides = std::nullopt;
+};
+
 /**
  * syscall_wrapper: a class full of static functions which safely wrap all the C-style syscalls
  */
@@ -143,6 +153,13 @@ class syscall_wrapper {
      */
     [[nodiscard]] static auto open_wrapper(std::string const& file, int flags, mode_t perms) -> std::optional<file_descriptor_wrapper>;
 
+    /**
+     * open_batch_wrapper: opens every request, through a single io_uring submission when the kernel supports it and one open at a time otherwise
+     *
+     * returns false if any of the files could not be opened, the ones which were opened are still stored in their requests
+     */
+    [[nodiscard]] static auto open_batch_wrapper(std::vector<open_request>& requests) -> bool;
+
     /**
      * dup_wrapper: a wrapper around the dup syscall in order to interface properly with the file_descriptor_wrapper
      */
@@ -163,6 +180,88 @@ class syscall_wrapper {
      */
     [[nodiscard]] static auto read_wrapper(file_descriptor_wrapper const& fides, void* buf, std::size_t count) -> std::optional<ssize_t>;
 
+    /**
+     * read_nonblocking_wrapper: read_wrapper for an O_NONBLOCK file descriptor, returns 0 instead of an error when nothing is ready
+     */
+    [[nodiscard]] static auto read_nonblocking_wrapper(file_descriptor_wrapper const& fides, void* buf, std::size_t count) -> std::optional<ssize_t>;
+
+    /**
+     * write_wrapper: wrapper around the write syscall
+     */
+    [[nodiscard]] static auto write_wrapper(file_descriptor_wrapper const& fides, void const* buf, std::size_t count) -> std::optional<ssize_t>;
+
+    /**
+     * lseek_wrapper: wrapper around the lseek syscall which returns the new offset
+     */
+    [[nodiscard]] static auto lseek_wrapper(file_descriptor_wrapper const& fides, off_t offset, int whence) -> std::optional<off_t>;
+
+    /**
+     * memfd_create_wrapper: wrapper around memfd_create which creates an anonymous file living in memory
+     */
+    [[nodiscard]] static auto memfd_create_wrapper(std::string const& name) -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * mmap_shared_wrapper: wrapper around mmap which maps anonymous memory shared with every child forked afterwards
+     */
+    [[nodiscard]] static auto mmap_shared_wrapper(std::size_t length) -> std::optional<void*>;
+
+    /**
+     * mmap_file_wrapper: wrapper around mmap which maps length bytes of fides at offset, shared with the kernel
+     */
+    [[nodiscard]] static auto mmap_file_wrapper(file_descriptor_wrapper const& fides, std::size_t length, off_t offset) -> std::optional<void*>;
+
+    /**
+     * mmap_read_wrapper: wrapper around mmap which maps the first length bytes of fides read only, pages are only read in once they are touched
+     */
+    [[nodiscard]] static auto mmap_read_wrapper(file_descriptor_wrapper const& fides, std::size_t length) -> std::optional<void*>;
+
+    /**
+     * munmap_wrapper: wrapper around the munmap syscall
+     */
+    [[nodiscard]] static auto munmap_wrapper(void* addr, std::size_t length) -> bool;
+
+    /**
+     * read_file_wrapper: reads a small file such as a sysfs or cgroup attribute in one read, std::nullopt if it does not exist
+     */
+    [[nodiscard]] static auto read_file_wrapper(std::string const& path) -> std::optional<std::string>;
+
+    /**
+     * mkdir_wrapper: wrapper around the mkdir syscall
+     */
+    [[nodiscard]] static auto mkdir_wrapper(std::string const& path, mode_t perms) -> bool;
+
+    /**
+     * rmdir_wrapper: wrapper around the rmdir syscall
+     */
+    [[nodiscard]] static auto rmdir_wrapper(std::string const& path) -> bool;
+
+    /**
+     * stat_wrapper: wrapper around the stat syscall, a missing file is not reported
+     */
+    [[nodiscard]] static auto stat_wrapper(std::string const& path) -> std::optional<struct stat>;
+
+    /**
+     * is_executable_wrapper: whether path is a regular file the shell may execute, the same test exec makes, a missing file is not reported
+     *
+     * known_regular: the caller already knows path is a regular file, which saves the stat
+     */
+    [[nodiscard]] static auto is_executable_wrapper(std::string const& path, bool known_regular = false) -> bool;
+
+    /**
+     * fstat_wrapper: wrapper around the fstat syscall
+     */
+    [[nodiscard]] static auto fstat_wrapper(file_descriptor_wrapper const& fides) -> std::optional<struct stat>;
+
+    /**
+     * flock_wrapper: wrapper around the flock syscall which retries when interrupted
+     */
+    [[nodiscard]] static auto flock_wrapper(file_descriptor_wrapper const& fides, int operation) -> bool;
+
+    /**
+     * rename_wrapper: wrapper around the rename syscall, which atomically replaces to
+     */
+    [[nodiscard]] static auto rename_wrapper(std::string const& from, std::string const& to) -> bool;
+
     /**
      * isatty_wrapper: a wrapper which allows for error handling on the isatty sycall
      */
@@ -238,11 +337,130 @@ class syscall_wrapper {
      */
     [[nodiscard]] static auto poll_wrapper(std::vector<pollfd_wrapper>& fds, int timeout) -> std::optional<int>;
 
+    /**
+     * epoll_create_wrapper: wrapper around epoll_create1 which creates a close on exec epoll set
+     */
+    [[nodiscard]] static auto epoll_create_wrapper() -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * epoll_ctl_wrapper: wrapper around epoll_ctl, data is handed back by epoll_wait_wrapper whenever fides is ready
+     */
+    [[nodiscard]] static auto epoll_ctl_wrapper(file_descriptor_wrapper const& epoll_fides, int op, file_descriptor_wrapper const& fides, std::uint32_t events, std::uint64_t data) -> bool;
+
+    /**
+     * epoll_wait_wrapper: wrapper around epoll_wait which fills events, an interrupted wait returns no events
+     */
+    [[nodiscard]] static auto epoll_wait_wrapper(file_descriptor_wrapper const& epoll_fides, epoll_event* events, int max_events, int timeout) -> std::optional<int>;
+
+    /**
+     * inotify_init_wrapper: wrapper around the inotify_init1 syscall
+     */
+    [[nodiscard]] static auto inotify_init_wrapper(int flags) -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * inotify_add_watch_wrapper: wrapper around the inotify_add_watch syscall which returns the watch descriptor events for path are tagged with
+     */
+    [[nodiscard]] static auto inotify_add_watch_wrapper(file_descriptor_wrapper const& fides, std::string const& path, std::uint32_t mask) -> std::optional<int>;
+
+    /**
+     * inotify_rm_watch_wrapper: wrapper around the inotify_rm_watch syscall
+     */
+    [[nodiscard]] static auto inotify_rm_watch_wrapper(file_descriptor_wrapper const& fides, int watch) -> bool;
+
+    /**
+     * pidfd_open_wrapper: wrapper around the pidfd_open syscall, the returned file descriptor becomes readable once the process exits
+     */
+    [[nodiscard]] static auto pidfd_open_wrapper(pid_t pid) -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * timerfd_create_wrapper: wrapper around the timerfd_create syscall
+     */
+    [[nodiscard]] static auto timerfd_create_wrapper(int clockid, int flags) -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * timerfd_settime_wrapper: arms a timer file descriptor to expire once at the absolute time deadline on its clock
+     */
+    [[nodiscard]] static auto timerfd_settime_wrapper(file_descriptor_wrapper const& fides, std::chrono::steady_clock::time_point deadline) -> bool;
+
+    /**
+     * get_pipe_size_wrapper: wrapper around fcntl F_GETPIPE_SZ which returns the capacity of a pipe in bytes
+     */
+    [[nodiscard]] static auto get_pipe_size_wrapper(file_descriptor_wrapper const& fides) -> std::optional<int>;
+
+    /**
+     * set_pipe_size_wrapper: wrapper around fcntl F_SETPIPE_SZ which returns the capacity the kernel actually gave the pipe
+     */
+    [[nodiscard]] static auto set_pipe_size_wrapper(file_descriptor_wrapper const& fides, int size) -> std::optional<int>;
+
+    /**
+     * pipe_fill_wrapper: wrapper around ioctl FIONREAD which returns the number of unread bytes in a pipe
+     */
+    [[nodiscard]] static auto pipe_fill_wrapper(file_descriptor_wrapper const& fides) -> std::optional<int>;
+
+    /**
+     * sched_setaffinity_wrapper: wrapper around the sched_setaffinity syscall, 0 for pid sets the mask of the calling thread
+     */
+    [[nodiscard]] static auto sched_setaffinity_wrapper(pid_t pid, cpu_set_t const& set) -> bool;
+
+    /**
+     * sched_getaffinity_wrapper: wrapper around the sched_getaffinity syscall, 0 for pid gets the mask of the calling thread
+     */
+    [[nodiscard]] static auto sched_getaffinity_wrapper(pid_t pid) -> std::optional<cpu_set_t>;
+
+    /**
+     * sched_getcpu_wrapper: wrapper around sched_getcpu which returns the CPU the calling thread is running on
+     */
+    [[nodiscard]] static auto sched_getcpu_wrapper() -> std::optional<int>;
+
+    /**
+     * perf_event_open_wrapper: wrapper around the perf_event_open syscall which counts the event described by attr for pid on any CPU
+     */
+    [[nodiscard]] static auto perf_event_open_wrapper(perf_event_attr& attr, pid_t pid) -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * io_uring_setup_wrapper: wrapper around the io_uring_setup syscall, params is filled with the layout of the rings
+     */
+    [[nodiscard]] static auto io_uring_setup_wrapper(unsigned entries, io_uring_params& params) -> std::optional<file_descriptor_wrapper>;
+
+    /**
+     * io_uring_enter_wrapper: wrapper around the io_uring_enter syscall which returns the number of entries submitted, an interrupted wait submits none
+     */
+    [[nodiscard]] static auto io_uring_enter_wrapper(file_descriptor_wrapper const& ring_fides, unsigned to_submit, unsigned min_complete, unsigned flags) -> std::optional<int>;
+
+    /**
+     * chdir_wrapper: wrapper around the chdir syscall
+     */
+    [[nodiscard]] static auto chdir_wrapper(std::string const& path) -> bool;
+
+    /**
+     * getcwd_wrapper: wrapper around the getcwd syscall which returns the current working directory
+     */
+    [[nodiscard]] static auto getcwd_wrapper() -> std::optional<std::string>;
+
     /**
      * fork_wrapper: wrapper around the fork syscall
      */
     [[nodiscard]] static auto fork_wrapper() -> std::optional<pid_t>;
 
+    /**
+     * spawn_wrapper: wrapper around posix_spawn which launches a binary without copying the shell's address space
+     *
+     * path: the path to the binary
+     *
+     * args: the null terminated argument vector for the binary
+     *
+     * envp: the null terminated environment for the binary
+     *
+     * new_stdout, new_stdin, new_stderr: file descriptors which will be duplicated over the child's standard streams
+     *
+     * pgid: the process group the child is placed in, 0 to make the child the leader of a new group
+     *
+     * foreground: whether the child's process group should take control of the terminal
+     *
+     * note: job control signals are reset to their defaults and the signal mask is cleared in the child
+     */
+    [[nodiscard]] static auto spawn_wrapper(std::string const& path, std::vector<char*>& args, char* const* envp, std::optional<file_descriptor_wrapper> const& new_stdout, std::optional<file_descriptor_wrapper> const& new_stdin, std::optional<file_descriptor_wrapper> const& new_stderr, pid_t pgid, bool foreground) -> std::optional<pid_t>;
+
     /**
      * strerror_wrapper: wrapper around the strerror syscall which uses strerror_r to be thread safe
      */
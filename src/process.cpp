@@ -1,7 +1,13 @@
 #include "process.hpp"
+#include "job_table.hpp"
 #include "shell.hpp" // required to be here for non-cyclic includes
 
 namespace jsh {
+std::optional<file_descriptor_wrapper> process::child_signals = std::nullopt;
+reactor* process::events = nullptr;
+bool process::collecting = false;
+bool process::interrupted = false;
+
 process::shell_internal_redirection::shell_internal_redirection(std::optional<file_descriptor_wrapper> stdout, std::optional<file_descriptor_wrapper> stdin, std::optional<file_descriptor_wrapper> stderr, bool restore) : new_stdout{std::move(stdout)}, new_stdin{std::move(stdin)}, new_stderr{std::move(stderr)}, og_stdout{std::nullopt}, og_stdin{std::nullopt}, og_stderr{std::nullopt}, _restore{restore} {
     // check for a different stdout
     if (new_stdout.has_value()) {
@@ -96,12 +102,21 @@ process::shell_internal_redirection::~shell_internal_redirection() {
     }
 }
 
-auto process::parse_process(std::string const& input) -> std::optional<std::unique_ptr<process_data>> {
+auto process::parse_process(std::string const& input, std::vector<redirection>* deferred) -> std::optional<std::unique_ptr<process_data>> {
+    token_stream const stream = lexer::lex(input);
+    if (stream.error) {
+        cout_logger.log(LOG_LEVEL::ERROR, "Invalid process input...");
+        return std::nullopt;
+    }
+    return parse_process(stream.tokens, deferred);
+}
+
+auto process::parse_process(std::span<token const> tokens, std::vector<redirection>* deferred) -> std::optional<std::unique_ptr<process_data>> {
     auto proc_data = std::make_unique<process_data>();
 
     // stack allocated variables
-    std::string arg;
     std::vector<std::string> args;
+    args.reserve(tokens.size());
 
     // file descriptors
     std::optional<file_descriptor_wrapper> proc_stdout = std::nullopt;
@@ -111,179 +126,85 @@ auto process::parse_process(std::string const& input) -> std::optional<std::uniq
     // parse the command into different components
     static constexpr mode_t FILE_MODE = 0777;
 
-    // parsing state
-    std::stack<PARSE_STATE> curr_state{};
-    // default behavior should be REGULAR mode
-    curr_state.push(PARSE_STATE::REGULAR);
-    for (char const chr : input) {
-        assert(!curr_state.empty()); // this should be true since we dont pop in REGULAR
-        assert(static_cast<char>(curr_state.top()) < PARSE_STATE::COUNT);
-
-        auto add_current_arg = [&]() {
-            if (!arg.empty()) {
-                args.emplace_back(std::move(arg));
-                arg = std::string{};
-            }
-        };
-        switch (curr_state.top()) {
-        case PARSE_STATE::REGULAR: {
-            // if we encounter white space we want to move push back out new argument and clear it
-            if (static_cast<bool>(std::isspace(chr))) {
-                add_current_arg();
-            } else if (chr == INPUT_REDIRECTION) { // transition to input filename
-                add_current_arg();                 // the redirection characters will act like whitespace
-                curr_state.push(PARSE_STATE::INPUT_FILENAME);
-            } else if (chr == OUTPUT_REDIRECTION) { // transition to output filename
-                add_current_arg();                  // the redirection characters will act like whitespace
-                curr_state.push(PARSE_STATE::OUTPUT_FILENAME);
-            } else if (chr == SINGLE_QUOTE) { // transition to single quote state
-                curr_state.push(PARSE_STATE::QUOTE);
-            } else if (chr == DOUBLE_QUOTE) { // transition to double quote state
-                curr_state.push(PARSE_STATE::DBL_QUOTE);
-            } else if (chr == ESCAPE) { // if we encounter a a backslash escape next char
-                curr_state.push(PARSE_STATE::ESCAPED_CHARACTER);
-            } else { // append the character
-                arg += chr;
-            }
-
-            break;
+    // opens the file named by filename now, or leaves it for the job to open along with the files of its other stages
+    auto redirect = [&](std::string_view filename, bool output) -> bool {
+        cout_logger.log(LOG_LEVEL::DEBUG, "Attempting to open file ", filename, output ? " for writing..." : " for reading...");
+        int const flags = output ? O_WRONLY | O_CREAT | O_TRUNC : O_RDONLY;
+        if (deferred != nullptr) {
+            deferred->push_back(redirection{.stage = 0, .output = output, .request = open_request{.file = std::string{filename}, .flags = flags, .perms = FILE_MODE}});
+            return true;
         }
-        case PARSE_STATE::INPUT_FILENAME: {
-            // if we encounter a boundary we want create the filename
-            if (static_cast<bool>(std::isspace(chr)) || chr == INPUT_REDIRECTION || chr == OUTPUT_REDIRECTION) {
-                if (!arg.empty()) {
-                    cout_logger.log(LOG_LEVEL::DEBUG, "Attempting to open file ", arg, " for reading...");
-                    proc_stdin = syscall_wrapper::open_wrapper(arg, O_RDONLY, FILE_MODE);
-
-                    if (!proc_stdin.has_value()) {
-                        return std::nullopt;
-                    }
-                    curr_state.pop();
-                }
 
-                // if we are IO redirection then push another state
-                if (chr == INPUT_REDIRECTION) {
-                    curr_state.push(PARSE_STATE::INPUT_FILENAME);
-                } else if (chr == OUTPUT_REDIRECTION) {
-                    curr_state.push(PARSE_STATE::OUTPUT_FILENAME);
-                }
-                arg.clear();
-            } else if (chr == SINGLE_QUOTE) { // transition to single quote state
-                curr_state.push(PARSE_STATE::QUOTE);
-            } else if (chr == DOUBLE_QUOTE) { // transition to double quote state
-                curr_state.push(PARSE_STATE::DBL_QUOTE);
-            } else if (chr == ESCAPE) { // if we encounter a a backslash escape next char
-                curr_state.push(PARSE_STATE::ESCAPED_CHARACTER);
-            } else { // append the character
-                arg += chr;
-            }
-            break;
-        }
-        case PARSE_STATE::OUTPUT_FILENAME: {
-            // if we encounter a boundary character we want create the filename
-            if (static_cast<bool>(std::isspace(chr)) || chr == INPUT_REDIRECTION || chr == OUTPUT_REDIRECTION) {
-                if (!arg.empty()) {
-                    cout_logger.log(LOG_LEVEL::DEBUG, "Attempting to open file ", arg, " for writing...");
-                    proc_stdout = syscall_wrapper::open_wrapper(arg, O_WRONLY | O_CREAT | O_TRUNC, FILE_MODE);
-
-                    if (!proc_stdout.has_value()) {
-                        return std::nullopt;
-                    }
-                    curr_state.pop();
-                }
+        std::optional<file_descriptor_wrapper>& target = output ? proc_stdout : proc_stdin;
+        target = syscall_wrapper::open_wrapper(std::string{filename}, flags, FILE_MODE);
+        return target.has_value();
+    };
 
-                // if we are IO redirection then push another state
-                if (chr == INPUT_REDIRECTION) {
-                    curr_state.push(PARSE_STATE::INPUT_FILENAME);
-                } else if (chr == OUTPUT_REDIRECTION) {
-                    curr_state.push(PARSE_STATE::OUTPUT_FILENAME);
-                }
-                arg.clear();
-            } else if (chr == SINGLE_QUOTE) { // transition to single quote state
-                curr_state.push(PARSE_STATE::QUOTE);
-            } else if (chr == DOUBLE_QUOTE) { // transition to double quote state
-                curr_state.push(PARSE_STATE::DBL_QUOTE);
-            } else if (chr == ESCAPE) { // if we encounter a a backslash escape next char
-                curr_state.push(PARSE_STATE::ESCAPED_CHARACTER);
-            } else { // append the character
-                arg += chr;
+    for (std::size_t idx = 0; idx < tokens.size(); ++idx) {
+        token const& tok = tokens[idx];
+
+        // a redirection takes the word after it as its filename, in a run of them (>>>) the last one does
+        if (tok.kind == TOKEN_KIND::INPUT_REDIRECTION || tok.kind == TOKEN_KIND::OUTPUT_REDIRECTION) {
+            bool const chained = idx + 1 < tokens.size() && (tokens[idx + 1].kind == TOKEN_KIND::INPUT_REDIRECTION || tokens[idx + 1].kind == TOKEN_KIND::OUTPUT_REDIRECTION);
+            if (chained) {
+                continue;
             }
-            break;
-        }
-        case PARSE_STATE::QUOTE: {
-            if (chr == SINGLE_QUOTE) { // close single quote
-                curr_state.pop();
-            } else if (chr == ESCAPE) { // if we encounter a a backslash escape next char
-                curr_state.push(PARSE_STATE::ESCAPED_CHARACTER);
-            } else { // append the character
-                arg += chr;
+            if (idx + 1 == tokens.size() || tokens[idx + 1].kind != TOKEN_KIND::WORD || tokens[idx + 1].value.empty()) {
+                cout_logger.log(LOG_LEVEL::ERROR, "No filename provided...");
+                return std::nullopt;
             }
-            break;
-        }
-        case PARSE_STATE::DBL_QUOTE: {
-            if (chr == DOUBLE_QUOTE) { // close double quote
-                curr_state.pop();
-            } else if (chr == ESCAPE) { // if we encounter a a backslash escape next char
-                curr_state.push(PARSE_STATE::ESCAPED_CHARACTER);
-            } else { // append the character
-                arg += chr;
+
+            ++idx;
+            if (!redirect(tokens[idx].value, tok.kind == TOKEN_KIND::OUTPUT_REDIRECTION)) {
+                return std::nullopt;
             }
-            break;
-        }
-        case PARSE_STATE::ESCAPED_CHARACTER: {
-            // add the character to the argument
-            arg += chr;
-            curr_state.pop();
-            break;
-        }
-        case PARSE_STATE::COUNT: {
-            // we should never get here
-            assert(false);
-            break;
+            continue;
         }
+
+        // an operator which did not split the job (a & in the middle of a command) is a literal argument, and a word which unquotes to nothing is dropped
+        std::string_view const arg = tok.kind == TOKEN_KIND::WORD ? tok.value : tok.text;
+        if (!arg.empty()) {
+            args.emplace_back(arg);
         }
     }
 
-    // check to make sure for errors
-    if (curr_state.top() == PARSE_STATE::QUOTE || curr_state.top() == PARSE_STATE::DBL_QUOTE || curr_state.top() == PARSE_STATE::ESCAPED_CHARACTER) {
-        cout_logger.log(LOG_LEVEL::ERROR, "Invalid process input...");
-        return std::nullopt;
-    }
+    // a lone NAME=value is an assignment rather than a binary
+    std::size_t const name_length = args.size() == 1 ? parsing::name_length(args[0]) : 0;
+    bool const is_assignment = name_length > 0 && name_length + 1 < args[0].size() && args[0][name_length] == EQUALS;
 
-    if ((curr_state.top() == PARSE_STATE::OUTPUT_FILENAME || curr_state.top() == PARSE_STATE::INPUT_FILENAME) && arg.empty()) {
-        cout_logger.log(LOG_LEVEL::ERROR, "No filename provided...");
-        return std::nullopt;
-    }
+    // search for shell built-ins
+    // otherwise, treat as binary
+    auto const* job_control_itr = args.empty() ? std::end(JOB_CONTROL_BUILTIN_STR) : std::ranges::find(JOB_CONTROL_BUILTIN_STR, std::string_view(args[0]));
+    if (job_control_itr != std::end(JOB_CONTROL_BUILTIN_STR)) { // jobs, wait, fg, bg
+        *proc_data = job_control_data{};
 
-    // create leftover filenames
-    if (curr_state.top() == PARSE_STATE::INPUT_FILENAME && !arg.empty()) {
-        proc_stdin = syscall_wrapper::open_wrapper(arg, O_RDONLY, FILE_MODE);
+        assert(std::holds_alternative<job_control_data>(*proc_data));
 
-        if (!proc_stdin.has_value()) {
-            return std::nullopt;
-        }
+        auto& data = std::get<job_control_data>(*proc_data);
 
-        arg.clear();
-    }
+        // set IO redirection
+        data.stdout = std::move(proc_stdout);
+        data.stdin = std::move(proc_stdin);
+        data.stderr = std::move(proc_stderr);
 
-    if (curr_state.top() == PARSE_STATE::OUTPUT_FILENAME && !arg.empty()) {
-        proc_stdout = syscall_wrapper::open_wrapper(arg, O_WRONLY | O_CREAT | O_TRUNC, FILE_MODE);
+        // the builtin and the job specifications it was given
+        data.kind = static_cast<JOB_CONTROL>(job_control_itr - std::begin(JOB_CONTROL_BUILTIN_STR));
+        data.args.assign(std::make_move_iterator(std::begin(args) + 1), std::make_move_iterator(std::end(args)));
+    } else if (!args.empty() && args[0] == HASH_BUILTIN) { // hash
+        *proc_data = hash_data{};
 
-        if (!proc_stdout.has_value()) {
-            return std::nullopt;
-        }
+        assert(std::holds_alternative<hash_data>(*proc_data));
 
-        arg.clear();
-    }
+        auto& data = std::get<hash_data>(*proc_data);
 
-    // add any leftover arguments
-    if (!arg.empty()) {
-        args.push_back(std::move(arg));
-    }
+        // set IO redirection
+        data.stdout = std::move(proc_stdout);
+        data.stdin = std::move(proc_stdin);
+        data.stderr = std::move(proc_stderr);
 
-    // search for shell built-ins
-    // otherwise, treat as binary
-    if (!args.empty() && args[0] == EXPORT_BUILTIN) { // export
+        // hash only understands the clear flag
+        data.clear = args.size() > 1 && args[1] == HASH_CLEAR_FLAG;
+    } else if (!args.empty() && args[0] == EXPORT_BUILTIN) { // export
         *proc_data = export_data{};
 
         assert(std::holds_alternative<export_data>(*proc_data));
@@ -318,6 +239,37 @@ auto process::parse_process(std::string const& input) -> std::optional<std::uniq
         // get the variable name
         data.name = args[1].substr(0, idx);
         data.val = args[1].substr(idx + 1, args[1].size());
+    } else if (is_assignment) { // NAME=value
+        *proc_data = export_data{};
+
+        assert(std::holds_alternative<export_data>(*proc_data));
+
+        auto& data = std::get<export_data>(*proc_data);
+
+        // set IO redirection
+        data.stdout = std::move(proc_stdout);
+        data.stdin = std::move(proc_stdin);
+        data.stderr = std::move(proc_stderr);
+
+        // an assignment without export sets a variable only the shell sees, unless it was already exported
+        data.name = args[0].substr(0, name_length);
+        data.val = args[0].substr(name_length + 1);
+        data.exported = false;
+    } else if (std::optional<builtin_function> const function = args.empty() ? std::nullopt : builtins::find(args[0]); function.has_value()) { // echo, true, false, pwd, cd, printf
+        *proc_data = builtin_data{};
+
+        assert(std::holds_alternative<builtin_data>(*proc_data));
+
+        auto& data = std::get<builtin_data>(*proc_data);
+
+        // set IO redirection
+        data.stdout = std::move(proc_stdout);
+        data.stdin = std::move(proc_stdin);
+        data.stderr = std::move(proc_stderr);
+
+        // the builtin keeps its own name as its first argument, like a binary would
+        data.function = function.value();
+        data.args = std::move(args);
     } else { // regular binary
         *proc_data = binary_data{};
 
@@ -337,7 +289,7 @@ auto process::parse_process(std::string const& input) -> std::optional<std::uniq
     return proc_data;
 }
 
-void process::execute_process(binary_data& data) {
+auto process::launch_process(binary_data& data) -> std::optional<pid_t> {
     // we should not accept any nullptrs to this function
     assert(data.pgid != nullptr);
 
@@ -345,7 +297,7 @@ void process::execute_process(binary_data& data) {
     std::vector<char*> args_ptr;
 
     // push back all of the pointers to the arguments
-    args_ptr.reserve(data.args.size());
+    args_ptr.reserve(data.args.size() + 1);
     for (auto& arg : data.args) {
         args_ptr.push_back(arg.data());
     }
@@ -353,171 +305,570 @@ void process::execute_process(binary_data& data) {
     // add the sentinal to the end of the arguments
     args_ptr.push_back(nullptr);
 
-    // fork into another subprocess to execute the binary
-    std::optional<pid_t> pid_op = syscall_wrapper::fork_wrapper();
-    if (!pid_op.has_value()) {
-        return;
-    }
-    pid_t const& pid = pid_op.value();
+    // find the binary through the command hash instead of letting exec walk PATH
+    std::optional<std::string> const path = command_hash::lookup(data.args[0]);
 
-    if (static_cast<bool>(pid)) { // parent
-        // update the process id for the new process if it is the first one/its pointer is nullptr
-        if (*data.pgid == -1) {
-            *data.pgid = pid;
+    // the exported variables are only rebuilt into an envp here in the shell, rather than in every child, when one of them changed
+    char* const* const envp = environment::envp();
+
+    // start the child with the backend selected by the user, a child held on an exec gate can only be forked
+    LAUNCH_BACKEND const backend = data.exec_gate.has_value() ? LAUNCH_BACKEND::FORK : launch_backend();
+    std::optional<pid_t> pid_op = std::nullopt;
+    if (!path.has_value()) {
+        cout_logger.log(LOG_LEVEL::ERROR, "Command not found: ", data.args[0]);
+    } else if (backend == LAUNCH_BACKEND::SPAWN) {
+        // posix_spawn has no affinity attribute, but the child inherits the shell's mask, so the shell borrows the stage's mask while spawning
+        std::optional<cpu_set_t> const shell_affinity = data.affinity.has_value() ? syscall_wrapper::sched_getaffinity_wrapper(0) : std::nullopt;
+        if (shell_affinity.has_value()) {
+            std::ignore = syscall_wrapper::sched_setaffinity_wrapper(0, data.affinity.value());
         }
 
-        // set the child process' process group id in parent to prevent race conditions
-        bool status = syscall_wrapper::setpgid_wrapper(pid, *data.pgid);
+        // spawn places the child in its process group and hands it the terminal before exec
+        pid_op = syscall_wrapper::spawn_wrapper(path.value(), args_ptr, envp, data.stdout, data.stdin, data.stderr, *data.pgid == -1 ? 0 : *data.pgid, data.is_foreground);
 
-        // error handle
-        if (!status) {
-            return;
+        if (shell_affinity.has_value()) {
+            std::ignore = syscall_wrapper::sched_setaffinity_wrapper(0, shell_affinity.value());
         }
 
-        // set the child process to control the terminal
-        if (data.is_foreground) {
-            status = syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, *data.pgid);
-
-            if (!status) {
-                return;
-            }
+        // posix_spawn can not place the child in a cgroup either, so it is moved in as soon as it exists
+        if (pid_op.has_value() && data.cgroup != nullptr) {
+            std::ignore = data.cgroup->add(pid_op.value());
+        }
+    } else {
+        // fork into another subprocess to execute the binary
+        pid_op = syscall_wrapper::fork_wrapper();
+        if (pid_op.has_value() && pid_op.value() == 0) { // child
+            exec_child(data, path.value(), args_ptr, envp);
         }
+    }
 
-        // send continue signal to child process group
-        status = syscall_wrapper::kill_wrapper(-*data.pgid, SIGCONT);
+    // parent
+    // close the parent's copies of the file descriptors so readers further down the pipeline see EOF
+    data.stdout = std::nullopt;
+    data.stdin = std::nullopt;
+    data.stderr = std::nullopt;
+    data.exec_gate = std::nullopt;
 
-        if (!status) {
-            return;
+    // the child is in the cgroup now, only the job keeps the leaf alive
+    data.cgroup = nullptr;
+
+    // error handle
+    if (!pid_op.has_value()) {
+        return std::nullopt;
+    }
+    pid_t const pid = pid_op.value();
+
+    // update the process id for the new process if it is the first one/its pointer is nullptr
+    if (*data.pgid == -1) {
+        *data.pgid = pid;
+    }
+
+    // set the child process' process group id in parent to prevent race conditions
+    // a spawned child has already exec'd inside of its process group, so this is only needed for fork
+    if (backend == LAUNCH_BACKEND::FORK && !syscall_wrapper::setpgid_wrapper(pid, *data.pgid)) {
+        return pid;
+    }
+
+    // set the child process to control the terminal
+    if (data.is_foreground && !syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, *data.pgid)) {
+        return pid;
+    }
+
+    // send continue signal to child process group
+    std::ignore = syscall_wrapper::kill_wrapper(-*data.pgid, SIGCONT);
+
+    return pid;
+}
+
+auto process::launch_builtin(builtin_data& data) -> std::optional<pid_t> {
+    // we should not accept any nullptrs to this function
+    assert(data.pgid != nullptr);
+
+    // fork a copy of the shell to run the builtin
+    std::optional<pid_t> const pid_op = syscall_wrapper::fork_wrapper();
+    if (pid_op.has_value() && pid_op.value() == 0) { // child
+        prepare_child(data);
+
+        int status = EXIT_FAILURE;
+        { // sir scope
+            shell_internal_redirection const sir(std::move(data.stdout), std::move(data.stdin), std::move(data.stderr), false);
+            status = data.function(data.args);
+        } // sir scope
+
+        // the copy of the shell must never return into the shell loop
+        _exit(status);
+    }
+
+    // parent
+    // close the parent's copies of the file descriptors so readers further down the pipeline see EOF
+    data.stdout = std::nullopt;
+    data.stdin = std::nullopt;
+    data.stderr = std::nullopt;
+    data.exec_gate = std::nullopt;
+
+    // the child is in the cgroup now, only the job keeps the leaf alive
+    data.cgroup = nullptr;
+
+    // error handle
+    if (!pid_op.has_value()) {
+        return std::nullopt;
+    }
+    pid_t const pid = pid_op.value();
+
+    // join the pipeline's process group from the parent as well to prevent race conditions
+    if (*data.pgid == -1) {
+        *data.pgid = pid;
+    }
+    std::ignore = syscall_wrapper::setpgid_wrapper(pid, *data.pgid);
+    if (data.is_foreground) {
+        std::ignore = syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, *data.pgid);
+    }
+
+    return pid;
+}
+
+void process::prepare_child(default_data& data) {
+    std::optional<pid_t> cur_pid = syscall_wrapper::getpid_wrapper();
+    assert(cur_pid.has_value()); // this should always pass since it getpid shouldn't fail
+
+    // if the pgid is nullptr, then this is the first process and we should make its PID the
+    // PGID since it will be the process leader
+    if (*data.pgid == -1) {
+        *data.pgid = cur_pid.value();
+    }
+
+    // set the current process' process group id
+    // if this is the first process being launched then it will be the process leader and cur_pid.value() == data.pgid
+    bool status = syscall_wrapper::setpgid_wrapper(cur_pid.value(), *data.pgid);
+
+    // error handle
+    if (!status) {
+        _exit(EXIT_FAILURE);
+    }
+
+    // if the process is running in the foreground, then it gets access to the terminal
+    // the parent makes the same request, so a failure here is not fatal to the child
+    if (data.is_foreground) {
+        std::ignore = syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, *data.pgid);
+    }
+
+    // join the job's cgroup before exec so everything the child starts is accounted to the job
+    if (data.cgroup != nullptr) {
+        std::ignore = data.cgroup->join();
+    }
+
+    // pin the child before it execs, failing to do so only costs placement
+    if (data.affinity.has_value()) {
+        std::ignore = syscall_wrapper::sched_setaffinity_wrapper(0, data.affinity.value());
+    }
+
+    // listen to job control signals
+    if (!reset_signals()) {
+        _exit(EXIT_FAILURE);
+    }
+
+    // wait until the shell has attached its counters, the shell releases the child even if attaching failed
+    if (data.exec_gate.has_value()) {
+        char release = 0;
+        std::ignore = syscall_wrapper::read_wrapper(data.exec_gate.value(), &release, sizeof(release));
+        data.exec_gate = std::nullopt;
+    }
+}
+
+void process::exec_child(binary_data& data, std::string const& path, std::vector<char*>& args_ptr, char* const* envp) {
+    // join the process group and take the terminal
+    prepare_child(data);
+
+    { // sir scope
+        shell_internal_redirection const sir(std::move(data.stdout), std::move(data.stdin), std::move(data.stderr), false);
+
+        int const exit_code = execve(path.c_str(), args_ptr.data(), envp);
+
+        // execve only returns if there was an error
+        assert(exit_code == -1);
+    } // sir scope
+
+    // log that this command was invalid
+    jsh::cout_logger.log(jsh::LOG_LEVEL::ERROR, "Executing command failed...");
+
+    // the child must never return into the shell, otherwise it would keep running the rest of the job
+    _exit(COMMAND_NOT_FOUND_STATUS);
+}
+
+auto process::wait_process(pid_t pid) -> std::optional<int> {
+    // block until the child exits or is stopped
+    int wait_status = 0;
+    pid_t const exit_code = waitpid(pid, &wait_status, WUNTRACED);
+
+    // check for errors
+    if (exit_code != pid) {
+        jsh::cout_logger.log(jsh::LOG_LEVEL::ERROR, "Waiting on PID ", pid, " failed: ", syscall_wrapper::strerror_wrapper(errno), '\n');
+        return std::nullopt;
+    }
+
+    return std::make_optional<int>(wait_status);
+}
+
+auto process::supervise(std::vector<pid_t> const& pids, pid_t pgid, std::optional<std::chrono::steady_clock::time_point> deadline, bool interruptible) -> supervision_data {
+    supervision_data result;
+    result.wait_statuses.assign(pids.size(), std::nullopt);
+    result.usages.assign(pids.size(), rusage{});
+
+    // each child gets a pidfd which becomes readable once it exits
+    std::vector<std::optional<file_descriptor_wrapper>> pidfds;
+    pidfds.reserve(pids.size());
+    for (pid_t const pid : pids) {
+        pidfds.emplace_back(syscall_wrapper::pidfd_open_wrapper(pid));
+    }
+
+    // the deadline is tracked by a timer so it can be waited on alongside the children
+    std::optional<file_descriptor_wrapper> timer = std::nullopt;
+    if (deadline.has_value()) {
+        timer = syscall_wrapper::timerfd_create_wrapper(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (timer.has_value() && !syscall_wrapper::timerfd_settime_wrapper(timer.value(), deadline.value())) {
+            timer = std::nullopt;
         }
+    }
 
-        // wait for the process to complete
-        // TODO (john): I cannot wait everytime there is a command executed if we are going to support background tasks
-        int wait_status = 0;
-        pid_t const exit_code = waitpid(pid, &wait_status, WUNTRACED);
+    // indices of the children which have not been collected yet
+    std::vector<std::size_t> remaining(pids.size());
+    std::iota(std::begin(remaining), std::end(remaining), 0);
+
+    // the pidfd of a child stays readable once it has exited, so it leaves the reactor as soon as the child is collected
+    reactor* const shell = shell_events();
+    std::vector<std::optional<std::uint64_t>> pidfd_tokens(pids.size(), std::nullopt);
+    auto const unregister = [&](std::size_t idx) {
+        if (pidfd_tokens[idx].has_value()) {
+            shell->remove(pidfds[idx].value(), pidfd_tokens[idx].value()); // NOLINT a token is only handed out for a pidfd with the reactor
+            pidfd_tokens[idx] = std::nullopt;
+        }
+    };
+
+    // collect every child which has changed state without blocking, along with what it used, returns whether any are left
+    auto const collect = [&]() -> bool {
+        std::erase_if(remaining, [&](std::size_t idx) {
+            int wait_status = 0;
+            pid_t const status = wait4(pids[idx], &wait_status, WNOHANG | WUNTRACED, &result.usages[idx]);
+            if (status == pids[idx]) {
+                result.wait_statuses[idx] = wait_status;
+            } else if (status != -1) {
+                return false;
+            }
 
-        // close all of the older file descriptors
-        data.stdout = std::nullopt;
-        data.stdin = std::nullopt;
-        data.stderr = std::nullopt;
+            // the child was collected or can not be waited on anymore
+            unregister(idx);
+            return true;
+        });
 
-        // check for errors
-        if (exit_code != pid) {
-            jsh::cout_logger.log(jsh::LOG_LEVEL::ERROR, "Waiting on PID ", pid, " failed: ", syscall_wrapper::strerror_wrapper(errno), '\n');
-        } else {
-            // save the exit status
-            if (WIFEXITED(wait_status)) {
-                std::string const exit_status = std::to_string(WEXITSTATUS(wait_status));
-                environment::set_var(environment::STATUS_STRING, exit_status.c_str());
+        // readers which exited no longer need the shell to watch their pipes
+        for (std::size_t idx = 0; idx < pids.size(); ++idx) {
+            if (result.wait_statuses[idx].has_value() && !WIFSTOPPED(result.wait_statuses[idx].value())) {
+                pipe_capacity::release(pids[idx]);
             }
         }
+        return !remaining.empty();
+    };
+
+    // the deadline passed, kill the whole process group
+    auto const expire = [&]() {
+        std::uint64_t expirations = 0;
+        std::ignore = syscall_wrapper::read_wrapper(timer.value(), &expirations, sizeof(expirations)); // NOLINT only called once the timer fired
+        cout_logger.log(LOG_LEVEL::WARN, "Job timed out, killing process group ", pgid);
+        std::ignore = syscall_wrapper::kill_wrapper(-pgid, SIGKILL);
+        result.timed_out = true;
+    };
+
+    // ctrl+c either stops the wait or is passed on to the children, returns whether to stop waiting
+    auto const interrupt = [&]() -> bool {
+        if (interruptible) {
+            result.interrupted = true;
+            return true;
+        }
+        std::ignore = syscall_wrapper::kill_wrapper(-pgid, SIGINT);
+        return false;
+    };
+
+    if (shell != nullptr) {
+        // the shell's signalfd reads SIGCHLD and SIGINT, reaping is left to this loop until it is done
+        set_collecting(true);
+        for (std::size_t idx = 0; idx < pids.size(); ++idx) {
+            if (pidfds[idx].has_value()) {
+                pidfd_tokens[idx] = shell->add(pidfds[idx].value(), []() {});
+            }
+        }
+        bool timer_fired = false;
+        std::optional<std::uint64_t> timer_token = timer.has_value() ? shell->add(timer.value(), [&timer_fired]() { timer_fired = true; }) : std::nullopt;
+        bool sample_ready = false;
+        file_descriptor_wrapper const* sample_timer = pipe_capacity::sample_timer();
+        std::optional<std::uint64_t> sample_token = sample_timer != nullptr ? shell->add(*sample_timer, [&sample_ready]() { sample_ready = true; }) : std::nullopt;
 
-        // restore terminal control to the shell
-        // since the shell is its process leader, we can just use getpid
-        if (data.is_foreground) {
-            std::optional<pid_t> cur_pgid = syscall_wrapper::getpid_wrapper();
-            assert(cur_pgid.has_value());
-            status = syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, cur_pgid.value());
+        while (collect()) {
+            if (!shell->dispatch(-1)) {
+                break;
+            }
 
-            // error handle
-            if (!status) {
-                return;
+            if (timer_fired && timer_token.has_value()) {
+                shell->remove(timer.value(), timer_token.value()); // NOLINT a token is only handed out for a timer
+                timer_token = std::nullopt;
+                expire();
             }
-        }
 
-        // get the jsh shell singleton
-        std::optional<std::shared_ptr<shell>> shll_ptr = shell::get();
+            // sampling may close the timer, so it leaves the reactor first and comes back if sampling goes on
+            if (sample_ready && sample_token.has_value()) {
+                shell->remove(*sample_timer, sample_token.value());
+                sample_ready = false;
+                pipe_capacity::sample();
+                sample_timer = pipe_capacity::sample_timer();
+                sample_token = sample_timer != nullptr ? shell->add(*sample_timer, [&sample_ready]() { sample_ready = true; }) : std::nullopt;
+            }
 
-        // error handle
-        if (!shll_ptr.has_value()) {
-            return;
+            if (take_interrupt() && interrupt()) {
+                break;
+            }
+        }
+
+        // nothing may stay registered once the file descriptors close
+        for (std::size_t idx = 0; idx < pids.size(); ++idx) {
+            unregister(idx);
+        }
+        if (timer_token.has_value()) {
+            shell->remove(timer.value(), timer_token.value()); // NOLINT a token is only handed out for a timer
         }
+        if (sample_token.has_value()) {
+            shell->remove(*sample_timer, sample_token.value());
+        }
+        set_collecting(false);
+        return result;
+    }
 
-        // send job cont signal
-        assert(shll_ptr.has_value());
-        status = syscall_wrapper::tcsetattr_wrapper(syscall_wrapper::stdin_file_descriptor, TCSADRAIN, shll_ptr.value()->get_term_if());
+    // stopped children do not wake up their pidfd, so SIGCHLD is read through a signalfd as well
+    // the mask is set every time since a forked builtin resets it, the signalfd reads whichever process reads it so it survives fork
+    sigset_t sigs;
+    if (!syscall_wrapper::sigemptyset_wrapper(sigs) || !syscall_wrapper::sigaddset_wrapper(sigs, SIGCHLD) || !syscall_wrapper::sigprocmask_wrapper(SIG_BLOCK, sigs)) {
+        return result;
+    }
 
-        if (!status) {
-            return;
+    // SIGINT is only ever pending for the signalfd in a process which blocked it itself, such as a worker forked by the shell
+    if (!child_signals.has_value()) {
+        if (!syscall_wrapper::sigaddset_wrapper(sigs, SIGINT)) {
+            return result;
+        }
+        child_signals = syscall_wrapper::signalfd_wrapper(syscall_wrapper::invalid_file_descriptor, sigs, SFD_CLOEXEC | SFD_NONBLOCK);
+        if (!child_signals.has_value()) {
+            return result;
+        }
+    }
+    file_descriptor_wrapper const& sigfd = child_signals.value();
+
+    std::vector<syscall_wrapper::pollfd_wrapper> pfds;
+    pfds.reserve(pids.size() + 3);
+    while (collect()) {
+        // watch the signalfd, the timers, and the pidfds of the children which are still running
+        pfds.clear();
+        pfds.emplace_back(sigfd, POLLIN, 0);
+        bool const deadline_polled = timer.has_value();
+        if (deadline_polled) {
+            pfds.emplace_back(timer.value(), POLLIN, 0);
+        }
+        file_descriptor_wrapper const* const sample_timer = pipe_capacity::sample_timer();
+        std::size_t const sample_idx = pfds.size();
+        if (sample_timer != nullptr) {
+            pfds.emplace_back(*sample_timer, POLLIN, 0);
+        }
+        for (std::size_t const idx : remaining) {
+            if (pidfds[idx].has_value()) {
+                pfds.emplace_back(pidfds[idx].value(), POLLIN, 0);
+            }
         }
-    } else { // child
-        // get the current PID
-        std::optional<pid_t> cur_pid = syscall_wrapper::getpid_wrapper();
-        assert(cur_pid.has_value()); // this should always pass since it getpid shouldn't fail
 
-        // if the pgid is nullptr, then this is the first process and we should make its PID the
-        // PGID since it will be the process leader
-        if (*data.pgid == -1) {
-            *data.pgid = cur_pid.value();
+        std::optional<int> const num_fds = syscall_wrapper::poll_wrapper(pfds, -1);
+        if (!num_fds.has_value()) {
+            break;
         }
 
-        // set the current process' process group id
-        // if this is the first process being launched then it will be the process leader and cur_pid.value() == data.pgid
-        bool status = syscall_wrapper::setpgid_wrapper(cur_pid.value(), *data.pgid);
+        // consume the signal, the children themselves are collected at the top of the loop
+        bool stop = false;
+        if (pfds[0].revents != 0) {
+            signalfd_siginfo sigfdinfo{};
+            std::optional<ssize_t> const num_read = syscall_wrapper::read_nonblocking_wrapper(sigfd, &sigfdinfo, sizeof(sigfdinfo));
+            stop = num_read.has_value() && num_read.value() != 0 && sigfdinfo.ssi_signo == SIGINT && interrupt();
+        }
 
-        // error handle
-        if (!status) {
-            return;
+        if (deadline_polled && pfds[1].revents != 0) {
+            expire();
+            timer = std::nullopt;
         }
 
-        // if the process is running in the foreground, then it gets access to the terminal
-        if (data.is_foreground) {
-            status = syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, *data.pgid);
+        // measure the pipeline's pipes, growing the full ones
+        if (sample_timer != nullptr && pfds[sample_idx].revents != 0) {
+            pipe_capacity::sample();
+        }
 
-            // error handle
-            if (!status) {
-                return;
-            }
+        if (stop) {
+            break;
         }
+    }
 
-        // listen to job control signals
-        std::optional<std::function<void(int)>> sig_status;
-        sig_status = syscall_wrapper::signal_wrapper(SIGINT, SIG_DFL); // termination requests
+    return result;
+}
 
-        // error handle
-        if (!sig_status.has_value()) {
-            return;
-        }
+void process::watch(reactor* events) {
+    process::events = events;
+}
 
-        sig_status = syscall_wrapper::signal_wrapper(SIGQUIT, SIG_DFL);
+auto process::shell_events() -> reactor* {
+    // a forked child shares the epoll set with the shell, dispatching it would steal the shell's events
+    return events != nullptr && events->owned() ? events : nullptr;
+}
 
-        // error handle
-        if (!sig_status.has_value()) {
-            return;
-        }
+auto process::is_collecting() -> bool {
+    return collecting;
+}
 
-        sig_status = syscall_wrapper::signal_wrapper(SIGTSTP, SIG_DFL);
+void process::set_collecting(bool collecting) {
+    process::collecting = collecting;
+}
 
-        // error handle
-        if (!sig_status.has_value()) {
-            return;
-        }
+void process::interrupt() {
+    interrupted = true;
+}
 
-        sig_status = syscall_wrapper::signal_wrapper(SIGTTIN, SIG_DFL);
+auto process::take_interrupt() -> bool {
+    bool const taken = interrupted;
+    interrupted = false;
+    return taken;
+}
 
-        // error handle
-        if (!sig_status.has_value()) {
-            return;
-        }
+auto process::exit_status(int wait_status) -> std::optional<int> {
+    if (WIFEXITED(wait_status)) {
+        return std::make_optional<int>(WEXITSTATUS(wait_status));
+    }
+
+    if (WIFSIGNALED(wait_status)) {
+        return std::make_optional<int>(SIGNAL_STATUS_OFFSET + WTERMSIG(wait_status));
+    }
+
+    // stopped and continued children have not exited
+    return std::nullopt;
+}
+
+auto process::reset_signals() -> bool {
+    // the shell blocks the signals it reads through a signalfd, children should start with an empty mask
+    sigset_t mask;
+    if (!syscall_wrapper::sigemptyset_wrapper(mask) || !syscall_wrapper::sigprocmask_wrapper(SIG_SETMASK, mask)) {
+        return false;
+    }
 
-        sig_status = syscall_wrapper::signal_wrapper(SIGTTOU, SIG_DFL);
+    // the shell ignores the job control signals, children should not
+    for (int const sig : {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU}) {
+        std::optional<std::function<void(int)>> const sig_status = syscall_wrapper::signal_wrapper(sig, SIG_DFL);
 
         // error handle
         if (!sig_status.has_value()) {
-            return;
+            return false;
         }
+    }
 
-        { // sir scope
-            shell_internal_redirection const sir(std::move(data.stdout), std::move(data.stdin), std::move(data.stderr), false);
+    return true;
+}
 
-            int const exit_code = execvp(args_ptr[0], args_ptr.data());
+void process::reclaim_terminal(bool is_foreground) {
+    // background jobs never took the terminal, and without the interactive shell there is no terminal setup to restore
+    if (!is_foreground || !shell::active()) {
+        return;
+    }
 
-            // execvp only returns if there was an error
-            assert(exit_code == -1);
-        } // sir scope
+    // restore terminal control to the shell
+    // since the shell is its process leader, we can just use getpid
+    std::optional<pid_t> cur_pgid = syscall_wrapper::getpid_wrapper();
+    assert(cur_pgid.has_value());
+    bool const status = syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, cur_pgid.value());
+
+    // error handle
+    if (!status) {
+        return;
+    }
+
+    // get the jsh shell singleton
+    std::optional<std::shared_ptr<shell>> shll_ptr = shell::get();
 
-        // log that this command was invalid
-        jsh::cout_logger.log(jsh::LOG_LEVEL::ERROR, "Executing command failed...");
+    // error handle
+    if (!shll_ptr.has_value()) {
+        return;
     }
+
+    // restore the shell's terminal attributes
+    assert(shll_ptr.has_value());
+    std::ignore = syscall_wrapper::tcsetattr_wrapper(syscall_wrapper::stdin_file_descriptor, TCSADRAIN, shll_ptr.value()->get_term_if());
+}
+
+auto process::launch_backend() -> LAUNCH_BACKEND {
+    // the backend can be switched at runtime through an environment variable
+    std::string_view const backend = environment::get_var(LAUNCH_BACKEND_VAR);
+
+    // fork is the fallback for unset or unknown values
+    if (backend == LAUNCH_BACKEND_STR[static_cast<std::size_t>(LAUNCH_BACKEND::SPAWN)]) {
+        return LAUNCH_BACKEND::SPAWN;
+    }
+    return LAUNCH_BACKEND::FORK;
+}
+
+auto process::io_backend() -> IO_BACKEND {
+    // the backend can be switched at runtime through an environment variable
+    std::string_view const backend = environment::get_var(IO_BACKEND_VAR);
+
+    // opening each file as it is parsed is the fallback for unset or unknown values
+    if (backend == IO_BACKEND_STR[static_cast<std::size_t>(IO_BACKEND::URING)]) {
+        return IO_BACKEND::URING;
+    }
+    return IO_BACKEND::SYNC;
+}
+
+auto process::open_redirections(std::vector<redirection>& redirections, std::vector<std::unique_ptr<process_data>>& stages) -> bool {
+    std::vector<open_request> requests;
+    requests.reserve(redirections.size());
+    for (redirection& redir : redirections) {
+        requests.push_back(std::move(redir.request));
+    }
+
+    if (!syscall_wrapper::open_batch_wrapper(requests)) {
+        return false;
+    }
+
+    // later redirections of the same stream replace earlier ones, just like when they are opened while parsing
+    for (std::size_t i = 0; i < redirections.size(); ++i) {
+        assert(redirections[i].stage < stages.size());
+        std::visit(
+            [&](auto& data) {
+                if (redirections[i].output) {
+                    data.stdout = std::move(requests[i].fides);
+                } else {
+                    data.stdin = std::move(requests[i].fides);
+                }
+            },
+            *stages[redirections[i].stage]);
+    }
+    return true;
+}
+
+void process::execute_process(binary_data& data) {
+    // launch the child
+    std::optional<pid_t> const pid = launch_process(data);
+
+    // error handle
+    if (!pid.has_value()) {
+        return;
+    }
+
+    // wait for the process to complete and save its exit status
+    std::optional<int> const wait_status = wait_process(pid.value());
+    std::optional<int> const status = wait_status.has_value() ? exit_status(wait_status.value()) : std::nullopt;
+    if (status.has_value()) {
+        environment::set_status(status.value());
+    }
+
+    // give the terminal back to the shell
+    reclaim_terminal(data.is_foreground);
 }
 
 void process::execute_process(export_data& data) {
@@ -525,10 +876,126 @@ void process::execute_process(export_data& data) {
         shell_internal_redirection const sir(std::move(data.stdout), std::move(data.stdin), std::move(data.stderr));
 
         // perform the export
-        environment::set_var(data.name.c_str(), data.val.c_str());
+        if (data.exported) {
+            environment::set_var(data.name.c_str(), data.val.c_str());
+        } else {
+            environment::set_local(data.name.c_str(), data.val.c_str());
+        }
+
+        // remembered commands may no longer be the ones PATH would find, and completion moves to the new directories
+        if (command_hash::is_path_var(data.name)) {
+            command_hash::invalidate_path();
+            completion::invalidate_path();
+        }
+
+        // the builtin always succeeds
+        environment::set_status(EXIT_SUCCESS);
+    } // sir scope
+}
+
+void process::execute_process(builtin_data& data) {
+    { // sir scope
+        shell_internal_redirection const sir(std::move(data.stdout), std::move(data.stdin), std::move(data.stderr));
+
+        // run the builtin inside of the shell, there is nothing to fork
+        environment::set_status(data.function(data.args));
+    } // sir scope
+}
+
+void process::execute_process(hash_data& data) {
+    { // sir scope
+        shell_internal_redirection const sir(std::move(data.stdout), std::move(data.stdin), std::move(data.stderr));
 
-        // set return env var to 0
-        environment::set_var(environment::STATUS_STRING, environment::SUCCESS_STRING);
+        // perform the hash
+        if (data.clear) {
+            command_hash::clear();
+        } else {
+            command_hash::print();
+        }
+
+        // the builtin always succeeds
+        environment::set_status(EXIT_SUCCESS);
+    } // sir scope
+}
+
+void process::execute_process(job_control_data& data) {
+    { // sir scope
+        shell_internal_redirection const sir(std::move(data.stdout), std::move(data.stdin), std::move(data.stderr));
+
+        // pick up any children that changed state before looking at the table
+        job_table::reap();
+
+        // jobs only reports, so it always succeeds
+        if (data.kind == JOB_CONTROL::JOBS) {
+            job_table::print();
+            environment::set_status(EXIT_SUCCESS);
+            return;
+        }
+
+        // wait without any arguments waits for every job
+        if (data.kind == JOB_CONTROL::WAIT && data.args.empty()) {
+            int status = EXIT_SUCCESS;
+            while (job_entry const* entry = job_table::resolve("")) {
+                status = job_table::wait_job(entry->id, true).value_or(status);
+
+                // a stopped or interrupted job can not be waited on any further
+                if (job_table::find(entry->id) != nullptr) {
+                    break;
+                }
+            }
+            environment::set_status(status);
+            return;
+        }
+
+        // the rest of the builtins act on one job, the most recent one by default
+        std::string const spec = data.args.empty() ? std::string{} : data.args[0];
+        job_entry* entry = job_table::resolve(spec);
+        if (entry == nullptr) {
+            cout_logger.log(LOG_LEVEL::ERROR, JOB_CONTROL_BUILTIN_STR[static_cast<std::size_t>(data.kind)], ": no such job ", spec);
+            environment::set_status(EXIT_FAILURE);
+            return;
+        }
+        std::size_t const job_id = entry->id;
+
+        std::optional<int> status = std::make_optional<int>(EXIT_SUCCESS);
+        switch (data.kind) {
+        case JOB_CONTROL::WAIT: {
+            status = job_table::wait_job(job_id, true);
+            break;
+        }
+        case JOB_CONTROL::FG: {
+            job_table::print_job(*entry);
+
+            // hand the terminal to the job before waking it up
+            if (data.is_foreground) {
+                std::ignore = syscall_wrapper::tcsetpgrp_wrapper(syscall_wrapper::stdin_file_descriptor, entry->pgid);
+            }
+
+            status = job_table::continue_job(job_id) ? job_table::wait_job(job_id) : std::nullopt;
+            reclaim_terminal(data.is_foreground);
+
+            // a job that was stopped again stays in the table
+            if (entry = job_table::find(job_id); entry != nullptr && entry->state == JOB_STATE::STOPPED) {
+                job_table::print_job(*entry);
+            }
+            break;
+        }
+        case JOB_CONTROL::BG: {
+            status = job_table::continue_job(job_id) ? std::make_optional<int>(EXIT_SUCCESS) : std::nullopt;
+            break;
+        }
+        case JOB_CONTROL::JOBS:
+        case JOB_CONTROL::COUNT: {
+            // we should never get here
+            assert(false);
+            break;
+        }
+        }
+
+        // a job that did not finish leaves $? alone
+        if (status.has_value()) {
+            environment::set_status(status.value());
+        }
     } // sir scope
 }
 
@@ -3,9 +3,18 @@
 #include "pch.hpp"
 
 // JSH
+#include "builtins.hpp"
+#include "cgroup.hpp"
+#include "command_hash.hpp"
+#include "completion.hpp"
+#include "cpu_affinity.hpp"
 #include "environment.hpp"
+#include "lexer.hpp"
 #include "macros.hpp"
+#include "parsing.hpp"
+#include "pipe_capacity.hpp"
 #include "posix_wrappers.hpp"
+#include "reactor.hpp"
 
 namespace jsh {
 /**
@@ -20,6 +29,12 @@ namespace jsh {
  * pgid: the current process group id the process should be put in, note: this information is redundant to the pgid in the job structure, however instead of passing on the stack, we add a member to this structure
  *
  * is_foreground: indicates whether the process will run in the foreground of the shell
+ *
+ * affinity: the CPUs the process is restricted to, std::nullopt to run anywhere the shell may run
+ *
+ * cgroup: the cgroup of the job the process belongs to, nullptr if the job is not placed in one
+ *
+ * exec_gate: a pipe the child reads one byte from before it execs, so the shell can attach perf counters first, std::nullopt to run right away
  */
 static constexpr std::size_t DEFAULT_DATA_ALIGNMENT = 64;
 struct __attribute__((packed)) __attribute__((aligned(DEFAULT_DATA_ALIGNMENT))) default_data {
@@ -30,6 +45,12 @@ struct __attribute__((packed)) __attribute__((aligned(DEFAULT_DATA_ALIGNMENT)))
     std::shared_ptr<pid_t> pgid;
 
     bool is_foreground;
+
+    std::optional<cpu_set_t> affinity = std::nullopt;
+
+    std::shared_ptr<job_cgroup> cgroup;
+
+    std::optional<file_descriptor_wrapper> exec_gate = std::nullopt;
 };
 
 /**
@@ -47,14 +68,92 @@ struct __attribute__((packed)) binary_data : default_data { // NOLINT this compl
  * name: the name of the variable which will be exported
  *
  * val: the value that will be associated with this environment variable
+ *
+ * exported: false for an assignment without export (NAME=value), which sets a variable local to the shell
  */
 struct __attribute__((packed)) export_data : default_data { // NOLINT this complains about being 64 byte aligned
     std::string name;
     std::string val;
+    bool exported = true;
+};
+
+/**
+ * structure to wrap all of the necessary data to perform a hash operation
+ *
+ * clear: whether the command hash should be cleared instead of printed
+ */
+struct __attribute__((packed)) hash_data : default_data { // NOLINT this complains about being 64 byte aligned
+    bool clear;
+};
+
+/**
+ * JOB_CONTROL: the job control builtin being run
+ */
+enum class JOB_CONTROL : char {
+    JOBS = 0,
+    WAIT = 1,
+    FG = 2,
+    BG = 3,
+    COUNT = 4
+};
+
+/**
+ * structure to wrap all of the necessary data to perform a job control operation
+ *
+ * kind: which of the job control builtins is being run
+ *
+ * args: the job specifications passed to the builtin
+ */
+struct __attribute__((packed)) job_control_data : default_data { // NOLINT this complains about being 64 byte aligned
+    JOB_CONTROL kind;
+    std::vector<std::string> args;
+};
+
+/**
+ * structure to wrap all of the necessary data to run a builtin from the registry
+ *
+ * function: the builtin being run
+ *
+ * args: the arguments provided to the shell, including the name of the builtin
+ */
+struct __attribute__((packed)) builtin_data : default_data { // NOLINT this complains about being 64 byte aligned
+    builtin_function function;
+    std::vector<std::string> args;
 };
 
 // typedef for a one command the user runs
-using process_data = std::variant<binary_data, export_data>;
+using process_data = std::variant<binary_data, export_data, hash_data, job_control_data, builtin_data>;
+
+/**
+ * redirection: a redirection whose file is opened once every stage of the job has been parsed
+ *
+ * stage: the index of the process in the job
+ *
+ * output: whether the file replaces the process' stdout rather than its stdin
+ */
+struct redirection {
+    std::size_t stage;
+    bool output;
+    open_request request;
+};
+
+/**
+ * structure describing what happened to a group of supervised children
+ *
+ * wait_statuses: the wait status reported for each child, std::nullopt if none was collected
+ *
+ * usages: the rusage wait4 reported for each child, zero if none was collected
+ *
+ * timed_out: indicates whether the deadline passed and the process group was killed
+ *
+ * interrupted: indicates whether ctrl+c stopped the wait before every child was collected
+ */
+struct supervision_data {
+    std::vector<std::optional<int>> wait_statuses;
+    std::vector<rusage> usages;
+    bool timed_out = false;
+    bool interrupted = false;
+};
 
 class process {
   private:
@@ -62,12 +161,11 @@ class process {
      * CONSTANTS
      */
     static constexpr char const* EXPORT_BUILTIN = "export";
+    static constexpr char const* HASH_BUILTIN = "hash";
+    static constexpr char const* HASH_CLEAR_FLAG = "-r";
+    static constexpr char const* JOB_CONTROL_BUILTIN_STR[static_cast<std::size_t>(JOB_CONTROL::COUNT)] = {"jobs", "wait", "fg", "bg"}; // NOLINT
     static constexpr char EQUALS = '=';
-    static constexpr char INPUT_REDIRECTION = '<';
-    static constexpr char OUTPUT_REDIRECTION = '>';
-    static constexpr char SINGLE_QUOTE = '\'';
-    static constexpr char DOUBLE_QUOTE = '\"';
-    static constexpr char ESCAPE = '\\';
+    static constexpr char const* LAUNCH_BACKEND_VAR = "JSH_LAUNCH_BACKEND";
 
     /**
      * populate the binary with its data
@@ -75,18 +173,65 @@ class process {
     static void populate_process_data(binary_data& data);
 
     /**
-     * parse_state: the current state of the parsing algorithm
+     * LAUNCH_BACKEND: the mechanism used to start a binary
+     *
+     * FORK: fork the shell and set up the child before calling exec
+     *
+     * SPAWN: posix_spawn, which execs without copying the shell's page tables
      */
-    enum PARSE_STATE : char {
-        REGULAR = 0,
-        QUOTE = 1,
-        DBL_QUOTE = 2,
-        INPUT_FILENAME = 3,
-        OUTPUT_FILENAME = 4,
-        ESCAPED_CHARACTER = 5,
-        COUNT = 6
+    enum class LAUNCH_BACKEND : char {
+        FORK = 0,
+        SPAWN = 1,
+        COUNT = 2
     };
 
+    static constexpr char const* LAUNCH_BACKEND_STR[static_cast<std::size_t>(LAUNCH_BACKEND::COUNT)] = {"fork", "spawn"}; // NOLINT
+
+    /**
+     * launch_backend: returns the backend selected through the JSH_LAUNCH_BACKEND environment variable
+     */
+    [[nodiscard]] static auto launch_backend() -> LAUNCH_BACKEND;
+
+    /**
+     * child_signals: reads SIGCHLD, and SIGINT in a process which blocks it, while children are supervised without the shell's reactor, created the first time it is needed and kept for the lifetime of the process
+     */
+    static std::optional<file_descriptor_wrapper> child_signals;
+
+    /**
+     * events: the shell's reactor, whose signalfd is the only one reading SIGCHLD and SIGINT while it exists, nullptr without one
+     */
+    static reactor* events;
+
+    /**
+     * collecting: indicates whether the shell is collecting its own children, so reading SIGCHLD only wakes it up instead of reaping
+     */
+    static bool collecting;
+
+    /**
+     * interrupted: indicates whether ctrl+c was read since the last time someone took it
+     */
+    static bool interrupted;
+
+    /**
+     * prepare_child: places a freshly forked child in its process group, hands it the terminal, moves it into its cgroup, pins it to its CPUs, and resets its signals, exiting the child on failure
+     *
+     * data: the parsed input command the child is running
+     */
+    static void prepare_child(default_data& data);
+
+    /**
+     * exec_child: sets up the forked child (process group, terminal, signals, redirection) and replaces it with the binary, never returns
+     *
+     * data: the parsed input command from the user
+     *
+     * path: the resolved path of the binary
+     *
+     * args_ptr: the null terminated argument vector handed to exec
+     *
+     * envp: the null terminated environment handed to exec
+     */
+    [[noreturn]] static void exec_child(binary_data& data, std::string const& path, std::vector<char*>& args_ptr, char* const* envp);
+
     /**
      * shell_internal_redirection: RAII wrapper around setting stdout, stdin, and stderr for a given shell internal
      */
@@ -148,12 +293,148 @@ class process {
     };
 
   public:
+    /**
+     * CONSTANTS
+     */
+    static constexpr int COMMAND_NOT_FOUND_STATUS = 127;
+    static constexpr int SIGNAL_STATUS_OFFSET = 128;
+
     /**
      * parse_process: parse an input into a process_data structure, or if a shell internal was called return the appropriate type
      *
      * input: the input command provided by the user to start the process
+     *
+     * deferred: when given, redirections are appended to it with a stage of 0 instead of being opened
      */
-    [[nodiscard]] static auto parse_process(std::string const& input) -> std::optional<std::unique_ptr<process_data>>;
+    [[nodiscard]] static auto parse_process(std::string const& input, std::vector<redirection>* deferred = nullptr) -> std::optional<std::unique_ptr<process_data>>;
+
+    /**
+     * parse_process: parse the tokens of one stage of a job into a process_data structure, or if a shell internal was called return the appropriate type
+     *
+     * tokens: the stage's words and redirections, any operator among them is taken as a literal word
+     *
+     * deferred: when given, redirections are appended to it with a stage of 0 instead of being opened
+     */
+    [[nodiscard]] static auto parse_process(std::span<token const> tokens, std::vector<redirection>* deferred = nullptr) -> std::optional<std::unique_ptr<process_data>>;
+
+    /**
+     * IO_BACKEND: the mechanism used to open the files a job redirects to
+     *
+     * SYNC: each file is opened while its stage is parsed
+     *
+     * URING: the files of every stage are opened together once the whole job has been parsed, in a single io_uring submission
+     */
+    enum class IO_BACKEND : char {
+        SYNC = 0,
+        URING = 1,
+        COUNT = 2
+    };
+
+    static constexpr char const* IO_BACKEND_STR[static_cast<std::size_t>(IO_BACKEND::COUNT)] = {"sync", "uring"}; // NOLINT
+    static constexpr char const* IO_BACKEND_VAR = "JSH_IO_BACKEND";
+
+    /**
+     * io_backend: returns the backend selected through the JSH_IO_BACKEND environment variable
+     */
+    [[nodiscard]] static auto io_backend() -> IO_BACKEND;
+
+    /**
+     * open_redirections: opens the files of every deferred redirection as one batch and hands each of them to its stage
+     *
+     * returns false if any of the files could not be opened
+     */
+    [[nodiscard]] static auto open_redirections(std::vector<redirection>& redirections, std::vector<std::unique_ptr<process_data>>& stages) -> bool;
+
+    /**
+     * launch_process: forks the binary into the process group pointed to by data.pgid without waiting on it
+     *
+     * data: the parsed input command from the user which is used to execute the binary
+     *
+     * returns the pid of the child or std::nullopt if the fork failed
+     */
+    [[nodiscard]] static auto launch_process(binary_data& data) -> std::optional<pid_t>;
+
+    /**
+     * launch_builtin: forks a copy of the shell which runs the builtin, used when the builtin is one stage of a larger pipeline
+     *
+     * data: the builtin to run along with its redirection
+     *
+     * returns the pid of the child or std::nullopt if the fork failed
+     */
+    [[nodiscard]] static auto launch_builtin(builtin_data& data) -> std::optional<pid_t>;
+
+    /**
+     * wait_process: blocks until the child exits or is stopped
+     *
+     * pid: the child to wait on
+     *
+     * returns the wait status reported for the child or std::nullopt if waiting failed
+     */
+    [[nodiscard]] static auto wait_process(pid_t pid) -> std::optional<int>;
+
+    /**
+     * supervise: waits until every child has exited or stopped without blocking in waitpid, killing their process group if the deadline passes
+     *
+     * pids: the children to supervise
+     *
+     * pgid: the process group the children belong to
+     *
+     * deadline: the point in time at which the process group is killed, std::nullopt to wait forever
+     *
+     * interruptible: whether ctrl+c stops the wait and leaves the children running, otherwise it is passed on to the process group
+     *
+     * NOTES: with the shell's reactor the pidfds and timers are registered there, so SIGCHLD and SIGINT are only ever read from the shell's signalfd
+     */
+    [[nodiscard]] static auto supervise(std::vector<pid_t> const& pids, pid_t pgid, std::optional<std::chrono::steady_clock::time_point> deadline, bool interruptible = false) -> supervision_data;
+
+    /**
+     * watch: supervises children through events from now on, nullptr to go back to a private signalfd
+     */
+    static void watch(reactor* events);
+
+    /**
+     * shell_events: the reactor children are supervised through, nullptr if there is none or it belongs to the process this one was forked from
+     */
+    [[nodiscard]] static auto shell_events() -> reactor*;
+
+    /**
+     * is_collecting: whether the shell is collecting its own children, the SIGCHLD handler must not reap them out from under it
+     *
+     * set_collecting: marks the start and end of a wait which collects its own children while dispatching the shell's reactor
+     */
+    [[nodiscard]] static auto is_collecting() -> bool;
+    static void set_collecting(bool collecting);
+
+    /**
+     * interrupt: records that ctrl+c was read, called by the shell's SIGINT handler
+     */
+    static void interrupt();
+
+    /**
+     * take_interrupt: whether ctrl+c was read since the last call
+     */
+    [[nodiscard]] static auto take_interrupt() -> bool;
+
+    /**
+     * exit_status: converts a wait status into an exit status, a process killed by a signal exits with 128 + the signal number
+     *
+     * wait_status: the status reported by waitpid
+     *
+     * returns std::nullopt if the process was only stopped or continued
+     */
+    [[nodiscard]] static auto exit_status(int wait_status) -> std::optional<int>;
+
+    /**
+     * reset_signals: restores the default disposition of the job control signals and clears the signal mask inherited from the shell
+     */
+    [[nodiscard]] static auto reset_signals() -> bool;
+
+    /**
+     * reclaim_terminal: gives control of the terminal back to the shell once a foreground job is finished
+     *
+     * is_foreground: whether the job that just finished was running in the foreground
+     */
+    static void reclaim_terminal(bool is_foreground);
 
     /**
      * execute_binary: performs the execution for binary
@@ -169,6 +450,27 @@ class process {
      */
     static void execute_process(export_data& data);
 
+    /**
+     * execute_builtin: runs a builtin inside of the shell without forking
+     *
+     * data: the builtin to run along with its redirection
+     */
+    static void execute_process(builtin_data& data);
+
+    /**
+     * execute_hash: prints or clears the command hash
+     *
+     * data: the information necessary to perform the hash
+     */
+    static void execute_process(hash_data& data);
+
+    /**
+     * execute_job_control: runs one of the jobs, wait, fg, or bg builtins
+     *
+     * data: the information necessary to perform the job control operation
+     */
+    static void execute_process(job_control_data& data);
+
     /**
      * execute: determines which type of process should be executed
      *
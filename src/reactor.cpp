@@ -0,0 +1,67 @@
+#include "reactor.hpp"
+
+namespace jsh {
+reactor::reactor(file_descriptor_wrapper epoll_fd, pid_t owner) : epoll_fd{std::move(epoll_fd)}, owner{owner} {}
+
+auto reactor::create() -> std::optional<reactor> {
+    std::optional<file_descriptor_wrapper> epoll_fd = syscall_wrapper::epoll_create_wrapper();
+    std::optional<pid_t> const pid = syscall_wrapper::getpid_wrapper();
+    if (!epoll_fd.has_value() || !pid.has_value()) {
+        return std::nullopt;
+    }
+
+    return std::make_optional<reactor>(reactor(std::move(epoll_fd.value()), pid.value()));
+}
+
+auto reactor::owned() const -> bool {
+    std::optional<pid_t> const pid = syscall_wrapper::getpid_wrapper();
+    return pid.has_value() && pid.value() == owner;
+}
+
+auto reactor::add(file_descriptor_wrapper const& fides, event_handler handler) -> std::optional<std::uint64_t> {
+    // a child registering its own file descriptors would wake up its parent
+    if (!owned()) {
+        return std::nullopt;
+    }
+
+    std::uint64_t const token = next_token++;
+    if (!syscall_wrapper::epoll_ctl_wrapper(epoll_fd, EPOLL_CTL_ADD, fides, EPOLLIN, token)) {
+        return std::nullopt;
+    }
+
+    handlers.emplace(token, std::move(handler));
+    return std::make_optional<std::uint64_t>(token);
+}
+
+void reactor::remove(file_descriptor_wrapper const& fides, std::uint64_t token) {
+    // a child only drops its copy of the handler, the source stays registered for the parent
+    if (owned()) {
+        std::ignore = syscall_wrapper::epoll_ctl_wrapper(epoll_fd, EPOLL_CTL_DEL, fides, 0, token);
+    }
+    handlers.erase(token);
+}
+
+auto reactor::dispatch(int timeout) -> bool {
+    std::optional<int> const num_events = syscall_wrapper::epoll_wait_wrapper(epoll_fd, ready.data(), MAX_EVENTS, timeout);
+    if (!num_events.has_value()) {
+        return false;
+    }
+
+    for (int i = 0; i < num_events.value(); ++i) {
+        // an earlier handler may have removed this source
+        auto const handler = handlers.find(ready[static_cast<std::size_t>(i)].data.u64);
+        if (handler == std::end(handlers)) {
+            continue;
+        }
+
+        // the handler may remove itself, so it runs from a copy
+        event_handler const run = handler->second;
+        run();
+    }
+    return true;
+}
+
+auto reactor::size() const -> std::size_t {
+    return handlers.size();
+}
+} // namespace jsh
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "pch.hpp"
+
+// JSH
+#include "macros.hpp"
+#include "posix_wrappers.hpp"
+
+namespace jsh {
+/**
+ * event_handler: runs once the file descriptor it was registered for is ready
+ */
+using event_handler = std::function<void()>;
+
+/**
+ * reactor: a single epoll set which event sources register with once and stay in for as long as they live
+ *
+ * NOTES: level triggered, so a handler which does not consume its event is run again on the next dispatch, a forked child shares the epoll set with its parent so registrations are only made by the process which created the reactor
+ */
+class reactor {
+  private:
+    /**
+     * CONSTANT VARIABLES
+     */
+    static constexpr int MAX_EVENTS = 16;
+
+    /**
+     * epoll_fd: the epoll set
+     */
+    file_descriptor_wrapper epoll_fd;
+
+    /**
+     * owner: the process which created the epoll set
+     */
+    pid_t owner;
+
+    /**
+     * handlers: the handler of every registered source, indexed by the token epoll hands back
+     */
+    std::unordered_map<std::uint64_t, event_handler> handlers;
+
+    /**
+     * next_token: the token given to the next source, tokens are never reused so a stale event can not reach a new handler
+     */
+    std::uint64_t next_token = 0;
+
+    /**
+     * ready: the events returned by the last wait, kept between dispatches so waiting never allocates
+     */
+    std::array<epoll_event, MAX_EVENTS> ready{};
+
+    /**
+     * constructor which takes ownership of an epoll set
+     */
+    reactor(file_descriptor_wrapper epoll_fd, pid_t owner);
+
+  public:
+    /**
+     * create: creates a reactor with an empty epoll set
+     *
+     * returns std::nullopt if the epoll set could not be created
+     */
+    [[nodiscard]] static auto create() -> std::optional<reactor>;
+
+    /**
+     * owned: whether the calling process is the one the epoll set belongs to
+     */
+    [[nodiscard]] auto owned() const -> bool;
+
+    /**
+     * add: registers fides, which must stay open until it is removed, handler runs whenever it is readable
+     *
+     * returns the token identifying the source, std::nullopt if it could not be registered
+     */
+    [[nodiscard]] auto add(file_descriptor_wrapper const& fides, event_handler handler) -> std::optional<std::uint64_t>;
+
+    /**
+     * remove: unregisters a source, this has to happen before fides is closed since a duplicate of it in a child would keep it in the set
+     */
+    void remove(file_descriptor_wrapper const& fides, std::uint64_t token);
+
+    /**
+     * dispatch: waits for at most timeout milliseconds (-1 for ever) and runs the handler of every source which is ready
+     *
+     * returns false if waiting failed
+     */
+    [[nodiscard]] auto dispatch(int timeout) -> bool;
+
+    /**
+     * size: the number of registered sources
+     */
+    [[nodiscard]] auto size() const -> std::size_t;
+};
+} // namespace jsh
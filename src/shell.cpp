@@ -8,8 +8,9 @@ shell::shell() : is_interactive{syscall_wrapper::isatty_wrapper(syscall_wrapper:
     std::optional<pid_t> cur_grp_pid = std::nullopt;
     term_if = std::make_shared<termios>(); // structure describing the terminal interface
 
-    // set the previous exit status to be zero
-    environment::set_var(environment::STATUS_STRING, environment::SUCCESS_STRING);
+    // set the previous exit status to be zero, $$ is taken before anything is forked
+    environment::set_status(EXIT_SUCCESS);
+    environment::record_shell_pid();
 
     // interactive shell setup
     if (is_interactive) {
@@ -40,14 +41,8 @@ shell::shell() : is_interactive{syscall_wrapper::isatty_wrapper(syscall_wrapper:
         }
 
         // ignore all of the job control signals
+        // SIGINT is left alone, an ignored signal never reaches the signalfd it is read through
         std::optional<std::function<void(int)>> sig_status;
-        sig_status = syscall_wrapper::signal_wrapper(SIGINT, &shell::ctrl_c_signal_handler); // termination requests
-
-        // error handle
-        if (!sig_status.has_value()) {
-            return;
-        }
-
         sig_status = syscall_wrapper::signal_wrapper(SIGQUIT, SIG_IGN);
 
         // error handle
@@ -94,9 +89,81 @@ shell::shell() : is_interactive{syscall_wrapper::isatty_wrapper(syscall_wrapper:
         if (!syscall_wrapper::tcgetattr_wrapper(syscall_wrapper::stdin_file_descriptor, term_if)) {
             throw std::runtime_error("Failed to get shell attributes...");
         }
+
+        // the shell edits lines itself so a paste reaches it in as few reads as possible, ctrl+c still raises SIGINT
+        raw_if = std::make_shared<termios>(*term_if);
+        raw_if->c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        raw_if->c_cc[VMIN] = 1;
+        raw_if->c_cc[VTIME] = 0;
+
+        // commands typed at the prompt are remembered across sessions, the shell works the same without a history file
+        if (!history::open_default()) {
+            cout_logger.log(LOG_LEVEL::WARN, "No history file, commands will not be remembered");
+        }
     } else {
         cout_logger.log(LOG_LEVEL::ERROR, "JSH must run interactively...");
     }
+
+    // the signals and the sources the shell watches in the background are registered once here instead of at every prompt
+    if (!setup_events()) {
+        throw std::runtime_error("Failed to set up the event reactor...");
+    }
+}
+
+auto shell::setup_events() -> bool {
+    // block SIGINT and SIGCHLD for good so they are only ever read through the signalfd
+    sigset_t sigs;
+    if (!syscall_wrapper::sigemptyset_wrapper(sigs) || !syscall_wrapper::sigaddset_wrapper(sigs, SIGINT) || !syscall_wrapper::sigaddset_wrapper(sigs, SIGCHLD) || !syscall_wrapper::sigprocmask_wrapper(SIG_BLOCK, sigs)) {
+        return false;
+    }
+
+    signals = syscall_wrapper::signalfd_wrapper(syscall_wrapper::invalid_file_descriptor, sigs, SFD_CLOEXEC);
+    events = reactor::create();
+    if (!signals.has_value() || !events.has_value()) {
+        return false;
+    }
+
+    // the handler only notes what happened, the prompt loop and supervised children act on it
+    if (!events->add(signals.value(), [this]() { read_signal(); }).has_value()) {
+        return false;
+    }
+
+    // background jobs with a timeout are killed while the shell waits for input
+    job_table::watch(&events.value());
+
+    // foreground children are waited on through the same signalfd, so no other one competes with it for SIGCHLD and SIGINT
+    process::watch(&events.value());
+
+    // tab completes from the executables on PATH, which are read in while the shell waits for input
+    completion::watch(&events.value());
+    editor.set_completer(&completion::complete, PROMPT_MESSAGE);
+    return true;
+}
+
+void shell::read_signal() {
+    assert(signals.has_value());
+
+    signalfd_siginfo sigfdinfo{};
+    ssize_t total_read = 0;
+    while (total_read != sizeof(sigfdinfo)) {
+        std::optional<ssize_t> const num_read = syscall_wrapper::read_wrapper(signals.value(), &sigfdinfo, sizeof(sigfdinfo)); // NOLINT assert catches this
+        if (!num_read.has_value()) {
+            return;
+        }
+        total_read += num_read.value();
+    }
+
+    // SIGCHLDs are coalesced, so drain every child which changed state, unless children are being supervised and collect their own
+    if (sigfdinfo.ssi_signo == SIGCHLD) {
+        if (!process::is_collecting()) {
+            job_table::reap();
+        }
+        return;
+    }
+
+    // we should only ever recieve a SIGINT otherwise
+    assert(sigfdinfo.ssi_signo == SIGINT);
+    process::interrupt();
 }
 
 auto shell::get() -> std::optional<std::shared_ptr<shell>> {
@@ -118,77 +185,123 @@ auto shell::get() -> std::optional<std::shared_ptr<shell>> {
     return shell_ptr;
 }
 
-auto shell::execute_command() -> bool {
-    // stack vars
-    std::string input;
+auto shell::active() -> bool {
+    return shell_ptr.has_value();
+}
 
-    // get the command from the user
-    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, PROMPT_MESSAGE);
+auto shell::execute_command() -> bool {
+    // report any background jobs which finished since the last prompt
+    job_table::reap();
+    job_table::notify();
 
-    // create the signal file descriptor for SIGINT
-    sigset_t sigs;
+    assert(shell_ptr.has_value());
+    shell& self = *shell_ptr.value(); // NOLINT assert catches this
 
-    bool const sigset_status = syscall_wrapper::sigemptyset_wrapper(sigs);
-    if (!sigset_status) {
+    // a paste leaves whole lines queued, they run one after another without going back to the terminal
+    if (!self.editor.buffered() && !self.read_input()) {
         return false;
     }
 
-    bool const sigadd_status = syscall_wrapper::sigaddset_wrapper(sigs, SIGINT);
-    if (!sigadd_status) {
-        return false;
+    // ctrl+c leaves nothing to run
+    std::optional<std::string> input = self.editor.next_line();
+    if (!input.has_value()) {
+        return true;
     }
 
-    // block the signal handlers
-    bool const sigprocmask_status = syscall_wrapper::sigprocmask_wrapper(SIG_BLOCK, sigs);
-    if (!sigprocmask_status) {
+    return run_line(std::move(input.value()), true);
+}
+
+auto shell::read_input() -> bool {
+    if (editor.is_closed()) {
         return false;
     }
 
-    // create signal fd
-    std::optional<file_descriptor_wrapper> sigfd_op = syscall_wrapper::signalfd_wrapper(syscall_wrapper::invalid_file_descriptor, sigs, 0);
-    if (!sigfd_op.has_value()) {
-        return false;
+    // get the command from the user
+    jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, PROMPT_MESSAGE);
+
+    // the terminal is raw only while the shell reads from it, jobs always start with the attributes the shell started with
+    bool const raw = raw_if != nullptr && syscall_wrapper::tcsetattr_wrapper(syscall_wrapper::stdin_file_descriptor, TCSANOW, raw_if);
+
+    // standard in is only registered while the shell reads it, a running job may leave input unread which would keep the reactor awake
+    assert(events.has_value());
+    std::optional<std::uint64_t> const input_token = events->add(syscall_wrapper::stdin_file_descriptor, [this]() { input_ready = true; }); // NOLINT assert catches this
+
+    // wait on the reactor until there is input, children exiting in the background and expired timers are handled along the way
+    // a ctrl+c which was read while a job ran belongs to that job
+    std::ignore = process::take_interrupt();
+    bool interrupted = false;
+    bool status = input_token.has_value();
+    while (status && !editor.buffered() && !editor.is_closed() && !interrupted) {
+        // while the executable trie is being built the reactor is only polled, the trie grows a step at a time whenever nothing else is ready
+        input_ready = false;
+        if (!events->dispatch(completion::building() ? 0 : -1)) { // NOLINT assert catches this
+            status = false;
+            break;
+        }
+        interrupted = process::take_interrupt();
+
+        // everything the terminal has ready is read at once
+        if (input_ready) {
+            std::ignore = editor.read(syscall_wrapper::stdin_file_descriptor, raw);
+        } else if (completion::building()) {
+            completion::build_step();
+        }
     }
-    file_descriptor_wrapper const sigfd = std::move(sigfd_op.value());
 
-    // poll the file descriptors
-    std::vector<syscall_wrapper::pollfd_wrapper> pfds;
-    pfds.emplace_back(sigfd, POLLIN, 0);
-    pfds.emplace_back(syscall_wrapper::stdin_file_descriptor, POLLIN, 0);
+    if (input_token.has_value()) {
+        events->remove(syscall_wrapper::stdin_file_descriptor, input_token.value()); // NOLINT assert catches this
+    }
 
-    // poll the fds
-    std::optional<int> const num_fds = syscall_wrapper::poll_wrapper(pfds, -1);
-    if (!num_fds.has_value()) {
-        return false;
+    if (raw) {
+        std::ignore = syscall_wrapper::tcsetattr_wrapper(syscall_wrapper::stdin_file_descriptor, TCSANOW, term_if);
     }
 
-    if (pfds[0].revents != 0) {
-        signalfd_siginfo sigfdinfo{};
+    if (interrupted) {
+        // add new return
+        editor.discard();
+        jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, '\n');
+    }
 
-        ssize_t total_read = 0;
+    // ctrl+d leaves the shell once the lines typed before it have run
+    if (editor.is_closed() && !editor.buffered()) {
+        jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, '\n');
+        return false;
+    }
+    return status;
+}
 
-        while (total_read != sizeof(sigfdinfo)) {
-            std::optional<ssize_t> num_read = syscall_wrapper::read_wrapper(sigfd, &sigfdinfo, sizeof(sigfdinfo));
+auto shell::run_script(line_reader& reader) -> int {
+    // the previous exit status starts out as zero, just like at the prompt, $$ is taken before anything is forked
+    environment::set_status(EXIT_SUCCESS);
+    environment::record_shell_pid();
 
-            // err handle
-            if (!num_read.has_value()) {
-                return false;
-            }
+    for (std::optional<std::string> line = reader.next_line(); line.has_value(); line = reader.next_line()) {
+        // background jobs are reaped between lines and leave the table once done, nobody is there to be told about them
+        job_table::reap();
+        job_table::forget();
 
-            // increment
-            total_read = total_read + num_read.value();
+        if (!run_line(std::move(line.value()), false)) {
+            break;
         }
+    }
 
-        // we should only ever recieve a SIGINT
-        assert(sigfdinfo.ssi_signo == SIGINT);
+    return environment::get_status();
+}
 
-        // add new return
-        jsh::cout_logger.log(jsh::LOG_LEVEL::SILENT, '\n');
-    } else if (pfds[1].revents != 0) {
-        std::getline(std::cin, input);
+auto shell::run_line(std::string input, bool interactive) -> bool {
+    // comments let a script start with a #! line
+    if (!interactive) {
+        auto const first = std::ranges::find_if_not(input, [](char chr) { return static_cast<bool>(std::isspace(chr)); });
+        if (first != std::end(input) && *first == COMMENT) {
+            return true;
+        }
     }
 
     jsh::cout_logger.log(jsh::LOG_LEVEL::DEBUG, "Raw user input: ", input);
+
+    // the line is remembered the way it was typed
+    std::optional<std::string> const typed = interactive && !std::ranges::all_of(input, [](char chr) { return static_cast<bool>(std::isspace(chr)); }) ? std::make_optional<std::string>(input) : std::nullopt;
+
     input = jsh::parsing::variable_substitution(input);
     jsh::cout_logger.log(jsh::LOG_LEVEL::DEBUG, "Substituted user input: ", input);
 
@@ -200,9 +313,21 @@ auto shell::execute_command() -> bool {
     // parse the job
     auto job_data = jsh::job::parse_job(input);
 
-    // execute the job
+    // without a terminal the job is waited on like a foreground job but never handed the terminal
+    if (!interactive) {
+        job_data->is_foreground = false;
+    }
+
+    // execute the job, timing it for the history
+    auto const started = std::chrono::system_clock::now();
+    auto const start = std::chrono::steady_clock::now();
     jsh::job::execute_job(job_data);
 
+    if (typed.has_value() && history::is_open()) {
+        history_entry const entry{.timestamp = std::chrono::duration_cast<std::chrono::seconds>(started.time_since_epoch()).count(), .duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(), .status = environment::get_status(), .command = typed.value()};
+        std::ignore = history::record(entry);
+    }
+
     // success
     return true;
 }
@@ -211,13 +336,5 @@ auto shell::get_term_if() -> std::shared_ptr<termios> {
     return term_if;
 }
 
-void shell::ctrl_c_signal_handler(int sig) {
-    // this handler should only ever run for ctrl+c
-    assert(sig == SIGINT);
-
-    // reprint the prompt message
-    std::cout << PROMPT_MESSAGE;
-}
-
 shell::~shell() = default;
 } // namespace jsh
@@ -3,12 +3,18 @@
 #include "pch.hpp"
 
 // JSH
+#include "completion.hpp"
 #include "environment.hpp"
+#include "history.hpp"
 #include "job.hpp"
+#include "job_table.hpp"
+#include "line_editor.hpp"
+#include "line_reader.hpp"
 #include "macros.hpp"
 #include "parsing.hpp"
 #include "posix_wrappers.hpp"
 #include "process.hpp"
+#include "reactor.hpp"
 
 namespace jsh {
 class shell {
@@ -17,6 +23,7 @@ class shell {
      *
      */
     static constexpr char const* PROMPT_MESSAGE = "prompt:";
+    static constexpr char COMMENT = '#';
     /**
      * is_interactice: indicates whether the shell is running in interactive mode
      */
@@ -27,12 +34,67 @@ class shell {
      */
     std::shared_ptr<termios> term_if;
 
+    /**
+     * raw_if: term_if without canonical mode or echo, the terminal is only put in it while the shell reads a line
+     */
+    std::shared_ptr<termios> raw_if;
+
+    /**
+     * editor: the lines typed or pasted at the terminal which have not run yet
+     */
+    line_editor editor;
+
+    /**
+     * signals: reads SIGINT and SIGCHLD, created once with the signals blocked for the lifetime of the shell
+     */
+    std::optional<file_descriptor_wrapper> signals;
+
+    /**
+     * events: the reactor the signals and the timers of background jobs stay registered with, foreground children are supervised through it as well
+     */
+    std::optional<reactor> events;
+
+    /**
+     * input_ready: set by the reactor once standard in is readable
+     */
+    bool input_ready = false;
+
+    /**
+     * setup_events: blocks the signals the shell reads, and registers the signals with the reactor
+     */
+    [[nodiscard]] auto setup_events() -> bool;
+
+    /**
+     * read_signal: handles one signal read from the signalfd
+     */
+    void read_signal();
+
+    /**
+     * read_input: prompts and waits on the reactor until at least one whole line has been typed or ctrl+c is pressed
+     *
+     * returns false once the terminal reaches end of file and every line typed before it has been handed out
+     */
+    [[nodiscard]] auto read_input() -> bool;
+
+    /**
+     * run_line: substitutes variables into one line of input and runs it as a job, returns false if we are to exit
+     *
+     * interactive: whether the job may take the terminal, scripts leave it alone and skip comment lines
+     */
+    [[nodiscard]] static auto run_line(std::string input, bool interactive) -> bool;
+
     /**
      * shell_ptr: a singleton pointing to the only install of the jsh shell
      */
     static std::optional<std::shared_ptr<shell>> shell_ptr;
 
   public:
+    /**
+     * CONSTANTS
+     */
+    static constexpr char const* COMMAND_FLAG = "-c";
+    static constexpr int USAGE_STATUS = 2;
+
     /**
      * constructor
      */
@@ -56,19 +118,26 @@ class shell {
      */
     [[nodiscard]] static auto get() -> std::optional<std::shared_ptr<shell>>;
 
+    /**
+     * active: whether the interactive shell has been created, scripts never create it and never touch the terminal
+     */
+    [[nodiscard]] static auto active() -> bool;
+
     /**
      * execute_command: recieves user input and executes their command, returns false if we are to exit
      */
     [[nodiscard]] static auto execute_command() -> bool;
 
     /**
-     * get_term_if: returns the terminal interface pointer
+     * run_script: runs every line of reader without a prompt, the terminal, job control or the shell singleton
+     *
+     * returns the exit status of the last job
      */
-    [[nodiscard]] auto get_term_if() -> std::shared_ptr<termios>;
+    [[nodiscard]] static auto run_script(line_reader& reader) -> int;
 
     /**
-     * ctrl_c_signal_handler: handles the ctrl+c input to print a new line
+     * get_term_if: returns the terminal interface pointer
      */
-    static void ctrl_c_signal_handler(int sig);
+    [[nodiscard]] auto get_term_if() -> std::shared_ptr<termios>;
 };
 } // namespace jsh
@@ -0,0 +1,181 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// STL
+#include <fstream>
+
+// JSH
+#include <builtins.hpp>
+#include <job.hpp>
+#include <parallel.hpp>
+#include <posix_wrappers.hpp>
+
+namespace {
+/**
+ * read_file: reads the whole file into a string
+ */
+auto read_file(char const* file) -> std::string {
+    std::ifstream stream(file);
+    std::stringstream contents;
+    contents << stream.rdbuf();
+    return contents.str();
+}
+} // namespace
+
+TEST(TestBuiltins, TestFind) {
+    // the simple commands are builtins, anything else is not
+    ASSERT_TRUE(jsh::builtins::find("echo").has_value());
+    ASSERT_TRUE(jsh::builtins::find("cd").has_value());
+    ASSERT_FALSE(jsh::builtins::find("grep").has_value());
+}
+
+TEST(TestBuiltins, TestAdd) {
+    // register a new builtin
+    jsh::builtins::add("jsh_test_builtin", [](std::vector<std::string> const& args) -> int { return static_cast<int>(args.size()); });
+
+    // it should be parsed and run like any other builtin
+    auto job = jsh::job::parse_job("jsh_test_builtin a b");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(jsh::environment::get_status(), 3);
+}
+
+TEST(TestBuiltins, TestEchoRedirection) {
+    // Test constants
+    static constexpr char const* FILE = "testing/tmp/file";
+    static constexpr char const* CMD = "echo -n builtin echo > testing/tmp/file";
+
+    // parse the process
+    auto proc_data = jsh::process::parse_process(CMD);
+    ASSERT_TRUE(proc_data.has_value());
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+
+    // the builtin runs in the shell and writes to the file
+    jsh::process::execute(proc_data.value()); // NOLINT assert catches this .value()
+    ASSERT_EQ(read_file(FILE), "builtin echo");
+    ASSERT_EQ(jsh::environment::get_status(), EXIT_SUCCESS);
+}
+
+TEST(TestBuiltins, TestTrueFalse) {
+    // false sets a failing status and stops an && chain
+    auto job = jsh::job::parse_job("false && true");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status_seq[0], EXIT_FAILURE);
+    ASSERT_EQ(job->status_seq[1], -1);
+    ASSERT_STRNE(jsh::environment::get_var("?"), jsh::environment::SUCCESS_STRING);
+}
+
+TEST(TestBuiltins, TestPrintf) {
+    // Test constants
+    static constexpr char const* FILE = "testing/tmp/file";
+    static constexpr char const* CMD = R"(printf "%s=%d\\n" a 1 b 2 > testing/tmp/file)";
+
+    // the format is reused for the rest of the arguments, the backslash itself has to be escaped for the parser
+    auto job = jsh::job::parse_job(CMD);
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(read_file(FILE), "a=1\nb=2\n");
+}
+
+TEST(TestBuiltins, TestCd) {
+    // remember where the tests are running
+    std::optional<std::string> const cwd = jsh::syscall_wrapper::getcwd_wrapper();
+    ASSERT_TRUE(cwd.has_value());
+
+    // cd changes the shell's own directory
+    auto job = jsh::job::parse_job("cd testing");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(jsh::syscall_wrapper::getcwd_wrapper(), cwd.value() + "/testing"); // NOLINT assert catches this .value()
+    ASSERT_STREQ(jsh::environment::get_var("OLDPWD"), cwd.value().c_str());      // NOLINT assert catches this .value()
+
+    // a missing directory fails without moving
+    job = jsh::job::parse_job("cd not_a_real_directory");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(jsh::environment::get_status(), EXIT_FAILURE);
+
+    // go back for the rest of the tests
+    ASSERT_TRUE(jsh::syscall_wrapper::chdir_wrapper(cwd.value())); // NOLINT assert catches this .value()
+}
+
+TEST(TestBuiltins, TestPipeline) {
+    // Test constants
+    static constexpr char const* FILE = "testing/tmp/file";
+    static constexpr char const* CMD = "echo piped builtin | grep -c builtin > testing/tmp/file";
+
+    // a builtin in a pipeline runs in a copy of the shell
+    auto job = jsh::job::parse_job(CMD);
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status_seq[0], EXIT_SUCCESS);
+    ASSERT_EQ(read_file(FILE), "1\n");
+}
+
+TEST(TestBuiltins, TestParallelArgs) {
+    // flags come before the template
+    std::optional<jsh::parallel_options> options = jsh::parallel::parse_args({"parallel", "-j", "3", "-k", "gzip", "-9", "{}"});
+    ASSERT_TRUE(options.has_value());
+    ASSERT_EQ(options->jobs, 3); // NOLINT assert catches this
+    ASSERT_TRUE(options->keep_order); // NOLINT assert catches this
+    ASSERT_EQ(options->command_template.size(), 3); // NOLINT assert catches this
+
+    // -jN works as well, but not zero jobs
+    options = jsh::parallel::parse_args({"parallel", "-j8"});
+    ASSERT_TRUE(options.has_value());
+    ASSERT_EQ(options->jobs, 8); // NOLINT assert catches this
+    ASSERT_FALSE(jsh::parallel::parse_args({"parallel", "-j", "0"}).has_value());
+    ASSERT_FALSE(jsh::parallel::parse_args({"parallel", "-j"}).has_value());
+
+    // every {} is replaced, a template without one takes the line at the end, no template runs the line itself
+    ASSERT_EQ(jsh::parallel::expand({"cp", "{}", "{}.bak"}, "a.txt"), "cp a.txt a.txt.bak");
+    ASSERT_EQ(jsh::parallel::expand({"gzip"}, "a.txt"), "gzip a.txt");
+    ASSERT_EQ(jsh::parallel::expand({}, "echo hi"), "echo hi");
+}
+
+TEST(TestBuiltins, TestParallelRun) {
+    // more commands than workers, so the workers have to steal from each other
+    std::vector<std::string> commands;
+    std::string expected;
+    for (int i = 0; i < 40; ++i) {
+        commands.push_back("echo line " + std::to_string(i));
+        expected += "line " + std::to_string(i) + '\n';
+    }
+    commands.emplace_back("false");
+
+    // the output comes back in input order and the failure is counted
+    std::ostringstream stream;
+    jsh::logger log(stream);
+    ASSERT_EQ(jsh::parallel::run(commands, 4, true, log), 1);
+    ASSERT_EQ(stream.str(), expected);
+}
+
+TEST(TestBuiltins, TestParallelCancel) {
+    jsh::work_ranges ranges(2, 10);
+    ASSERT_TRUE(ranges.valid());
+    ASSERT_EQ(ranges.claim(0), 0);
+
+    // once cancelled no worker claims another command, even with commands left in its own range
+    ranges.cancel();
+    ASSERT_FALSE(ranges.claim(0).has_value());
+    ASSERT_FALSE(ranges.claim(1).has_value());
+}
+
+TEST(TestBuiltins, TestParallelPipeline) {
+    // Test constants
+    static constexpr char const* FILE = "testing/tmp/file";
+    static constexpr char const* CMD = "seq 1 20 | parallel -j 4 -k expr {} + 100 > testing/tmp/file";
+
+    // every line of standard in becomes a command, run through the job machinery
+    auto job = jsh::job::parse_job(CMD);
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+
+    std::string expected;
+    for (int i = 101; i <= 120; ++i) {
+        expected += std::to_string(i) + '\n';
+    }
+    ASSERT_EQ(read_file(FILE), expected);
+}
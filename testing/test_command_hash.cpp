@@ -0,0 +1,63 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// JSH
+#include <command_hash.hpp>
+#include <posix_wrappers.hpp>
+
+TEST(TestCommandHash, TestLookupOnPath) {
+    // a command which is on PATH everywhere
+    std::optional<std::string> path = jsh::command_hash::lookup("sh");
+
+    // make sure it was found and that the path is a real file
+    ASSERT_TRUE(path.has_value());
+    ASSERT_TRUE(path.value().ends_with("/sh")); // NOLINT assert catches this .value()
+    ASSERT_EQ(access(path.value().c_str(), X_OK), 0); // NOLINT assert catches this .value()
+
+    // a second lookup should give the same answer
+    ASSERT_EQ(jsh::command_hash::lookup("sh"), path);
+}
+
+TEST(TestCommandHash, TestLookupMiss) {
+    // misses are remembered but still reported
+    ASSERT_FALSE(jsh::command_hash::lookup("definitely_not_a_jsh_command").has_value());
+    ASSERT_FALSE(jsh::command_hash::lookup("definitely_not_a_jsh_command").has_value());
+}
+
+TEST(TestCommandHash, TestLookupPath) {
+    // anything with a slash is used as is
+    ASSERT_EQ(jsh::command_hash::lookup("testing/tmp/not_real"), "testing/tmp/not_real");
+}
+
+TEST(TestCommandHash, TestInvalidation) {
+    // Test constants
+    static constexpr char const* DIR = "testing/tmp";
+    static constexpr char const* CMD = "jsh_hash_cmd";
+    static constexpr char const* FILE = "testing/tmp/jsh_hash_cmd";
+    static constexpr mode_t MODE = 0777;
+
+    // point PATH at the tmp directory
+    std::string const old_path = jsh::environment::get_var("PATH");
+    jsh::environment::set_var("PATH", DIR);
+    jsh::command_hash::invalidate_path();
+
+    // the command does not exist yet
+    unlink(FILE);
+    ASSERT_FALSE(jsh::command_hash::lookup(CMD).has_value());
+
+    // creating the command should be noticed through inotify
+    {
+        std::optional<jsh::file_descriptor_wrapper> fides = jsh::syscall_wrapper::open_wrapper(FILE, O_WRONLY | O_CREAT | O_TRUNC, MODE);
+        ASSERT_TRUE(fides.has_value());
+    }
+    ASSERT_EQ(chmod(FILE, MODE), 0);
+    ASSERT_EQ(jsh::command_hash::lookup(CMD), std::string(DIR) + "/" + CMD);
+
+    // removing it should be noticed as well
+    ASSERT_EQ(unlink(FILE), 0);
+    ASSERT_FALSE(jsh::command_hash::lookup(CMD).has_value());
+
+    // restore PATH
+    jsh::environment::set_var("PATH", old_path.c_str());
+    jsh::command_hash::invalidate_path();
+}
@@ -0,0 +1,171 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// STL
+#include <fstream>
+
+// JSH
+#include <completion.hpp>
+#include <environment.hpp>
+#include <job.hpp>
+#include <line_editor.hpp>
+#include <reactor.hpp>
+
+namespace {
+/**
+ * make_file: creates a file at path with the given permissions
+ */
+void make_file(std::filesystem::path const& path, std::filesystem::perms perms) {
+    std::ofstream{path} << "#!/bin/sh\n";
+    std::filesystem::permissions(path, perms);
+}
+} // namespace
+
+TEST(TestCompletion, TestTrie) {
+    jsh::executable_trie trie;
+    for (char const* name : {"grep", "git", "gitk", "gcc", "g++", "ls"}) {
+        trie.insert(name);
+    }
+    ASSERT_EQ(trie.size(), 6);
+
+    // the matches share nothing past the prefix, so they are listed in order
+    jsh::trie_matches matches = trie.complete("g", 10);
+    ASSERT_EQ(matches.total, 5);
+    ASSERT_EQ(matches.common, "");
+    ASSERT_EQ(matches.names, (std::vector<std::string>{"g++", "gcc", "git", "gitk", "grep"}));
+
+    // the shared characters stop where a name ends
+    matches = trie.complete("gi", 1);
+    ASSERT_EQ(matches.total, 2);
+    ASSERT_EQ(matches.common, "t");
+    ASSERT_EQ(matches.names.size(), 1);
+
+    matches = trie.complete("gr", 10);
+    ASSERT_EQ(matches.common, "ep");
+    ASSERT_EQ(trie.complete("x", 10).total, 0);
+
+    // a name found in two directories stays until both are gone
+    trie.insert("ls");
+    trie.erase("ls");
+    ASSERT_TRUE(trie.contains("ls"));
+    trie.erase("ls");
+    ASSERT_FALSE(trie.contains("ls"));
+    ASSERT_EQ(trie.complete("l", 10).total, 0);
+
+    // pruned nodes are reused
+    trie.erase("gitk");
+    trie.insert("gitx");
+    ASSERT_EQ(trie.complete("git", 10).names, (std::vector<std::string>{"git", "gitx"}));
+    ASSERT_EQ(trie.size(), 5);
+}
+
+TEST(TestCompletion, TestTrieLatency) {
+    // as many executables as a toolchain image puts on PATH
+    static constexpr int NUM_NAMES = 20000;
+    jsh::executable_trie trie;
+    for (int i = 0; i < NUM_NAMES; ++i) {
+        trie.insert("tool-" + std::to_string(i % 7) + "-" + std::to_string(i));
+    }
+    ASSERT_EQ(trie.size(), NUM_NAMES);
+
+    static constexpr int RUNS = 100;
+    std::size_t total = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (int run = 0; run < RUNS; ++run) {
+        total += trie.complete("tool-", 100).total + trie.complete("tool-3-1", 100).total;
+    }
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_GT(total, 0);
+    ASSERT_LT(elapsed / (2 * RUNS), std::chrono::milliseconds(1));
+}
+
+TEST(TestCompletion, TestPath) {
+    std::filesystem::path const bin_a = "testing/tmp/completion_a";
+    std::filesystem::path const bin_b = "testing/tmp/completion_b";
+    std::filesystem::remove_all(bin_a);
+    std::filesystem::remove_all(bin_b);
+    std::filesystem::create_directories(bin_a);
+    std::filesystem::create_directories(bin_b);
+    make_file(bin_a / "jshcomp_alpha", std::filesystem::perms::owner_all);
+    make_file(bin_a / "jshcomp_beta", std::filesystem::perms::owner_all);
+    make_file(bin_a / "jshcomp_data", std::filesystem::perms::owner_read);
+    make_file(bin_b / "jshcomp_gamma", std::filesystem::perms::owner_all);
+
+    std::string const old_path = jsh::environment::get_var("PATH");
+    jsh::environment::set_var("PATH", bin_a.c_str());
+
+    std::optional<jsh::reactor> events = jsh::reactor::create();
+    ASSERT_TRUE(events.has_value());
+    jsh::completion::watch(&events.value()); // NOLINT assert catches this
+
+    // the trie is read in a step at a time, completing finishes it first
+    ASSERT_TRUE(jsh::completion::building());
+    jsh::completion_result result = jsh::completion::complete("jshcomp_");
+    ASSERT_FALSE(jsh::completion::building());
+    ASSERT_EQ(result.total, 2);
+    ASSERT_EQ(result.candidates, (std::vector<std::string>{"jshcomp_alpha", "jshcomp_beta"}));
+    ASSERT_EQ(jsh::completion::complete("ls | jshcomp_a").suffix, "lpha ");
+
+    // executables created or removed on disk are picked up from inotify
+    make_file(bin_a / "jshcomp_delta", std::filesystem::perms::owner_all);
+    std::filesystem::remove(bin_a / "jshcomp_beta");
+    std::filesystem::permissions(bin_a / "jshcomp_data", std::filesystem::perms::owner_all);
+    ASSERT_TRUE(events->dispatch(0)); // NOLINT assert catches this
+    ASSERT_TRUE(jsh::completion::contains("jshcomp_delta"));
+    ASSERT_TRUE(jsh::completion::contains("jshcomp_data"));
+    ASSERT_FALSE(jsh::completion::contains("jshcomp_beta"));
+
+    // exporting PATH only reads the directories which are new
+    auto job = jsh::job::parse_job("export PATH=" + bin_b.string());
+    jsh::job::execute_job(job);
+    ASSERT_FALSE(jsh::completion::contains("jshcomp_alpha"));
+    ASSERT_EQ(jsh::completion::complete("jshcomp_").suffix, "gamma ");
+
+    jsh::completion::watch(nullptr);
+    jsh::environment::set_var("PATH", old_path.c_str());
+}
+
+TEST(TestCompletion, TestFile) {
+    std::filesystem::path const dir = "testing/tmp/completion_files";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "subdir");
+    make_file(dir / "notes.txt", std::filesystem::perms::owner_read);
+    make_file(dir / "notes.md", std::filesystem::perms::owner_read);
+    make_file(dir / ".hidden", std::filesystem::perms::owner_read);
+
+    // arguments and paths complete from the directory they name
+    jsh::completion_result result = jsh::completion::complete("cat testing/tmp/completion_files/no");
+    ASSERT_EQ(result.suffix, "tes.");
+    ASSERT_EQ(jsh::completion::complete("cat testing/tmp/completion_files/notes.").candidates, (std::vector<std::string>{"notes.md", "notes.txt"}));
+    ASSERT_EQ(jsh::completion::complete("cat testing/tmp/completion_files/notes.t").suffix, "xt ");
+    ASSERT_EQ(jsh::completion::complete("./testing/tmp/completion_files/s").suffix, "ubdir/");
+
+    // hidden files are only completed when asked for
+    ASSERT_EQ(jsh::completion::complete("cat testing/tmp/completion_files/").total, 3);
+    ASSERT_EQ(jsh::completion::complete("cat testing/tmp/completion_files/.").suffix, "hidden ");
+}
+
+TEST(TestCompletion, TestLineEditor) {
+    jsh::line_editor editor;
+    std::string echo;
+
+    // without a completer a tab is whitespace
+    editor.feed("a\tb", echo);
+    ASSERT_EQ(echo, "a\tb");
+    editor.feed("\x15", echo);
+
+    editor.set_completer(
+        [](std::string_view line) -> jsh::completion_result {
+            if (line == "gi") {
+                return {.suffix = "t", .candidates = {"git", "gitk"}, .total = 2};
+            }
+            return {.suffix = "", .candidates = {"git", "gitk"}, .total = 3};
+        },
+        "prompt:");
+
+    // the shared characters are added, then the candidates are listed under the line
+    echo.clear();
+    editor.feed("gi\t\t\n", echo);
+    ASSERT_EQ(echo, "git\ngit  gitk  ... (1 more)\nprompt:git\n");
+    ASSERT_EQ(editor.next_line(), "git");
+}
@@ -35,3 +35,91 @@ TEST(TestEnvironment, EnvironmentGetUnset) {
     // make sure if the environment variable is unset, then it returns an empty string
     ASSERT_FALSE(std::strcmp(jsh::environment::get_var("NOT SET"), ""));
 }
+
+TEST(TestEnvironment, EnvironmentStatusLazy) {
+    // setting the status does not touch the environment
+    jsh::environment::set_status(0);
+    ASSERT_STREQ(jsh::environment::get_var("?"), "0");
+    jsh::environment::set_status(42); // NOLINT
+    ASSERT_EQ(jsh::environment::get_status(), 42);
+
+    // $? is formatted once someone reads it, and is never handed to binaries
+    ASSERT_STREQ(jsh::environment::get_var("?"), "42");
+    ASSERT_FALSE(jsh::environment::is_exported("?"));
+    for (char** env = jsh::environment::envp(); *env != nullptr; ++env) { // NOLINT envp is null terminated
+        ASSERT_FALSE(std::string_view(*env).starts_with("?="));
+    }
+}
+
+TEST(TestEnvironment, EnvironmentLocal) {
+    // a local variable is seen by the shell but not by binaries
+    jsh::environment::set_local("JSH_TEST_LOCAL", "local");
+    ASSERT_STREQ(jsh::environment::get_var("JSH_TEST_LOCAL"), "local");
+    ASSERT_FALSE(jsh::environment::is_exported("JSH_TEST_LOCAL"));
+
+    // assigning to an exported variable keeps it exported
+    jsh::environment::set_var("JSH_TEST_EXPORTED", "one");
+    jsh::environment::set_local("JSH_TEST_EXPORTED", "two");
+    ASSERT_TRUE(jsh::environment::is_exported("JSH_TEST_EXPORTED"));
+
+    std::vector<std::string_view> env;
+    for (char** entry = jsh::environment::envp(); *entry != nullptr; ++entry) { // NOLINT envp is null terminated
+        env.emplace_back(*entry);
+    }
+    ASSERT_NE(std::ranges::find(env, "JSH_TEST_EXPORTED=two"), std::end(env));
+    ASSERT_EQ(std::ranges::find_if(env, [](std::string_view entry) { return entry.starts_with("JSH_TEST_LOCAL="); }), std::end(env));
+
+    // exporting a local variable hands it to binaries from then on
+    jsh::environment::set_var("JSH_TEST_LOCAL", "exported");
+    ASSERT_TRUE(jsh::environment::is_exported("JSH_TEST_LOCAL"));
+    env.clear();
+    for (char** entry = jsh::environment::envp(); *entry != nullptr; ++entry) { // NOLINT envp is null terminated
+        env.emplace_back(*entry);
+    }
+    ASSERT_NE(std::ranges::find(env, "JSH_TEST_LOCAL=exported"), std::end(env));
+}
+
+TEST(TestEnvironment, EnvironmentEnvpCached) {
+    // envp is only rebuilt once an exported variable changes
+    jsh::environment::set_var("JSH_TEST_CACHED", "a");
+    char** const first = jsh::environment::envp();
+    ASSERT_EQ(jsh::environment::envp(), first);
+    jsh::environment::set_local("JSH_TEST_CACHED_LOCAL", "b");
+    jsh::environment::set_var("JSH_TEST_CACHED", "a");
+    ASSERT_EQ(jsh::environment::envp(), first);
+
+    jsh::environment::set_var("JSH_TEST_CACHED", "c");
+    bool found = false;
+    for (char** entry = jsh::environment::envp(); *entry != nullptr; ++entry) { // NOLINT envp is null terminated
+        found = found || std::string_view(*entry) == "JSH_TEST_CACHED=c";
+    }
+    ASSERT_TRUE(found);
+
+    // the environment the C library reads is never pointed into the rebuilt array
+    ASSERT_EQ(getenv("JSH_TEST_CACHED"), nullptr); // NOLINT
+}
+
+TEST(TestEnvironment, EnvironmentTable) {
+    // the table grows past its first size and finds every variable again
+    static constexpr std::size_t NUM_VARIABLES = 5000;
+    jsh::variable_table table;
+    for (std::size_t i = 0; i < NUM_VARIABLES; ++i) {
+        auto [var, visible] = table.set("VAR_" + std::to_string(i), std::to_string(i), i % 2 == 0);
+        ASSERT_EQ(visible, i % 2 == 0);
+    }
+    ASSERT_EQ(table.size(), NUM_VARIABLES);
+    for (std::size_t i = 0; i < NUM_VARIABLES; ++i) {
+        jsh::variable const* const var = table.find("VAR_" + std::to_string(i));
+        ASSERT_NE(var, nullptr);
+        ASSERT_EQ(var->value, std::to_string(i));
+        ASSERT_EQ(var->exported, i % 2 == 0);
+    }
+    ASSERT_EQ(table.find("VAR_"), nullptr);
+
+    // setting a variable again only shows binaries a difference if it is exported and changed
+    ASSERT_FALSE(table.set("VAR_0", "0", std::nullopt).second);
+    ASSERT_TRUE(table.set("VAR_0", "changed", std::nullopt).second);
+    ASSERT_FALSE(table.set("VAR_1", "changed", std::nullopt).second);
+    ASSERT_TRUE(table.set("VAR_1", "changed", true).second);
+    ASSERT_EQ(table.size(), NUM_VARIABLES);
+}
@@ -0,0 +1,87 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// JSH
+#include <history.hpp>
+#include <posix_wrappers.hpp>
+
+TEST(TestHistory, TestFormat) {
+    jsh::history_entry const entry{.timestamp = 1700000000, .duration_ms = 42, .status = 1, .command = "echo a\tb\nc"};
+    std::string const line = jsh::history::format(entry);
+    ASSERT_EQ(line, "1700000000\t42\t1\techo a\tb c\n");
+
+    // the command keeps its tabs
+    std::optional<jsh::history_entry> const parsed = jsh::history::parse(std::string_view(line).substr(0, line.size() - 1));
+    ASSERT_TRUE(parsed.has_value());
+    ASSERT_EQ(parsed->timestamp, 1700000000); // NOLINT assert catches this
+    ASSERT_EQ(parsed->duration_ms, 42);       // NOLINT assert catches this
+    ASSERT_EQ(parsed->status, 1);             // NOLINT assert catches this
+    ASSERT_EQ(parsed->command, "echo a\tb c"); // NOLINT assert catches this
+
+    ASSERT_FALSE(jsh::history::parse("not a record").has_value());
+    ASSERT_FALSE(jsh::history::parse("1\t2").has_value());
+}
+
+TEST(TestHistory, TestSessions) {
+    std::string const path = "testing/tmp/history";
+    std::filesystem::remove(path);
+    ASSERT_TRUE(jsh::history::open(path, 10));
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(jsh::history::record(jsh::history_entry{.timestamp = i, .duration_ms = i, .status = 0, .command = "cmd " + std::to_string(i)}));
+    }
+
+    // another session appends to the same file
+    std::optional<jsh::file_descriptor_wrapper> const other = jsh::syscall_wrapper::open_wrapper(path, O_WRONLY | O_APPEND | O_CLOEXEC, 0);
+    ASSERT_TRUE(other.has_value());
+    std::string const line = jsh::history::format(jsh::history_entry{.timestamp = 3, .duration_ms = 0, .status = 2, .command = "other"});
+    ASSERT_EQ(jsh::syscall_wrapper::write_wrapper(other.value(), line.data(), line.size()), line.size()); // NOLINT assert catches this
+
+    std::vector<jsh::history_entry> const entries = jsh::history::recent(10);
+    ASSERT_EQ(entries.size(), 4);
+    ASSERT_EQ(entries[0].command, "cmd 0");
+    ASSERT_EQ(entries[3].command, "other");
+    ASSERT_EQ(entries[3].status, 2);
+
+    // only the newest entries are handed out
+    std::vector<jsh::history_entry> const last = jsh::history::recent(2);
+    ASSERT_EQ(last.size(), 2);
+    ASSERT_EQ(last[0].command, "cmd 2");
+
+    jsh::history::close();
+    ASSERT_FALSE(jsh::history::record(jsh::history_entry{.timestamp = 0, .duration_ms = 0, .status = 0, .command = "closed"}));
+}
+
+TEST(TestHistory, TestCompact) {
+    std::string const path = "testing/tmp/history";
+    std::filesystem::remove(path);
+    ASSERT_TRUE(jsh::history::open(path, 5));
+
+    for (int i = 0; i < 20; ++i) {
+        ASSERT_TRUE(jsh::history::record(jsh::history_entry{.timestamp = i, .duration_ms = 0, .status = 0, .command = "cmd " + std::to_string(i)}));
+    }
+    ASSERT_TRUE(jsh::history::compact());
+
+    // the newest entries survive
+    std::vector<jsh::history_entry> entries = jsh::history::recent(100);
+    ASSERT_EQ(entries.size(), 5);
+    ASSERT_EQ(entries[0].command, "cmd 15");
+    ASSERT_EQ(entries[4].command, "cmd 19");
+
+    // appending follows the file to its replacement
+    ASSERT_TRUE(jsh::history::record(jsh::history_entry{.timestamp = 20, .duration_ms = 0, .status = 0, .command = "cmd 20"}));
+    entries = jsh::history::recent(100);
+    ASSERT_EQ(entries.size(), 6);
+    ASSERT_EQ(entries[5].command, "cmd 20");
+
+    // a file holding more than twice the limit is compacted by a child when it is opened
+    jsh::history::close();
+    ASSERT_TRUE(jsh::history::open(path, 2));
+    int wait_status = 0;
+    ASSERT_GT(wait(&wait_status), 0);
+    ASSERT_TRUE(WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == EXIT_SUCCESS);
+    entries = jsh::history::recent(100);
+    ASSERT_EQ(entries.size(), 2);
+    ASSERT_EQ(entries[1].command, "cmd 20");
+    jsh::history::close();
+}
@@ -1,8 +1,12 @@
 // GTEST
 #include <gtest/gtest.h>
 
+// STL
+#include <fstream>
+
 // JSH
 #include <job.hpp>
+#include <job_table.hpp>
 #include <posix_wrappers.hpp>
 
 TEST(TestJob, TestParseJobNoOperators) {
@@ -17,7 +21,7 @@ TEST(TestJob, TestParseJobNoOperators) {
     ASSERT_TRUE(job->operator_seq.empty());
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi");
 }
 
 TEST(TestJob, TestParseJobAndBasic1) {
@@ -32,8 +36,8 @@ TEST(TestJob, TestParseJobAndBasic1) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi ");
-    ASSERT_STREQ(job->input_seq[1].c_str(), " echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi ");
+    ASSERT_EQ(job->input_seq[1], " echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
 }
 
@@ -49,8 +53,8 @@ TEST(TestJob, TestParseJobAndBasic2) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi");
-    ASSERT_STREQ(job->input_seq[1].c_str(), " echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi");
+    ASSERT_EQ(job->input_seq[1], " echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
 }
 
@@ -66,8 +70,8 @@ TEST(TestJob, TestParseJobAndBasic3) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi ");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi ");
+    ASSERT_EQ(job->input_seq[1], "echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
 }
 
@@ -83,8 +87,8 @@ TEST(TestJob, TestParseJobAndBasic4) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi");
+    ASSERT_EQ(job->input_seq[1], "echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
 }
 
@@ -100,8 +104,8 @@ TEST(TestJob, TestParseJobAndEdge1) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "");
+    ASSERT_EQ(job->input_seq[0], "");
+    ASSERT_EQ(job->input_seq[1], "");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
 }
 
@@ -116,10 +120,11 @@ TEST(TestJob, TestParseJobAndEdge2) {
     ASSERT_TRUE(job->input_seq.size() == 2);
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
-    // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "&");
+    // ensure correct contents for input and operator sequence, the third & is a trailing &
+    ASSERT_EQ(job->input_seq[0], "");
+    ASSERT_EQ(job->input_seq[1], "");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
+    ASSERT_TRUE(job->is_background);
 }
 
 TEST(TestJob, TestParseJobAndEdge3) {
@@ -134,9 +139,9 @@ TEST(TestJob, TestParseJobAndEdge3) {
     ASSERT_TRUE(job->operator_seq.size() == 2);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "");
-    ASSERT_STREQ(job->input_seq[2].c_str(), "");
+    ASSERT_EQ(job->input_seq[0], "");
+    ASSERT_EQ(job->input_seq[1], "");
+    ASSERT_EQ(job->input_seq[2], "");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
     ASSERT_EQ(job->operator_seq[1], jsh::job::OPERATOR::AND);
 }
@@ -153,9 +158,9 @@ TEST(TestJob, TestParseJobAndEdge4) {
     ASSERT_TRUE(job->operator_seq.size() == 2);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "a");
-    ASSERT_STREQ(job->input_seq[2].c_str(), " command");
+    ASSERT_EQ(job->input_seq[0], "");
+    ASSERT_EQ(job->input_seq[1], "a");
+    ASSERT_EQ(job->input_seq[2], " command");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
     ASSERT_EQ(job->operator_seq[1], jsh::job::OPERATOR::AND);
 }
@@ -172,8 +177,8 @@ TEST(TestJob, TestParseJobAndEdge5) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "aa");
-    ASSERT_STREQ(job->input_seq[1].c_str(), " command");
+    ASSERT_EQ(job->input_seq[0], "aa");
+    ASSERT_EQ(job->input_seq[1], " command");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::AND);
 }
 
@@ -189,8 +194,8 @@ TEST(TestJob, TestParseJobPipeBasic1) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi ");
-    ASSERT_STREQ(job->input_seq[1].c_str(), " echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi ");
+    ASSERT_EQ(job->input_seq[1], " echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
 }
 
@@ -206,8 +211,8 @@ TEST(TestJob, TestParseJobPipeBasic2) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi");
-    ASSERT_STREQ(job->input_seq[1].c_str(), " echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi");
+    ASSERT_EQ(job->input_seq[1], " echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
 }
 
@@ -223,8 +228,8 @@ TEST(TestJob, TestParseJobPipeBasic3) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi ");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi ");
+    ASSERT_EQ(job->input_seq[1], "echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
 }
 
@@ -240,8 +245,8 @@ TEST(TestJob, TestParseJobPipeBasic4) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "echo hi");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "echo hi");
+    ASSERT_EQ(job->input_seq[0], "echo hi");
+    ASSERT_EQ(job->input_seq[1], "echo hi");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
 }
 
@@ -257,14 +262,14 @@ TEST(TestJob, TestParseJobPipeEdge1) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "");
+    ASSERT_EQ(job->input_seq[0], "");
+    ASSERT_EQ(job->input_seq[1], "");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
 }
 
 TEST(TestJob, TestParseJobPipeEdge2) {
     // input
-    std::string const input = "||";
+    std::string const input = "|||";
 
     auto job = jsh::job::parse_job(input);
 
@@ -273,11 +278,11 @@ TEST(TestJob, TestParseJobPipeEdge2) {
     ASSERT_TRUE(job->input_seq.size() == 3);
     ASSERT_TRUE(job->operator_seq.size() == 2);
 
-    // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "");
-    ASSERT_STREQ(job->input_seq[2].c_str(), "");
-    ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
+    // ensure correct contents for input and operator sequence, || is matched before |
+    ASSERT_EQ(job->input_seq[0], "");
+    ASSERT_EQ(job->input_seq[1], "");
+    ASSERT_EQ(job->input_seq[2], "");
+    ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::OR);
     ASSERT_EQ(job->operator_seq[1], jsh::job::OPERATOR::PIPE);
 }
 
@@ -293,9 +298,9 @@ TEST(TestJob, TestParseJobPipeEdge3) {
     ASSERT_TRUE(job->operator_seq.size() == 2);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "");
-    ASSERT_STREQ(job->input_seq[1].c_str(), "a");
-    ASSERT_STREQ(job->input_seq[2].c_str(), " command");
+    ASSERT_EQ(job->input_seq[0], "");
+    ASSERT_EQ(job->input_seq[1], "a");
+    ASSERT_EQ(job->input_seq[2], " command");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
     ASSERT_EQ(job->operator_seq[1], jsh::job::OPERATOR::PIPE);
 }
@@ -312,11 +317,136 @@ TEST(TestJob, TestParseJobPipeEdge4) {
     ASSERT_TRUE(job->operator_seq.size() == 1);
 
     // ensure correct contents for input and operator sequence
-    ASSERT_STREQ(job->input_seq[0].c_str(), "aa");
-    ASSERT_STREQ(job->input_seq[1].c_str(), " command");
+    ASSERT_EQ(job->input_seq[0], "aa");
+    ASSERT_EQ(job->input_seq[1], " command");
     ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
 }
 
+TEST(TestJob, TestParseJobControlFlow) {
+    // input
+    std::string const input = "a || b | c; d && e";
+
+    auto job = jsh::job::parse_job(input);
+
+    // ensure correct sizing
+    ASSERT_TRUE(job->input_seq.size() == 5);
+    ASSERT_TRUE(job->operator_seq.size() == 4);
+
+    // ensure correct contents for input and operator sequence
+    ASSERT_EQ(job->input_seq[0], "a ");
+    ASSERT_EQ(job->input_seq[1], " b ");
+    ASSERT_EQ(job->input_seq[2], " c");
+    ASSERT_EQ(job->input_seq[3], " d ");
+    ASSERT_EQ(job->input_seq[4], " e");
+    ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::OR);
+    ASSERT_EQ(job->operator_seq[1], jsh::job::OPERATOR::PIPE);
+    ASSERT_EQ(job->operator_seq[2], jsh::job::OPERATOR::SEQUENCE);
+    ASSERT_EQ(job->operator_seq[3], jsh::job::OPERATOR::AND);
+}
+
+TEST(TestJob, TestParseJobQuotedOperators) {
+    // operators inside of quotes or after a backslash are part of the word
+    auto job = jsh::job::parse_job("echo 'a || b' \"c | d\" e\\;f | cat");
+
+    ASSERT_TRUE(job->input_seq.size() == 2);
+    ASSERT_TRUE(job->operator_seq.size() == 1);
+    ASSERT_EQ(job->input_seq[0], "echo 'a || b' \"c | d\" e\\;f ");
+    ASSERT_EQ(job->input_seq[1], " cat");
+    ASSERT_EQ(job->operator_seq[0], jsh::job::OPERATOR::PIPE);
+
+    // the tokens of each stage are already unquoted
+    ASSERT_EQ(job->token_seq[0].size(), 4);
+    ASSERT_EQ(job->token_seq[0][1].value, "a || b");
+    ASSERT_EQ(job->token_seq[0][2].value, "c | d");
+    ASSERT_EQ(job->token_seq[0][3].value, "e;f");
+    ASSERT_FALSE(job->is_background);
+
+    // a quoted & at the end is not a trailing &
+    job = jsh::job::parse_job("echo '&'");
+    ASSERT_FALSE(job->is_background);
+    ASSERT_EQ(job->input_seq[0], "echo '&'");
+}
+
+TEST(TestJob, TestExecuteJobQuotedOperators) {
+    // Test Constants
+    static constexpr char const* FILE = "testing/tmp/file";
+    static constexpr char const* CMD = "echo 'a > b' \"c && d\" > testing/tmp/file";
+    static constexpr char const* CORR = "a > b c && d\n";
+
+    // parse and run the command
+    auto job = jsh::job::parse_job(CMD);
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+
+    std::ifstream file(FILE);
+    std::string const contents{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    ASSERT_EQ(contents, CORR);
+}
+
+TEST(TestJob, TestExecuteJobLocalVariables) {
+    // Test Constants
+    static constexpr char const* FILE = "testing/tmp/file";
+
+    // an assignment without export is only seen by the shell
+    auto job = jsh::job::parse_job("JSH_JOB_LOCAL=local; export JSH_JOB_EXPORTED=exported; env > testing/tmp/file");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_STREQ(jsh::environment::get_var("JSH_JOB_LOCAL"), "local");
+
+    std::ifstream file(FILE);
+    std::string const contents{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    ASSERT_NE(contents.find("JSH_JOB_EXPORTED=exported\n"), std::string::npos);
+    ASSERT_EQ(contents.find("JSH_JOB_LOCAL"), std::string::npos);
+    ASSERT_EQ(contents.find("?="), std::string::npos);
+}
+
+TEST(TestJob, TestExecuteJobPipestatus) {
+    // PIPESTATUS holds every stage of the last pipeline which ran, a stage killed by a signal reports 128 + the signal
+    auto job = jsh::job::parse_job("sh -c 'exit 2' | sh -c 'kill -9 $$' | sh -c 'exit 0' ; sh -c 'exit 1' && sh -c 'exit 3'");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(jsh::environment::get_status(), 1);
+    ASSERT_TRUE(std::ranges::equal(jsh::environment::get_pipestatus(), std::array{1}));
+
+    job = jsh::job::parse_job("sh -c 'exit 2' | sh -c 'kill -9 $$' | sh -c 'exit 0'");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(jsh::environment::get_status(), 0);
+    ASSERT_STREQ(jsh::environment::get_var("PIPESTATUS[@]"), "2 137 0");
+    ASSERT_STREQ(jsh::environment::get_var("PIPESTATUS[1]"), "137");
+    ASSERT_STREQ(jsh::environment::get_var("PIPESTATUS"), "2");
+
+    // a background job leaves PIPESTATUS alone
+    job = jsh::job::parse_job("sh -c 'exit 5' &");
+    jsh::job::execute_job(job);
+    jsh::job_entry const* entry = jsh::job_table::resolve("");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(jsh::job_table::wait_job(entry->id), 5);
+    ASSERT_STREQ(jsh::environment::get_var("PIPESTATUS[*]"), "2 137 0");
+}
+
+TEST(TestJob, TestExecuteJobControlFlow) {
+    // the && is skipped, the || runs since the status carries over, and ; always runs
+    auto job = jsh::job::parse_job("sh -c 'exit 2' && sh -c 'exit 3' || sh -c 'exit 4' ; sh -c 'exit 5' || sh -c 'exit 6'");
+    job->is_foreground = false;
+
+    // execute the job
+    jsh::job::execute_job(job);
+
+    // ensure the right pipelines ran
+    ASSERT_EQ(job->plan.size(), 5);
+    ASSERT_EQ(job->status_seq[0], 2);
+    ASSERT_EQ(job->status_seq[1], -1);
+    ASSERT_EQ(job->status_seq[2], 4);
+    ASSERT_EQ(job->status_seq[3], 5);
+    ASSERT_EQ(job->status_seq[4], 6);
+
+    // the status of the job is the status of the last pipeline that ran
+    ASSERT_EQ(job->status, 6);
+    ASSERT_EQ(jsh::environment::get_status(), 6);
+    ASSERT_STREQ(jsh::environment::get_var(jsh::environment::STATUS_STRING), "6");
+}
+
 TEST(TestJob, TestExecuteJobBasic1) {
     // Test Constants
     static constexpr char const* FILE = "testing/tmp/file";
@@ -501,3 +631,416 @@ TEST(TestJob, TestExitCodeEnvVarFail) {
     // get the $? env var
     ASSERT_STRNE(jsh::environment::get_var("?"), jsh::environment::SUCCESS_STRING);
 }
+
+TEST(TestJob, TestExecuteJobPipeLargerThanBuffer) {
+    // Test constants
+    static constexpr char const* FILE = "testing/tmp/file";
+    static constexpr char const* CMD = "head -c 1000000 /dev/zero | wc -c > testing/tmp/file";
+    static constexpr char const* CORR = "1000000\n";
+
+    // parse job, the producer writes far more than the pipe buffer so it would deadlock if the stages ran one after another
+    auto job = jsh::job::parse_job(CMD);
+
+    // not actually in the terminal so we use background processes
+    job->is_foreground = false;
+
+    // execute the job
+    jsh::job::execute_job(job);
+
+    // every stage should have reported a successful exit status
+    ASSERT_EQ(job->status_seq.size(), 2);
+    ASSERT_EQ(job->status_seq[0], 0);
+    ASSERT_EQ(job->status_seq[1], 0);
+
+    // open the file
+    static constexpr mode_t MODE = 0777;
+    std::optional<jsh::file_descriptor_wrapper> fides = jsh::syscall_wrapper::open_wrapper(FILE, O_RDONLY, MODE);
+
+    // check to see if open succeeded
+    ASSERT_TRUE(fides.has_value());
+
+    // read the file
+    std::array<char, 16> buf{};
+    std::optional<ssize_t> num_bytes_read = jsh::syscall_wrapper::read_wrapper(fides.value(), buf.data(), buf.size()); // NOLINT assert checks this .value()
+
+    // check for success
+    ASSERT_TRUE(num_bytes_read.has_value());
+    ASSERT_EQ(std::string(buf.data(), num_bytes_read.value()), CORR); // NOLINT assert checks this .value()
+}
+
+TEST(TestJob, TestParseJobBackground) {
+    // input
+    std::string const input = "echo hi | echo hi &  ";
+
+    auto job = jsh::job::parse_job(input);
+
+    // the trailing & is not part of the last process
+    ASSERT_TRUE(job->is_background);
+    ASSERT_FALSE(job->is_foreground);
+    ASSERT_TRUE(job->input_seq.size() == 2);
+    ASSERT_EQ(job->input_seq[1], " echo hi ");
+}
+
+TEST(TestJob, TestExecuteJobBackground) {
+    // parse job
+    auto job = jsh::job::parse_job("sh -c 'exit 3' &");
+    ASSERT_TRUE(job->is_background);
+
+    // execute the job, this should return without waiting on it, starting it sets $? to 0
+    jsh::environment::set_status(7); // NOLINT
+    jsh::job::execute_job(job);
+    ASSERT_EQ(jsh::environment::get_status(), EXIT_SUCCESS);
+
+    // the job should now be tracked by the job table
+    ASSERT_EQ(jsh::job_table::size(), 1);
+    jsh::job_entry const* entry = jsh::job_table::resolve("");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(jsh::job_table::find_by_pgid(entry->pgid), entry);
+
+    // $! is the pid of the last stage of the job
+    ASSERT_EQ(jsh::environment::get_background_pid(), entry->pids.back());
+    ASSERT_EQ(std::string_view(jsh::environment::get_var("!")), std::to_string(entry->pids.back()));
+
+    // waiting on the job gives back its exit status and stops tracking it
+    ASSERT_EQ(jsh::job_table::wait_job(entry->id), 3);
+    ASSERT_EQ(jsh::job_table::size(), 0);
+}
+
+TEST(TestJob, TestExecuteJobBackgroundCurrent) {
+    // the current job is the most recent one still in the table
+    std::vector<std::size_t> ids;
+    for (int status = 1; status <= 3; ++status) {
+        auto job = jsh::job::parse_job("sh -c 'exit " + std::to_string(status) + "' &");
+        jsh::job::execute_job(job);
+        jsh::job_entry const* entry = jsh::job_table::resolve("");
+        ASSERT_NE(entry, nullptr);
+        ids.push_back(entry->id);
+    }
+    ASSERT_EQ(jsh::job_table::size(), 3);
+
+    // waiting on the current job makes the one before it current
+    ASSERT_EQ(jsh::job_table::wait_job(ids[2]), 3);
+    ASSERT_EQ(jsh::job_table::resolve("")->id, ids[1]);
+    ASSERT_EQ(jsh::job_table::wait_job(ids[0]), 1);
+    ASSERT_EQ(jsh::job_table::resolve("")->id, ids[1]);
+    ASSERT_EQ(jsh::job_table::wait_job(ids[1]), 2);
+    ASSERT_EQ(jsh::job_table::resolve(""), nullptr);
+}
+
+TEST(TestJob, TestReapTrackedOnly) {
+    // a child the table does not track, such as a stage of a pipeline which is still starting
+    std::optional<pid_t> const pid = jsh::syscall_wrapper::fork_wrapper();
+    ASSERT_TRUE(pid.has_value());
+    if (pid.value() == 0) { // child
+        _exit(3);
+    }
+    siginfo_t info{};
+    ASSERT_EQ(waitid(P_PID, static_cast<id_t>(pid.value()), &info, WEXITED | WNOWAIT), 0);
+
+    // reaping the table leaves it for whoever waits on it
+    jsh::job_table::reap();
+    std::optional<int> const wait_status = jsh::process::wait_process(pid.value());
+    ASSERT_TRUE(wait_status.has_value());
+    ASSERT_EQ(jsh::process::exit_status(wait_status.value()), 3); // NOLINT assert catches this
+}
+
+TEST(TestJob, TestExecuteJobBackgroundSubshell) {
+    // parse job, more than one pipeline runs in a subshell
+    auto job = jsh::job::parse_job("sh -c 'exit 0' && sh -c 'exit 4' &");
+
+    // execute the job
+    jsh::environment::set_status(7); // NOLINT
+    jsh::job::execute_job(job);
+    ASSERT_EQ(jsh::environment::get_status(), EXIT_SUCCESS);
+
+    // the subshell is the only process of the job
+    ASSERT_EQ(jsh::job_table::size(), 1);
+    jsh::job_entry const* entry = jsh::job_table::resolve("");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(entry->pids.size(), 1);
+    ASSERT_EQ(jsh::environment::get_background_pid(), entry->pids.front());
+
+    // the subshell exits with the status of the job
+    ASSERT_EQ(jsh::job_table::wait_job(entry->id), 4);
+    ASSERT_EQ(jsh::job_table::size(), 0);
+}
+
+TEST(TestJob, TestParseJobTimeout) {
+    // parse job
+    auto job = jsh::job::parse_job("timeout=5 echo hi | cat");
+
+    // the prefix is not part of the first process
+    ASSERT_TRUE(job->timeout.has_value());
+    ASSERT_EQ(job->timeout.value(), std::chrono::seconds(5));
+    ASSERT_TRUE(job->input_seq.size() == 2);
+    ASSERT_EQ(job->input_seq[0], " echo hi ");
+}
+
+TEST(TestJob, TestExecuteJobTimeout) {
+    // parse job
+    auto job = jsh::job::parse_job("timeout=1 sleep 10 && echo never");
+
+    // the job should be killed once its deadline passes, and the rest of the job should not run
+    auto const start = std::chrono::steady_clock::now();
+    jsh::job::execute_job(job);
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    ASSERT_STREQ(jsh::environment::get_var(jsh::environment::STATUS_STRING), "124");
+    ASSERT_EQ(job->status_seq[1], -1);
+}
+
+TEST(TestJob, TestExecuteJobBackgroundTimeout) {
+    // parse job
+    auto job = jsh::job::parse_job("timeout=1 sleep 10 &");
+
+    // execute the job
+    jsh::job::execute_job(job);
+
+    // waiting on the job enforces its deadline
+    jsh::job_entry const* entry = jsh::job_table::resolve("");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(jsh::job_table::wait_job(entry->id), jsh::job::TIMEOUT_STATUS);
+    ASSERT_EQ(jsh::job_table::size(), 0);
+}
+
+TEST(TestJob, TestParseJobPipeSize) {
+    // parse job, annotations can be combined
+    auto job = jsh::job::parse_job("pipe_size=256K timeout=5 cat | cat");
+
+    // the annotations are not part of the first process
+    ASSERT_TRUE(job->pipe_sizing.has_value());
+    ASSERT_EQ(job->pipe_sizing->sizing, jsh::PIPE_SIZING::FIXED); // NOLINT assert catches this
+    ASSERT_EQ(job->pipe_sizing->size, std::min(256 * 1024, jsh::pipe_capacity::max_size())); // NOLINT assert catches this
+    ASSERT_TRUE(job->timeout.has_value());
+    ASSERT_EQ(job->input_seq[0], " cat ");
+
+    // an invalid size is left as part of the command
+    job = jsh::job::parse_job("pipe_size=huge cat");
+    ASSERT_FALSE(job->pipe_sizing.has_value());
+    ASSERT_EQ(job->input_seq[0], "pipe_size=huge cat");
+}
+
+TEST(TestJob, TestExecuteJobAdaptivePipe) {
+    // Test constants
+    static constexpr char const* READER = "testing/tmp/slow_reader";
+    static constexpr int DEFAULT_PIPE_SIZE = 64 * 1024;
+
+    // a reader which starts late, so the writer fills the pipe
+    std::ofstream(READER) << "#!/bin/sh\nsleep 0.2\ncat > /dev/null\n";
+    std::filesystem::permissions(READER, std::filesystem::perms::owner_all);
+
+    // run the pipeline with adaptive pipes
+    auto job = jsh::job::parse_job("pipe_size=adaptive head -c 4000000 /dev/zero | testing/tmp/slow_reader");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+
+    // the pipe should have been seen full and grown past the default
+    std::vector<jsh::pipe_stats> const& stats = jsh::pipe_capacity::stats();
+    ASSERT_EQ(stats.size(), 1);
+    ASSERT_GT(stats[0].full_samples, 0);
+    ASSERT_GT(stats[0].grows, 0);
+    ASSERT_GT(stats[0].capacity, DEFAULT_PIPE_SIZE);
+}
+
+TEST(TestJob, TestParseJobAffinity) {
+    // parse job, every stage gets its own list
+    auto job = jsh::job::parse_job("cpus=0-1,3:2 cat | cat");
+    ASSERT_TRUE(job->affinity.has_value());
+    ASSERT_EQ(job->affinity->mode, jsh::AFFINITY_MODE::FIXED);  // NOLINT assert catches this
+    ASSERT_EQ(job->affinity->stage_sets.size(), 2);             // NOLINT assert catches this
+    ASSERT_EQ(CPU_COUNT(&job->affinity->stage_sets[0]), 3);     // NOLINT assert catches this
+    ASSERT_TRUE(CPU_ISSET(2, &job->affinity->stage_sets[1]));   // NOLINT assert catches this
+    ASSERT_EQ(job->input_seq[0], " cat ");
+
+    // the stages past the last list reuse it
+    auto placement = jsh::cpu_affinity::place(job->affinity.value(), 3); // NOLINT assert catches this
+    ASSERT_TRUE(placement[2].has_value());
+    ASSERT_TRUE(CPU_ISSET(2, &placement[2].value())); // NOLINT assert catches this
+
+    // automatic placement pins every stage to a single CPU the shell may use
+    job = jsh::job::parse_job("cpus=auto cat | cat");
+    ASSERT_TRUE(job->affinity.has_value());
+    placement = jsh::cpu_affinity::place(job->affinity.value(), 2); // NOLINT assert catches this
+    auto const allowed = jsh::syscall_wrapper::sched_getaffinity_wrapper(0);
+    ASSERT_TRUE(allowed.has_value());
+    for (auto const& set : placement) {
+        ASSERT_TRUE(set.has_value());
+        ASSERT_EQ(CPU_COUNT(&set.value()), 1); // NOLINT assert catches this
+        cpu_set_t both;
+        CPU_AND(&both, &set.value(), &allowed.value()); // NOLINT assert catches this
+        ASSERT_EQ(CPU_COUNT(&both), 1);
+    }
+
+    // an invalid list is left as part of the command
+    job = jsh::job::parse_job("cpus=3-1 cat");
+    ASSERT_FALSE(job->affinity.has_value());
+    ASSERT_EQ(job->input_seq[0], "cpus=3-1 cat");
+}
+
+TEST(TestJob, TestExecuteJobAffinity) {
+    // Test constants
+    static constexpr char const* FILE = "testing/tmp/file";
+
+    // the child applies its mask before exec, so the binary sees it in its own status
+    auto job = jsh::job::parse_job("cpus=0 grep Cpus_allowed_list /proc/self/status > testing/tmp/file");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+
+    std::ifstream stream(FILE);
+    std::string line;
+    std::getline(stream, line);
+    ASSERT_TRUE(line.ends_with("\t0"));
+}
+
+TEST(TestJob, TestParseJobCgroupLimits) {
+    // parse job, the limits are converted to the format the kernel expects
+    auto job = jsh::job::parse_job("memory_max=512M cpu_max=50000 cat");
+    ASSERT_EQ(job->limits.memory_max, "512M");
+    ASSERT_EQ(job->limits.cpu_max, "50000 100000");
+    ASSERT_EQ(job->input_seq[0], " cat");
+
+    // an invalid limit is left as part of the command
+    job = jsh::job::parse_job("cpu_max=half cat");
+    ASSERT_FALSE(job->limits.cpu_max.has_value());
+    ASSERT_EQ(job->input_seq[0], "cpu_max=half cat");
+}
+
+TEST(TestJob, TestExecuteJobCgroup) {
+    // find a writable cgroup v2 hierarchy, either unified or hybrid
+    std::string root;
+    for (char const* mount : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}) {
+        if (std::filesystem::exists(std::string(mount) + "/cgroup.procs") && std::filesystem::exists(std::string(mount) + "/cgroup.subtree_control")) {
+            root = std::string(mount) + "/jsh-test";
+            break;
+        }
+    }
+    std::error_code err;
+    if (root.empty() || (!std::filesystem::exists(root) && !std::filesystem::create_directory(root, err))) {
+        GTEST_SKIP() << "no delegated cgroup v2 directory";
+    }
+
+    // the whole pipeline is accounted to one leaf
+    jsh::environment::set_var(jsh::job_cgroup::CGROUP_ROOT_VAR, root.c_str());
+    auto job = jsh::job::parse_job("head -c 50000000 /dev/zero | cat > /dev/null");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+    ASSERT_TRUE(jsh::job_cgroup::last().has_value());
+    ASSERT_GT(jsh::job_cgroup::last()->usage_usec, 0); // NOLINT assert catches this
+
+    // the leaf is removed once the job is over
+    ASSERT_TRUE(std::ranges::none_of(std::filesystem::directory_iterator(root), [](auto const& entry) { return entry.path().filename().string().starts_with("jsh-"); }));
+
+    // clean up
+    jsh::environment::set_var(jsh::job_cgroup::CGROUP_ROOT_VAR, "");
+    std::filesystem::remove(root, err);
+}
+
+TEST(TestJob, TestParseJobTime) {
+    // parse job, the keyword takes the format from JSH_TIME_FORMAT
+    auto job = jsh::job::parse_job("time cat | cat");
+    ASSERT_EQ(job->time_format, jsh::TIME_FORMAT::HUMAN);
+    ASSERT_EQ(job->input_seq[0], " cat ");
+
+    // the format can be given with the keyword
+    job = jsh::job::parse_job("time=json cat");
+    ASSERT_EQ(job->time_format, jsh::TIME_FORMAT::JSON);
+
+    // an unknown format is left as part of the command
+    job = jsh::job::parse_job("time=xml cat");
+    ASSERT_FALSE(job->time_format.has_value());
+    ASSERT_EQ(job->input_seq[0], "time=xml cat");
+}
+
+TEST(TestJob, TestExecuteJobTime) {
+    // every stage reports its own rusage
+    auto job = jsh::job::parse_job("time=json head -c 50000000 /dev/zero | cat > /dev/null");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+    ASSERT_EQ(job->stage_usages.size(), 2);
+    ASSERT_EQ(job->stage_usages[0].command, "head -c 50000000 /dev/zero");
+    ASSERT_EQ(job->stage_usages[1].stage, 1);
+    ASSERT_GT(job->stage_usages[1].pid, 0);
+
+    // moving that much data costs CPU time somewhere
+    rusage const total = jsh::job_time::total(job->stage_usages);
+    ASSERT_GT(total.ru_utime.tv_sec + total.ru_utime.tv_usec + total.ru_stime.tv_sec + total.ru_stime.tv_usec, 0);
+
+    // the machine readable report is a single JSON object
+    std::ostringstream stream;
+    jsh::logger log(stream);
+    jsh::job_time::report("a \"quoted\" job", std::chrono::milliseconds(1), EXIT_SUCCESS, job->stage_usages, jsh::TIME_FORMAT::JSON, log);
+    ASSERT_TRUE(stream.str().starts_with(R"({"command":"a \"quoted\" job","status":0,"real_usec":1000,)"));
+    ASSERT_TRUE(stream.str().ends_with("}]}\n"));
+}
+
+TEST(TestJob, TestParseJobPerfstat) {
+    // parse job, the keyword can be combined with other annotations
+    auto job = jsh::job::parse_job("perfstat time cat | cat");
+    ASSERT_TRUE(job->perfstat);
+    ASSERT_TRUE(job->time_format.has_value());
+    ASSERT_EQ(job->input_seq[0], " cat ");
+
+    // a command which only starts with the keyword is left alone
+    job = jsh::job::parse_job("perfstats cat");
+    ASSERT_FALSE(job->perfstat);
+}
+
+TEST(TestJob, TestExecuteJobPerfstat) {
+    // every forked stage, builtins included, gets its own counters
+    auto job = jsh::job::parse_job("perfstat head -c 50000000 /dev/zero | echo hi | cat > /dev/null");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+    ASSERT_EQ(job->counters.size(), 3);
+    ASSERT_EQ(job->counters[0].command, "head -c 50000000 /dev/zero");
+
+    // the counters are closed once they are read
+    for (jsh::stage_counters const& stage : job->counters) {
+        for (auto const& fides : stage.fds) {
+            ASSERT_FALSE(fides.has_value());
+        }
+    }
+
+    // the task clock is a software event, so it is only missing if perf_event_open is not allowed at all
+    std::optional<std::uint64_t> const& task_clock = job->counters[0].values[static_cast<std::size_t>(jsh::PERF_COUNTER::TASK_CLOCK)];
+    if (!task_clock.has_value()) {
+        GTEST_SKIP() << "perf_event_open is not available";
+    }
+    ASSERT_GT(task_clock.value(), 0);
+
+    // unsupported counters are reported as -
+    std::ostringstream stream;
+    jsh::logger log(stream);
+    jsh::perf_counters::report(job->counters, log);
+    ASSERT_NE(stream.str().find("task_clock_ms"), std::string::npos);
+    ASSERT_NE(stream.str().find("\ntotal\t"), std::string::npos);
+}
+
+TEST(TestJob, TestExecuteJobUringRedirection) {
+    // every stage's files are opened together before any of them run
+    jsh::environment::set_var(jsh::process::IO_BACKEND_VAR, "uring");
+    auto job = jsh::job::parse_job("echo uring > testing/tmp/uring_a > testing/tmp/uring_b | cat < testing/tmp/uring_b > testing/tmp/uring_c");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+
+    // the files are opened in order, so the second stage finds the file the first one created, the pipe still takes over both of them
+    std::ifstream file_b("testing/tmp/uring_b");
+    std::ifstream file_c("testing/tmp/uring_c");
+    std::string line;
+    ASSERT_TRUE(file_b.is_open());
+    ASSERT_FALSE(std::getline(file_b, line));
+    ASSERT_TRUE(std::getline(file_c, line));
+    ASSERT_EQ(line, "uring");
+
+    // a file which can not be opened stops the whole job, and the files after it are never created
+    job = jsh::job::parse_job("cat < testing/tmp/uring_missing | echo never > testing/tmp/uring_d");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_TRUE(job->status_seq.empty());
+    ASSERT_FALSE(std::filesystem::exists("testing/tmp/uring_d"));
+    jsh::environment::set_var(jsh::process::IO_BACKEND_VAR, "");
+}
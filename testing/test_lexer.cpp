@@ -0,0 +1,65 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// JSH
+#include <lexer.hpp>
+
+namespace {
+/**
+ * kinds: the kind of every token of a stream
+ */
+auto kinds(jsh::token_stream const& stream) -> std::vector<jsh::TOKEN_KIND> {
+    std::vector<jsh::TOKEN_KIND> result;
+    for (jsh::token const& tok : stream.tokens) {
+        result.push_back(tok.kind);
+    }
+    return result;
+}
+} // namespace
+
+TEST(TestLexer, TestOperators) {
+    using jsh::TOKEN_KIND;
+    std::string const line = "a||b|c&&d;e&f<g>h";
+    jsh::token_stream const stream = jsh::lexer::lex(line);
+
+    ASSERT_FALSE(stream.error);
+    ASSERT_EQ(kinds(stream), (std::vector<TOKEN_KIND>{TOKEN_KIND::WORD, TOKEN_KIND::OR, TOKEN_KIND::WORD, TOKEN_KIND::PIPE, TOKEN_KIND::WORD, TOKEN_KIND::AND, TOKEN_KIND::WORD, TOKEN_KIND::SEQUENCE, TOKEN_KIND::WORD, TOKEN_KIND::BACKGROUND, TOKEN_KIND::WORD, TOKEN_KIND::INPUT_REDIRECTION, TOKEN_KIND::WORD, TOKEN_KIND::OUTPUT_REDIRECTION, TOKEN_KIND::WORD}));
+    ASSERT_EQ(stream.tokens[1].text, "||");
+    ASSERT_EQ(stream.tokens[14].value, "h");
+
+    // three pipes are an || and a |
+    ASSERT_EQ(kinds(jsh::lexer::lex("|||")), (std::vector<TOKEN_KIND>{TOKEN_KIND::OR, TOKEN_KIND::PIPE}));
+    ASSERT_TRUE(jsh::lexer::lex(" \t ").tokens.empty());
+}
+
+TEST(TestLexer, TestQuotes) {
+    std::string const line = R"(echo 'a | b' "c > d" e\ f 'g'"h"i "" plain)";
+    jsh::token_stream const stream = jsh::lexer::lex(line);
+
+    ASSERT_FALSE(stream.error);
+    ASSERT_EQ(stream.tokens.size(), 7);
+    for (jsh::token const& tok : stream.tokens) {
+        ASSERT_EQ(tok.kind, jsh::TOKEN_KIND::WORD);
+    }
+    ASSERT_EQ(stream.tokens[1].text, "'a | b'");
+    ASSERT_EQ(stream.tokens[1].value, "a | b");
+    ASSERT_EQ(stream.tokens[2].value, "c > d");
+    ASSERT_EQ(stream.tokens[3].value, "e f");
+    ASSERT_EQ(stream.tokens[4].value, "ghi");
+    ASSERT_EQ(stream.tokens[5].value, "");
+
+    // words without quotes are views into the line rather than copies
+    ASSERT_EQ(stream.tokens[0].value.data(), line.data());
+    ASSERT_EQ(stream.tokens[6].value.data(), stream.tokens[6].text.data());
+
+    // a backslash escapes inside of quotes too
+    ASSERT_EQ(jsh::lexer::lex(R"("a\"b" 'c\'d')").tokens[1].value, "c'd");
+    ASSERT_EQ(jsh::lexer::lex(R"("a\"b")").tokens[0].value, "a\"b");
+}
+
+TEST(TestLexer, TestErrors) {
+    ASSERT_TRUE(jsh::lexer::lex("echo 'a").error);
+    ASSERT_TRUE(jsh::lexer::lex("echo \"a | b").error);
+    ASSERT_TRUE(jsh::lexer::lex("echo a\\").error);
+    ASSERT_FALSE(jsh::lexer::lex("echo a\\\\").error);
+}
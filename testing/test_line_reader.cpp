@@ -0,0 +1,88 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// STL
+#include <fstream>
+
+// JSH
+#include <line_editor.hpp>
+#include <line_reader.hpp>
+#include <shell.hpp>
+
+TEST(TestLineReader, TestString) {
+    jsh::line_reader reader = jsh::line_reader::from_string("first\n\nsecond\nlast");
+    ASSERT_TRUE(reader.buffered());
+    ASSERT_EQ(reader.next_line(), "first");
+    ASSERT_EQ(reader.next_line(), "");
+    ASSERT_EQ(reader.next_line(), "second");
+
+    // the last line does not need a newline
+    ASSERT_FALSE(reader.buffered());
+    ASSERT_EQ(reader.next_line(), "last");
+    ASSERT_FALSE(reader.next_line().has_value());
+}
+
+TEST(TestLineReader, TestFile) {
+    // lines longer than a chunk are put back together
+    std::string const long_line(200000, 'x');
+    {
+        std::ofstream script("testing/tmp/script");
+        script << long_line << '\n';
+        for (int i = 0; i < 10000; ++i) {
+            script << i << '\n';
+        }
+    }
+
+    std::optional<jsh::line_reader> reader = jsh::line_reader::from_file("testing/tmp/script");
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->next_line(), long_line); // NOLINT assert catches this
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(reader->next_line(), std::to_string(i)); // NOLINT assert catches this
+    }
+    ASSERT_FALSE(reader->next_line().has_value()); // NOLINT assert catches this
+
+    ASSERT_FALSE(jsh::line_reader::from_file("testing/tmp/missing_script").has_value());
+}
+
+TEST(TestLineReader, TestRunScript) {
+    // the status of the last job is the status of the script, comments are skipped
+    jsh::line_reader reader = jsh::line_reader::from_string("#!/usr/bin/env jsh\ntrue\n  # false\ntrue && false");
+    ASSERT_EQ(jsh::shell::run_script(reader), EXIT_FAILURE);
+
+    // nothing after exit runs
+    reader = jsh::line_reader::from_string("true\nexit\nfalse\n");
+    ASSERT_EQ(jsh::shell::run_script(reader), EXIT_SUCCESS);
+
+    // a background job which finished leaves the table between lines
+    reader = jsh::line_reader::from_string("sh -c 'exit 0' &\nsleep 0.2\ntrue\n");
+    ASSERT_EQ(jsh::shell::run_script(reader), EXIT_SUCCESS);
+    ASSERT_EQ(jsh::job_table::size(), 0);
+}
+
+TEST(TestLineReader, TestLineEditor) {
+    jsh::line_editor editor;
+    std::string echo;
+
+    // a paste arrives in one piece and queues every line it completes, arrow keys are dropped
+    editor.feed("echo one\r\necho two\nech\x7fho t\x1b[Dhr\x1b[1;5Cee\necho fo", echo);
+    ASSERT_EQ(echo, "echo one\necho two\nech\b \bho three\necho fo");
+    ASSERT_TRUE(editor.buffered());
+    ASSERT_EQ(editor.next_line(), "echo one");
+    ASSERT_EQ(editor.next_line(), "echo two");
+    ASSERT_EQ(editor.next_line(), "echo three");
+    ASSERT_FALSE(editor.buffered());
+    ASSERT_FALSE(editor.next_line().has_value());
+
+    // the line being typed carries over to the next read, a multibyte character is erased whole
+    echo.clear();
+    editor.feed("ur \xc3\xa9\x7f\n", echo);
+    ASSERT_EQ(echo, "ur \xc3\xa9\b \b\n");
+    ASSERT_EQ(editor.next_line(), "echo four ");
+
+    // ctrl+d only ends the input on an empty line
+    editor.feed("abc\x04", echo);
+    ASSERT_FALSE(editor.is_closed());
+    editor.feed("\x15\x04", echo);
+    ASSERT_TRUE(editor.is_closed());
+    ASSERT_FALSE(editor.buffered());
+}
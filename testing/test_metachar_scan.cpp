@@ -0,0 +1,84 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// STL
+#include <random>
+
+// JSH
+#include <job.hpp>
+#include <lexer.hpp>
+#include <metachar_scan.hpp>
+#include <parsing.hpp>
+
+namespace {
+/**
+ * KERNELS: every kernel, the ones the CPU cannot run are skipped
+ */
+constexpr std::array<jsh::metachar_scan::KERNEL, 3> KERNELS = {jsh::metachar_scan::KERNEL::SCALAR, jsh::metachar_scan::KERNEL::SSE2, jsh::metachar_scan::KERNEL::AVX2};
+} // namespace
+
+TEST(TestMetacharScan, TestKernelsAgree) {
+    static constexpr jsh::metachar_set SET{"|&;<>'\"\\ "};
+    static constexpr std::size_t LENGTH = 4096;
+    static constexpr std::size_t SPARSITY = 97;
+
+    // mostly ordinary characters with a metacharacter now and then, including at block boundaries and the tail
+    std::mt19937 gen(0); // NOLINT a fixed seed keeps the test repeatable
+    std::string text(LENGTH, 'a');
+    for (char& chr : text) {
+        if (gen() % SPARSITY == 0) {
+            chr = SET.chars[gen() % SET.size]; // NOLINT size is at most MAX_CHARS
+        } else {
+            chr = static_cast<char>('a' + gen() % 26);
+        }
+    }
+    text[31] = '|';
+    text[32] = '&';
+    text.back() = ';';
+
+    for (jsh::metachar_scan::KERNEL const kernel : KERNELS) {
+        if (!jsh::metachar_scan::supported(kernel)) {
+            continue;
+        }
+
+        // every starting point finds the same metacharacter as the scalar kernel
+        for (std::size_t pos = 0; pos <= text.size(); ++pos) {
+            std::size_t const expected = jsh::metachar_scan::scan(jsh::metachar_scan::KERNEL::SCALAR, text, pos, SET);
+            ASSERT_EQ(jsh::metachar_scan::scan(kernel, text, pos, SET), expected) << jsh::metachar_scan::KERNEL_STR[static_cast<std::size_t>(kernel)] << " at " << pos;
+        }
+
+        // nothing to find runs to the end of the text
+        ASSERT_EQ(jsh::metachar_scan::scan(kernel, std::string(LENGTH + 3, 'x'), 0, SET), LENGTH + 3);
+        ASSERT_EQ(jsh::metachar_scan::scan(kernel, "", 0, SET), 0);
+    }
+
+    // the scalar kernel always runs, the one picked for the CPU is one of them
+    ASSERT_TRUE(jsh::metachar_scan::supported(jsh::metachar_scan::KERNEL::SCALAR));
+    ASSERT_TRUE(jsh::metachar_scan::supported(jsh::metachar_scan::kernel()));
+}
+
+TEST(TestMetacharScan, TestParsingWithEachKernel) {
+    // a generated command line with a long argument list
+    static constexpr int NUM_ARGS = 20000;
+    std::string line = "echo";
+    for (int i = 0; i < NUM_ARGS; ++i) {
+        line += i % 100 == 0 ? " 'quoted | arg " + std::to_string(i) + "'" : " argument_" + std::to_string(i);
+    }
+    line += " | cat && echo ${HOME}done";
+
+    jsh::metachar_scan::KERNEL const original = jsh::metachar_scan::kernel();
+    for (jsh::metachar_scan::KERNEL const kernel : KERNELS) {
+        if (!jsh::metachar_scan::set_kernel(kernel)) {
+            continue;
+        }
+
+        auto job = jsh::job::parse_job(line);
+        ASSERT_EQ(job->operator_seq, (std::vector<jsh::job::OPERATOR>{jsh::job::OPERATOR::PIPE, jsh::job::OPERATOR::AND}));
+        ASSERT_EQ(job->token_seq[0].size(), NUM_ARGS + 1);
+        ASSERT_EQ(job->token_seq[0][1].value, "quoted | arg 0");
+        ASSERT_EQ(job->token_seq[0][NUM_ARGS].value, "argument_" + std::to_string(NUM_ARGS - 1));
+
+        ASSERT_EQ(jsh::parsing::variable_substitution("a ${HOME} b $ c ${HOME"), std::string("a ") + jsh::environment::get_var("HOME") + " b $ c ${HOME");
+    }
+    ASSERT_TRUE(jsh::metachar_scan::set_kernel(original));
+}
@@ -3,6 +3,8 @@
 
 // JSH
 #include <parsing.hpp>
+#include <posix_wrappers.hpp>
+#include <process.hpp>
 
 TEST(TestParsing, TestPeekValid) {
     // create a string to call peek on
@@ -67,29 +69,59 @@ TEST(TestParsing, TestEnvironmentVariableSubstitutions) {
     jsh::environment::set_var("var", "val");
     jsh::environment::set_var("var2", "${var}");
 
-    // end substitution
-    ASSERT_TRUE(jsh::parsing::variable_substitution("abc${var2}") == "abcval");
+    // values are not substituted a second time
+    ASSERT_EQ(jsh::parsing::variable_substitution("abc${var2}"), "abc${var}");
+    ASSERT_EQ(jsh::parsing::variable_substitution("${var2}abc"), "${var}abc");
+    ASSERT_EQ(jsh::parsing::variable_substitution("ab$var2 c"), "ab${var} c");
 
-    // beginning substitution
-    ASSERT_TRUE(jsh::parsing::variable_substitution("${var2}abc") == "valabc");
+    // no substitution
+    ASSERT_EQ(jsh::parsing::variable_substitution("abc"), "abc");
+}
 
-    // middle substitution
-    ASSERT_TRUE(jsh::parsing::variable_substitution("ab${var2}c") == "abvalc");
+TEST(TestParsing, TestSubstitutionNoBraces) {
+    // set the environment variable
+    jsh::environment::set_var("var", "val");
+    jsh::environment::set_var("_v1", "one");
 
-    // just substitution
-    ASSERT_TRUE(jsh::parsing::variable_substitution("${var2}") == "val");
+    // the name runs until a character which cannot be part of one
+    ASSERT_EQ(jsh::parsing::variable_substitution("$var"), "val");
+    ASSERT_EQ(jsh::parsing::variable_substitution("a $var/b"), "a val/b");
+    ASSERT_EQ(jsh::parsing::variable_substitution("$_v1$var"), "oneval");
+    ASSERT_EQ(jsh::parsing::variable_substitution("$variable"), "");
 
-    // no substitution
-    ASSERT_TRUE(jsh::parsing::variable_substitution("abc") == "abc");
+    // a $ before anything other than a name or a { is kept
+    ASSERT_EQ(jsh::parsing::variable_substitution("$ $1 $- a$"), "$ $1 $- a$");
 }
 
-TEST(TestParsing, TestMaxSubstitutions) {
+TEST(TestParsing, TestSelfReferentialSubstitutions) {
     // set the environment variable
     jsh::environment::set_var("var", "${var2}");
     jsh::environment::set_var("var2", "${var}");
 
-    // infinite looping
-    ASSERT_TRUE(jsh::parsing::variable_substitution("abc${var2}") == "abc${var2}");
+    // variables which refer to each other are substituted once rather than looping
+    ASSERT_EQ(jsh::parsing::variable_substitution("abc${var2}"), "abc${var}");
+}
+
+TEST(TestParsing, TestManySubstitutions) {
+    // set the environment variable
+    jsh::environment::set_var("var", "val");
+
+    // a line with 100000 substitutions is linear in its length
+    static constexpr std::size_t NUM_SUBSTITUTIONS = 100000;
+    std::string input;
+    std::string expected;
+    for (std::size_t i = 0; i < NUM_SUBSTITUTIONS; ++i) {
+        input += i % 2 == 0 ? " ${var}" : " $var";
+        expected += " val";
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+    std::string const output = jsh::parsing::variable_substitution(input);
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    // milliseconds even without optimizations, rebuilding the line for every substitution took minutes
+    ASSERT_EQ(output, expected);
+    ASSERT_LT(elapsed, std::chrono::seconds(1));
 }
 
 TEST(TestParsing, TestMalformed) {
@@ -97,20 +129,59 @@ TEST(TestParsing, TestMalformed) {
     jsh::environment::set_var("var", "val");
 
     // test extra characters one
-    ASSERT_EQ(jsh::parsing::variable_substitution("${NOT SET}a$bc${var}"), "a$bcval");
+    ASSERT_EQ(jsh::parsing::variable_substitution("${NOT SET}a$-bc${var}"), "a$-bcval");
 
-    // test extra characters two
-    ASSERT_EQ(jsh::parsing::variable_substitution("${NOT SET}a$${var}"), "a$val");
+    // test extra characters two, $$ is the pid of the shell
+    jsh::environment::record_shell_pid();
+    ASSERT_EQ(jsh::parsing::variable_substitution("${NOT SET}a$${var}"), "a" + std::to_string(getpid()) + "{var}");
 
     // test extra characters three
     ASSERT_EQ(jsh::parsing::variable_substitution("${NOT SET}a${${var}"), "a");
 
     // test extra characters four
-    ASSERT_EQ(jsh::parsing::variable_substitution("${NOT SET}a$a{${var}"), "a$a{val");
+    ASSERT_EQ(jsh::parsing::variable_substitution("${NOT SET}a$-a{${var}"), "a$-a{val");
 
     // test extra characters five
     ASSERT_EQ(jsh::parsing::variable_substitution("${val"), "${val");
 
     // test extra characters six
     ASSERT_EQ(jsh::parsing::variable_substitution("${var}${var"), "val${var");
+
+    // a name with an = in it is never set
+    ASSERT_EQ(jsh::parsing::variable_substitution("${a=b}c"), "c");
+}
+
+TEST(TestParsing, TestSpecialParameters) {
+    // a forked child reads the shell's pid even if it is the first to read $$
+    jsh::environment::record_shell_pid();
+    std::optional<pid_t> const pid = jsh::syscall_wrapper::fork_wrapper();
+    ASSERT_TRUE(pid.has_value());
+    if (pid.value() == 0) { // child
+        _exit(jsh::parsing::variable_substitution("$$") == std::to_string(getppid()) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    std::optional<int> const wait_status = jsh::process::wait_process(pid.value());
+    ASSERT_TRUE(wait_status.has_value());
+    ASSERT_EQ(jsh::process::exit_status(wait_status.value()), EXIT_SUCCESS); // NOLINT assert catches this
+
+    // $?, $$ and $! need no braces, and are formatted from the integers the shell keeps
+    jsh::environment::set_status(7); // NOLINT
+    jsh::environment::set_background_pid(1234); // NOLINT
+    ASSERT_EQ(jsh::parsing::variable_substitution("$?${?}"), "77");
+    ASSERT_EQ(jsh::parsing::variable_substitution("$$"), std::to_string(getpid()));
+    ASSERT_EQ(jsh::parsing::variable_substitution("$!x"), "1234x");
+
+    // PIPESTATUS is its first stage, [@] and [*] are every stage, and an index past the end is empty
+    std::array const statuses{0, 1, 130};
+    jsh::environment::set_pipestatus(statuses);
+    ASSERT_EQ(jsh::parsing::variable_substitution("${PIPESTATUS[@]}|${PIPESTATUS[*]}|$PIPESTATUS|${PIPESTATUS[2]}|${PIPESTATUS[3]}|${PIPESTATUS[x]}"), "0 1 130|0 1 130|0|130||");
+
+    // a shorter pipeline reuses the buffers
+    std::array const shorter{3};
+    jsh::environment::set_pipestatus(shorter);
+    ASSERT_EQ(jsh::parsing::variable_substitution("${PIPESTATUS[@]} ${PIPESTATUS[1]}"), "3 ");
+
+    // none of them are variables
+    ASSERT_FALSE(jsh::environment::is_exported("$"));
+    ASSERT_FALSE(jsh::environment::is_exported("PIPESTATUS"));
+    jsh::environment::set_status(EXIT_SUCCESS);
 }
@@ -162,6 +162,57 @@ TEST(TestProcess, TestExecuteBinary) {
     ASSERT_EQ(data[1], 'i');
 }
 
+TEST(TestProcess, TestExecuteBinarySpawn) {
+    // launch through posix_spawn instead of fork
+    jsh::environment::set_var("JSH_LAUNCH_BACKEND", "spawn");
+
+    // make a fifo to store the output from standard out
+    std::optional<std::vector<jsh::file_descriptor_wrapper>> pipe_fds_op = jsh::syscall_wrapper::pipe_wrapper();
+    ASSERT_TRUE(pipe_fds_op.has_value());
+    ASSERT_TRUE(pipe_fds_op.value().size() == 2); // NOLINT assert catches this .value()
+
+    std::vector<jsh::file_descriptor_wrapper> pipe_fds = std::move(pipe_fds_op.value()); // NOLINT assert catches this .value()
+
+    // create the command for the binary data
+    std::unique_ptr<jsh::process_data> binary_var = std::make_unique<jsh::process_data>(jsh::binary_data{});
+
+    auto& binary = std::get<jsh::binary_data>(*binary_var);
+    binary.pgid = std::make_shared<pid_t>(-1);
+    binary.is_foreground = false;
+
+    binary.args = {"echo", "hi"};
+
+    // direct the stdout to be the fifo
+    binary.stdout = std::move(pipe_fds[1]);
+
+    // run the binary
+    jsh::process::execute(binary_var);
+
+    // go back to the default backend for the rest of the tests
+    jsh::environment::set_var("JSH_LAUNCH_BACKEND", "fork");
+
+    // the spawned child should have been the leader of its own process group
+    ASSERT_NE(*binary.pgid, -1);
+
+    // read the contents of the pipe
+    std::array<char, 2> data{};
+    int total_read = 0;
+    while (total_read != sizeof(data)) {
+        std::optional<ssize_t> rea = jsh::syscall_wrapper::read_wrapper(pipe_fds[0], data.data() + total_read, sizeof(data) - total_read);
+
+        // read should've succeeded
+        ASSERT_TRUE(rea.has_value());
+
+        // add the number of bytes read
+        total_read += static_cast<int>(rea.value()); // NOLINT assert catches this .value()
+    }
+
+    // the pipe and buffer should now contain hi
+    ASSERT_EQ(data[0], 'h');
+    ASSERT_EQ(data[1], 'i');
+    ASSERT_STREQ(jsh::environment::get_var("?"), "0");
+}
+
 TEST(TestProcess, TestExecuteExport) {
     // create the export data structure
     std::unique_ptr<jsh::process_data> export_var = std::make_unique<jsh::process_data>(jsh::export_data{});
@@ -205,10 +256,10 @@ TEST(TestProcess, TestInputRedirectionParsingBasic2) {
     ASSERT_TRUE(proc_data.has_value());
 
     // make sure it contains binary data
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
 
     // get reference to underlying data
-    auto& data = std::get<jsh::binary_data>(*proc_data.value()); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value()); // NOLINT assert catches this .value()
     ASSERT_NE(data.stdin, jsh::syscall_wrapper::stdin_file_descriptor);
 }
 
@@ -221,10 +272,10 @@ TEST(TestProcess, TestInputRedirectionParsingBasic3) {
     ASSERT_TRUE(proc_data.has_value());
 
     // make sure it contains binary data
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
 
     // get reference to underlying data
-    auto& data = std::get<jsh::binary_data>(*proc_data.value()); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value()); // NOLINT assert catches this .value()
     ASSERT_NE(data.stdin, jsh::syscall_wrapper::stdin_file_descriptor);
 }
 
@@ -280,10 +331,10 @@ TEST(TestProcess, TestOutputRedirectionParsingBasic2) {
     ASSERT_TRUE(proc_data.has_value());
 
     // make sure it contains binary data
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
 
     // get reference to underlying data
-    auto& data = std::get<jsh::binary_data>(*proc_data.value()); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value()); // NOLINT assert catches this .value()
     ASSERT_NE(data.stdout, jsh::syscall_wrapper::stdout_file_descriptor);
 }
 
@@ -296,10 +347,10 @@ TEST(TestProcess, TestOutputRedirectionParsingBasic3) {
     ASSERT_TRUE(proc_data.has_value());
 
     // make sure it contains binary data
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
 
     // get reference to underlying data
-    auto& data = std::get<jsh::binary_data>(*proc_data.value()); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value()); // NOLINT assert catches this .value()
     ASSERT_NE(data.stdout, jsh::syscall_wrapper::stdout_file_descriptor);
 }
 
@@ -329,8 +380,8 @@ TEST(TestProcess, TestPosixNestedQuotes1) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -346,8 +397,8 @@ TEST(TestProcess, TestPosixNestedQuotes2) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -363,8 +414,8 @@ TEST(TestProcess, TestPosixNestedQuotes3) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -380,8 +431,8 @@ TEST(TestProcess, TestPosixAdjacentQuotes1) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -397,8 +448,8 @@ TEST(TestProcess, TestPosixAdjacentQuotes2) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -414,8 +465,8 @@ TEST(TestProcess, TestPosixNestedQuotesAndFilenames1) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -431,8 +482,8 @@ TEST(TestProcess, TestPosixNestedQuotesAndFilenames2) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -448,8 +499,8 @@ TEST(TestProcess, TestPosixNestedQuotesAndFilenames3) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -465,8 +516,8 @@ TEST(TestProcess, TestPosixNestedQuotesAndFilenames4) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -500,8 +551,8 @@ TEST(TestProcess, TestPosixNestedQuotesEscape1) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -534,8 +585,8 @@ TEST(TestProcess, TestPosixNestedQuotesEscape3) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -551,8 +602,8 @@ TEST(TestProcess, TestPosixNestedQuotesAndFilenamesEsacpe1) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
@@ -568,11 +619,55 @@ TEST(TestProcess, TestPosixNestedQuotesAndFilenamesEscape2) {
 
     // make sure the command was invalid
     ASSERT_TRUE(proc_data.has_value());
-    ASSERT_TRUE(std::holds_alternative<jsh::binary_data>(*proc_data.value())); // NOLINT assert catches this .value()
-    auto& data = std::get<jsh::binary_data>(*proc_data.value());               // NOLINT assert catches this .value()
+    ASSERT_TRUE(std::holds_alternative<jsh::builtin_data>(*proc_data.value())); // NOLINT assert catches this .value()
+    auto& data = std::get<jsh::builtin_data>(*proc_data.value());               // NOLINT assert catches this .value()
 
     // compare the arguments
     for (std::size_t i = 0; i < correct.size(); ++i) {
         ASSERT_STREQ(correct[i].c_str(), data.args[i].c_str());
     }
 }
+
+TEST(TestProcess, TestDeferredRedirection) {
+    std::string const input = "cat < testing/tmp/deferred_in > testing/tmp/deferred_out";
+
+    // nothing is opened while parsing, so the missing input file is not an error yet
+    std::vector<jsh::redirection> deferred;
+    auto proc_data = jsh::process::parse_process(input, &deferred);
+    ASSERT_TRUE(proc_data.has_value());
+    auto& data = std::get<jsh::binary_data>(*proc_data.value()); // NOLINT assert catches this .value()
+    ASSERT_FALSE(data.stdin.has_value());
+    ASSERT_FALSE(data.stdout.has_value());
+
+    ASSERT_EQ(deferred.size(), 2);
+    ASSERT_FALSE(deferred[0].output);
+    ASSERT_EQ(deferred[0].request.file, "testing/tmp/deferred_in");
+    ASSERT_TRUE(deferred[1].output);
+    ASSERT_EQ(deferred[1].request.flags, O_WRONLY | O_CREAT | O_TRUNC);
+}
+
+TEST(TestProcess, TestOpenBatch) {
+    // more files than fit in a single submission
+    static constexpr std::size_t NUM_FILES = 40;
+    std::vector<jsh::open_request> requests;
+    for (std::size_t i = 0; i < NUM_FILES; ++i) {
+        requests.push_back(jsh::open_request{.file = "testing/tmp/batch" + std::to_string(i), .flags = O_WRONLY | O_CREAT | O_TRUNC, .perms = 0666});
+    }
+    ASSERT_TRUE(jsh::syscall_wrapper::open_batch_wrapper(requests));
+    for (jsh::open_request const& request : requests) {
+        ASSERT_TRUE(request.fides.has_value());
+        ASSERT_EQ(jsh::syscall_wrapper::write_wrapper(request.fides.value(), "x", 1), 1); // NOLINT assert catches this .value()
+    }
+
+    // a missing file fails the batch without taking the files around it down
+    requests.clear();
+    requests.push_back(jsh::open_request{.file = "testing/tmp/batch0", .flags = O_RDONLY, .perms = 0});
+    requests.push_back(jsh::open_request{.file = "testing/tmp/missing/batch", .flags = O_RDONLY, .perms = 0});
+    ASSERT_FALSE(jsh::syscall_wrapper::open_batch_wrapper(requests));
+    ASSERT_TRUE(requests[0].fides.has_value());
+    ASSERT_FALSE(requests[1].fides.has_value());
+
+    char chr = 0;
+    ASSERT_EQ(jsh::syscall_wrapper::read_wrapper(requests[0].fides.value(), &chr, 1), 1); // NOLINT assert catches this .value()
+    ASSERT_EQ(chr, 'x');
+}
@@ -0,0 +1,111 @@
+// GTEST
+#include <gtest/gtest.h>
+
+// JSH
+#include <job.hpp>
+#include <job_table.hpp>
+#include <posix_wrappers.hpp>
+#include <process.hpp>
+#include <reactor.hpp>
+
+TEST(TestReactor, TestDispatch) {
+    std::optional<jsh::reactor> events = jsh::reactor::create();
+    ASSERT_TRUE(events.has_value());
+
+    std::optional<std::vector<jsh::file_descriptor_wrapper>> pipe_fds = jsh::syscall_wrapper::pipe_wrapper();
+    ASSERT_TRUE(pipe_fds.has_value());
+    jsh::file_descriptor_wrapper const& reader = pipe_fds.value()[0]; // NOLINT assert catches this
+    jsh::file_descriptor_wrapper const& writer = pipe_fds.value()[1]; // NOLINT assert catches this
+
+    // the source stays registered across dispatches
+    int fired = 0;
+    std::optional<std::uint64_t> const token = events->add(reader, [&]() { // NOLINT assert catches this
+        char chr = 0;
+        std::ignore = jsh::syscall_wrapper::read_wrapper(reader, &chr, sizeof(chr));
+        ++fired;
+    });
+    ASSERT_TRUE(token.has_value());
+    ASSERT_EQ(events->size(), 1); // NOLINT assert catches this
+
+    // nothing is ready yet
+    ASSERT_TRUE(events->dispatch(0)); // NOLINT assert catches this
+    ASSERT_EQ(fired, 0);
+
+    for (int i = 1; i <= 3; ++i) {
+        ASSERT_EQ(jsh::syscall_wrapper::write_wrapper(writer, "x", 1), 1);
+        ASSERT_TRUE(events->dispatch(-1)); // NOLINT assert catches this
+        ASSERT_EQ(fired, i);
+    }
+
+    // a removed source is never dispatched again
+    events->remove(reader, token.value()); // NOLINT assert catches this
+    ASSERT_EQ(jsh::syscall_wrapper::write_wrapper(writer, "x", 1), 1);
+    ASSERT_TRUE(events->dispatch(0)); // NOLINT assert catches this
+    ASSERT_EQ(fired, 3);
+    ASSERT_EQ(events->size(), 0); // NOLINT assert catches this
+}
+
+TEST(TestReactor, TestJobTimer) {
+    std::optional<jsh::reactor> events = jsh::reactor::create();
+    ASSERT_TRUE(events.has_value());
+    jsh::job_table::watch(&events.value()); // NOLINT assert catches this
+
+    // the job's timer is registered once when the job is started
+    auto job = jsh::job::parse_job("timeout=1 sleep 10 &");
+    jsh::job::execute_job(job);
+    jsh::job_entry const* entry = jsh::job_table::resolve("");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_TRUE(entry->timer_token.has_value());
+    std::size_t const job_id = entry->id;
+
+    // the reactor kills the job once its deadline passes
+    ASSERT_TRUE(events->dispatch(-1)); // NOLINT assert catches this
+    ASSERT_TRUE(jsh::job_table::find(job_id)->timed_out);
+
+    // leaving the table takes the timer out of the reactor
+    ASSERT_EQ(jsh::job_table::wait_job(job_id), jsh::job::TIMEOUT_STATUS);
+    ASSERT_EQ(events->size(), 0); // NOLINT assert catches this
+    jsh::job_table::watch(nullptr);
+}
+
+TEST(TestReactor, TestSupervise) {
+    std::optional<jsh::reactor> events = jsh::reactor::create();
+    ASSERT_TRUE(events.has_value());
+    jsh::process::watch(&events.value()); // NOLINT assert catches this
+
+    // a foreground job is collected through the reactor and leaves nothing registered
+    auto job = jsh::job::parse_job("timeout=5 sleep 0");
+    job->is_foreground = false;
+    jsh::job::execute_job(job);
+    ASSERT_EQ(job->status, EXIT_SUCCESS);
+    ASSERT_EQ(events->size(), 0); // NOLINT assert catches this
+
+    job = jsh::job::parse_job("sleep 10 &");
+    jsh::job::execute_job(job);
+    jsh::job_entry const* entry = jsh::job_table::resolve("");
+    ASSERT_NE(entry, nullptr);
+    std::size_t const job_id = entry->id;
+    pid_t const pgid = entry->pgid;
+
+    // stands in for the shell's signalfd reading ctrl+c
+    std::optional<std::vector<jsh::file_descriptor_wrapper>> pipe_fds = jsh::syscall_wrapper::pipe_wrapper();
+    ASSERT_TRUE(pipe_fds.has_value());
+    jsh::file_descriptor_wrapper const& reader = pipe_fds.value()[0]; // NOLINT assert catches this
+    std::optional<std::uint64_t> const token = events->add(reader, [&]() { // NOLINT assert catches this
+        char chr = 0;
+        std::ignore = jsh::syscall_wrapper::read_wrapper(reader, &chr, sizeof(chr));
+        jsh::process::interrupt();
+    });
+    ASSERT_TRUE(token.has_value());
+    ASSERT_EQ(jsh::syscall_wrapper::write_wrapper(pipe_fds.value()[1], "x", 1), 1); // NOLINT assert catches this
+
+    // ctrl+c stops the wait and leaves the job running in the table
+    ASSERT_EQ(jsh::job_table::wait_job(job_id, true), jsh::process::SIGNAL_STATUS_OFFSET + SIGINT);
+    ASSERT_NE(jsh::job_table::find(job_id), nullptr);
+    events->remove(reader, token.value()); // NOLINT assert catches this
+
+    ASSERT_TRUE(jsh::syscall_wrapper::kill_wrapper(-pgid, SIGKILL));
+    ASSERT_EQ(jsh::job_table::wait_job(job_id), jsh::process::SIGNAL_STATUS_OFFSET + SIGKILL);
+    ASSERT_EQ(events->size(), 0); // NOLINT assert catches this
+    jsh::process::watch(nullptr);
+}